@@ -12,6 +12,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
 #include <list>
 #include <unordered_map>
 #include "common/logger.h"
@@ -31,6 +32,15 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    stop_prefetch_ = true;
+  }
+  prefetch_cv_.notify_one();
+  if (prefetch_thread_ != nullptr) {
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
   delete[] pages_;
   delete replacer_;
 }
@@ -43,7 +53,9 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> guard(latch_);
+  // a page being prefetched is in the page table already, but not read yet
+  loaded_cv_.wait(guard, [&] { return this->loading_.count(page_id) == 0; });
 
   Page *P = nullptr;
   frame_id_t target_frame_id = -1;
@@ -70,6 +82,12 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
     P->pin_count_ = 1;
     P->is_dirty_ = false;
     this->disk_manager_->ReadPage(P->page_id_, P->data_);
+    // a request to prefetch the page is stale now, it would read the page again once evicted
+    std::lock_guard<std::mutex> prefetch_guard(prefetch_latch_);
+    auto request = std::find(this->prefetch_queue_.begin(), this->prefetch_queue_.end(), page_id);
+    if (request != this->prefetch_queue_.end()) {
+      this->prefetch_queue_.erase(request);
+    }
   } else {  // P exists
     target_frame_id = page_table_[page_id];
     P = &this->pages_[target_frame_id];
@@ -193,6 +211,83 @@ void BufferPoolManager::FlushAllPagesImpl() {
   }
 }
 
+void BufferPoolManager::PrefetchPage(page_id_t page_id) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (page_id == INVALID_PAGE_ID || this->page_table_.find(page_id) != this->page_table_.end()) {
+      return;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    // a scan far ahead of the reads would only evict the pages it asked for earlier
+    if (this->prefetch_queue_.size() >= this->pool_size_ / 2 ||
+        std::find(this->prefetch_queue_.begin(), this->prefetch_queue_.end(), page_id) != this->prefetch_queue_.end()) {
+      return;
+    }
+    this->prefetch_queue_.push_back(page_id);
+    if (this->prefetch_thread_ == nullptr) {
+      this->prefetch_thread_ = new std::thread(&BufferPoolManager::RunPrefetch, this);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::RunPrefetch() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return this->stop_prefetch_ || !this->prefetch_queue_.empty(); });
+    if (this->stop_prefetch_) {
+      return;
+    }
+    page_id_t page_id = this->prefetch_queue_.front();
+    this->prefetch_queue_.pop_front();
+    lock.unlock();
+    this->PrefetchPageImpl(page_id);
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::PrefetchPageImpl(page_id_t page_id) {
+  // like FetchPageImpl, but the page is read without latch_, with its frame pinned meanwhile, and then left unpinned
+  // for the replacer to evict if nobody asks for it
+  std::unique_lock<std::mutex> guard(latch_);
+
+  if (this->page_table_.find(page_id) != this->page_table_.end()) {
+    return;
+  }
+  frame_id_t target_frame_id = -1;
+  if (this->HasFreePage()) {
+    target_frame_id = this->free_list_.front();
+    this->free_list_.pop_front();
+  } else {
+    if (!this->replacer_->Victim(&target_frame_id)) {
+      return;
+    }
+    Page *R = &this->pages_[target_frame_id];
+    if (R->IsDirty()) {
+      disk_manager_->WritePage(R->page_id_, R->data_);
+    }
+    page_table_.erase(R->page_id_);
+  }
+  this->page_table_[page_id] = target_frame_id;
+  Page *P = &this->pages_[target_frame_id];
+  P->page_id_ = page_id;
+  P->pin_count_ = 1;
+  P->is_dirty_ = false;
+  this->loading_.insert(page_id);
+  guard.unlock();
+
+  this->disk_manager_->ReadPage(page_id, P->data_);
+
+  guard.lock();
+  this->loading_.erase(page_id);
+  P->pin_count_ = 0;
+  this->replacer_->Unpin(target_frame_id);
+  guard.unlock();
+  loaded_cv_.notify_all();
+}
+
 bool BufferPoolManager::HasFreePage() { return static_cast<int>(this->free_list_.size()) > 0; }
 
 }  // namespace bustub
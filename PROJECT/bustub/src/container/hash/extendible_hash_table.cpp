@@ -0,0 +1,289 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *directory_page = this->buffer_pool_manager_->NewPage(&this->directory_page_id_);
+  page_id_t bucket_page_id;
+  if (directory_page == nullptr || this->buffer_pool_manager_->NewPage(&bucket_page_id) == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+  }
+  // a zeroed directory has a global depth of 0, its only entry the bucket of local depth 0
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  directory->SetPageId(this->directory_page_id_);
+  directory->SetBucketPageId(0, bucket_page_id);
+  directory->SetLocalDepth(0, 0);
+  this->buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(this->hash_fn_.GetHash(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchDirectoryPage() {
+  Page *page = this->buffer_pool_manager_->FetchPage(this->directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  Page *page = this->buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  this->table_latch_.RLock();
+  HashTableDirectoryPage *directory = this->FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(this->Hash(key) & directory->GetGlobalDepthMask());
+  Page *page = this->FetchBucketPage(bucket_page_id);
+  page->RLatch();
+  bool found = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())->GetValue(key, this->comparator_, result);
+  page->RUnlatch();
+  this->buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, false);
+  this->table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  this->table_latch_.RLock();
+  HashTableDirectoryPage *directory = this->FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(this->Hash(key) & directory->GetGlobalDepthMask());
+  Page *page = this->FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool full = bucket->IsFull();
+  bool inserted = !full && bucket->Insert(key, value, this->comparator_);
+  page->WUnlatch();
+  this->buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, false);
+  this->table_latch_.RUnlock();
+  if (!full) {
+    return inserted;
+  }
+  return this->SplitInsert(key, value);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(const KeyType &key, const ValueType &value) {
+  this->table_latch_.WLock();
+  HashTableDirectoryPage *directory = this->FetchDirectoryPage();
+  bool directory_dirty = false;
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = this->Hash(key) & directory->GetGlobalDepthMask();
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    Page *page = this->FetchBucketPage(bucket_page_id);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    // another insert may have split the bucket meanwhile
+    if (!bucket->IsFull()) {
+      inserted = bucket->Insert(key, value, this->comparator_);
+      this->buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+    std::vector<ValueType> values;
+    bucket->GetValue(key, this->comparator_, &values);
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      this->buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    // splits only part pairs of different hashes, they never make room in a bucket full of the hash of key
+    uint32_t hash = this->Hash(key);
+    bool one_hash = true;
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && one_hash; i++) {
+      one_hash = this->Hash(bucket->KeyAt(i)) == hash;
+    }
+    // nor can a bucket of the largest global depth split
+    if (one_hash || (local_depth == directory->GetGlobalDepth() && directory->Size() * 2 > DIRECTORY_ARRAY_SIZE)) {
+      this->buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, directory_dirty);
+      this->table_latch_.WUnlock();
+      throw Exception(ExceptionType::OUT_OF_RANGE, "hash table bucket is full and cannot split");
+    }
+    if (local_depth == directory->GetGlobalDepth()) {
+      directory->IncrGlobalDepth();
+    }
+
+    page_id_t image_page_id;
+    Page *image_page = this->buffer_pool_manager_->NewPage(&image_page_id);
+    if (image_page == nullptr) {
+      this->buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, true);
+      this->table_latch_.WUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    auto *image = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData());
+    // the entries of the bucket whose bit local_depth is set now point to the image
+    uint32_t low_bits = bucket_idx & ((1U << local_depth) - 1);
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      if ((i & ((1U << local_depth) - 1)) == low_bits) {
+        directory->SetLocalDepth(i, local_depth + 1);
+        if ((i & (1U << local_depth)) != 0) {
+          directory->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    // pairs move likewise: the bucket is full, so none of its slots is free
+    std::vector<std::pair<KeyType, ValueType>> pairs;
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+      pairs.emplace_back(bucket->KeyAt(i), bucket->ValueAt(i));
+    }
+    bucket->Reset();
+    for (const auto &pair : pairs) {
+      bool moves = (this->Hash(pair.first) & (1U << local_depth)) != 0;
+      (moves ? image : bucket)->Insert(pair.first, pair.second, this->comparator_);
+    }
+    this->buffer_pool_manager_->UnpinPage(image_page_id, true);
+    this->buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    directory_dirty = true;
+  }
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, directory_dirty);
+  this->table_latch_.WUnlock();
+  return inserted;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  this->table_latch_.RLock();
+  HashTableDirectoryPage *directory = this->FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(this->Hash(key) & directory->GetGlobalDepthMask());
+  Page *page = this->FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = bucket->Remove(key, value, this->comparator_);
+  bool empty = removed && bucket->IsEmpty();
+  page->WUnlatch();
+  this->buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, false);
+  this->table_latch_.RUnlock();
+  if (empty) {
+    this->Merge(key);
+  }
+  return removed;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(const KeyType &key) {
+  this->table_latch_.WLock();
+  HashTableDirectoryPage *directory = this->FetchDirectoryPage();
+  bool merged = false;
+  // the merged bucket may in turn merge with its own split image, up to a bucket of local depth 0
+  while (true) {
+    uint32_t bucket_idx = this->Hash(key) & directory->GetGlobalDepthMask();
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    // only buckets of the same depth merge
+    if (local_depth == 0 || directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    Page *page = this->FetchBucketPage(bucket_page_id);
+    Page *image_page = this->FetchBucketPage(image_page_id);
+    // an insert may have refilled the bucket meanwhile
+    bool bucket_empty = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())->IsEmpty();
+    bool image_empty = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData())->IsEmpty();
+    this->buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    this->buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      page_id_t page_id = directory->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        directory->SetBucketPageId(i, kept_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    this->buffer_pool_manager_->DeletePage(bucket_empty ? bucket_page_id : image_page_id);
+    merged = true;
+  }
+  while (directory->CanShrink()) {
+    directory->DecrGlobalDepth();
+  }
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, merged);
+  this->table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  this->table_latch_.RLock();
+  uint32_t global_depth = this->FetchDirectoryPage()->GetGlobalDepth();
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, false);
+  this->table_latch_.RUnlock();
+  return global_depth;
+}
+
+/*****************************************************************************
+ * VERIFY INTEGRITY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::VerifyIntegrity() {
+  this->table_latch_.RLock();
+  this->FetchDirectoryPage()->VerifyIntegrity();
+  this->buffer_pool_manager_->UnpinPage(this->directory_page_id_, false);
+  this->table_latch_.RUnlock();
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -19,6 +20,7 @@
 #include "common/logger.h"
 #include "common/rid.h"
 #include "container/hash/linear_probe_hash_table.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 
@@ -26,21 +28,410 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  this->header_page_id_ = this->CreateTable(std::max<size_t>(num_buckets, 1));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::CreateTable(size_t num_buckets) {
+  page_id_t header_page_id;
+  Page *header_page = this->buffer_pool_manager_->NewPage(&header_page_id);
+  if (header_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+  }
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  header->SetPageId(header_page_id);
+  header->SetSize(num_buckets);
+  for (size_t i = 0; i < (num_buckets - 1) / BLOCK_ARRAY_SIZE + 1; i++) {
+    page_id_t block_page_id;
+    if (this->buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    header->AddBlockPageId(block_page_id);
+    this->buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  this->buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) {
+  Page *page = this->buffer_pool_manager_->FetchPage(header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+  }
+  return reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::Probe(HashTableHeaderPage *header, const KeyType &key, bool exclusive, Visitor &&visit) {
+  size_t size = header->GetSize();
+  uint64_t hash = this->hash_fn_.GetHash(key);
+  uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(hash);
+  size_t bucket = hash % size;
+  size_t probe_length = std::min(size, this->max_probe_length_);
+  size_t probed = 0;
+  while (probed < probe_length) {
+    size_t block_index = bucket / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = header->GetBlockPageId(block_index);
+    Page *page = this->buffer_pool_manager_->FetchPage(block_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    exclusive ? page->WLatch() : page->RLatch();
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    // the slots of this block from bucket on, the last block may be partly used
+    slot_offset_t begin = bucket - block_index * BLOCK_ARRAY_SIZE;
+    slot_offset_t limit = std::min(size, (block_index + 1) * BLOCK_ARRAY_SIZE) - block_index * BLOCK_ARRAY_SIZE;
+    limit = std::min(limit, begin + probe_length - probed);
+    slot_offset_t end;
+    bool stopped = this->ProbeBlock(block, key, fingerprint, begin, limit, &end, visit);
+    bool done = stopped || end < limit;
+    exclusive ? page->WUnlatch() : page->RUnlatch();
+    this->buffer_pool_manager_->UnpinPage(block_page_id, exclusive && stopped);
+    if (done) {
+      return stopped;
+    }
+    probed += end - begin;
+    bucket += end - begin;
+    if (bucket == size) {
+      bucket = 0;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::ProbeBlock(HASH_TABLE_BLOCK_TYPE *block, const KeyType &key, uint8_t fingerprint,
+                                 slot_offset_t begin, slot_offset_t limit, slot_offset_t *end, Visitor &&visit) {
+  const slot_offset_t group_size = HASH_TABLE_BLOCK_TYPE::FINGERPRINT_GROUP_SIZE;
+  // the key can only be before the first slot never occupied
+  *end = block->FindUnoccupied(begin, limit);
+  for (slot_offset_t group = begin / group_size * group_size; group < *end; group += group_size) {
+    uint32_t matches = block->MatchFingerprints(group, fingerprint);
+    if (begin > group) {
+      matches &= ~0U << (begin - group);
+    }
+    if (*end < group + group_size) {
+      matches &= (1U << (*end - group)) - 1;
+    }
+    for (; matches != 0; matches &= matches - 1) {
+      slot_offset_t slot = group + __builtin_ctz(matches);
+      if (this->comparator_(block->KeyAt(slot), key) == 0 && visit(block, slot)) {
+        return true;
+      }
+    }
+  }
+  return *end < limit && visit(block, *end);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableHeaderPage *HASH_TABLE_TYPE::BeginOperation(HashTableHeaderPage **old_header) {
+  this->table_latch_.RLock();
+  HashTableHeaderPage *header = this->FetchHeaderPage(this->header_page_id_);
+  *old_header = nullptr;
+  if (this->old_header_page_id_ != INVALID_PAGE_ID) {
+    *old_header = this->FetchHeaderPage(this->old_header_page_id_);
+    this->MigrateBuckets(*old_header, header, HASH_TABLE_MIGRATE_BUCKETS);
+  }
+  return header;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::EndOperation(HashTableHeaderPage *old_header) {
+  bool migrated = false;
+  if (old_header != nullptr) {
+    migrated = this->migrated_ == old_header->GetSize();
+    this->buffer_pool_manager_->UnpinPage(this->old_header_page_id_, false);
+  }
+  this->buffer_pool_manager_->UnpinPage(this->header_page_id_, false);
+  this->table_latch_.RUnlock();
+  if (migrated) {
+    this->table_latch_.WLock();
+    // another thread may have freed it, or resized again, meanwhile
+    if (this->old_header_page_id_ != INVALID_PAGE_ID) {
+      HashTableHeaderPage *current_old_header = this->FetchHeaderPage(this->old_header_page_id_);
+      migrated = this->migrated_ == current_old_header->GetSize();
+      this->buffer_pool_manager_->UnpinPage(this->old_header_page_id_, false);
+      if (migrated) {
+        this->FreeTable(this->old_header_page_id_);
+        this->old_header_page_id_ = INVALID_PAGE_ID;
+      }
+    }
+    this->table_latch_.WUnlock();
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::MigrateBuckets(HashTableHeaderPage *old_header, HashTableHeaderPage *header, size_t count) {
+  size_t old_size = old_header->GetSize();
+  size_t bucket = this->migrate_next_.fetch_add(count);
+  if (bucket >= old_size) {
+    return false;
+  }
+  size_t end = std::min(old_size, bucket + count);
+  // the new table is twice the old one, but it fills if other operations insert while this one is slow: the entries
+  // stay in the old table then, and are not counted as moved, so only Resize frees it
+  if (!this->MoveBuckets(old_header, header, bucket, end)) {
+    return false;
+  }
+  size_t claimed = end - bucket;
+  return this->migrated_.fetch_add(claimed) + claimed == old_size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::MoveBuckets(HashTableHeaderPage *from_header, HashTableHeaderPage *to_header, size_t bucket,
+                                  size_t end) {
+  bool has_room = true;
+  while (bucket < end) {
+    size_t block_index = bucket / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = from_header->GetBlockPageId(block_index);
+    Page *page = this->buffer_pool_manager_->FetchPage(block_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    page->WLatch();
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    size_t block_end = std::min(end, (block_index + 1) * BLOCK_ARRAY_SIZE);
+    for (; bucket < block_end && has_room; bucket++) {
+      slot_offset_t slot = bucket - block_index * BLOCK_ARRAY_SIZE;
+      if (block->IsReadable(slot)) {
+        bool inserted;
+        has_room = this->InsertImpl(to_header, block->KeyAt(slot), block->ValueAt(slot), &inserted);
+        if (has_room) {
+          block->Remove(slot);
+        }
+      }
+    }
+    page->WUnlatch();
+    this->buffer_pool_manager_->UnpinPage(block_page_id, true);
+    if (!has_room) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::CopyTable(HashTableHeaderPage *from_header, HashTableHeaderPage *to_header) {
+  size_t size = from_header->GetSize();
+  for (size_t block_index = 0; block_index < from_header->NumBlocks(); block_index++) {
+    page_id_t block_page_id = from_header->GetBlockPageId(block_index);
+    Page *page = this->buffer_pool_manager_->FetchPage(block_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    size_t block_size = std::min(BLOCK_ARRAY_SIZE, size - block_index * BLOCK_ARRAY_SIZE);
+    bool has_room = true;
+    for (slot_offset_t slot = 0; slot < block_size && has_room; slot++) {
+      if (block->IsReadable(slot)) {
+        bool inserted;
+        has_room = this->InsertImpl(to_header, block->KeyAt(slot), block->ValueAt(slot), &inserted);
+      }
+    }
+    this->buffer_pool_manager_->UnpinPage(block_page_id, false);
+    if (!has_room) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::FinishMigration(HashTableHeaderPage *header) {
+  if (this->old_header_page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  // the buckets that moved already are empty
+  HashTableHeaderPage *old_header = this->FetchHeaderPage(this->old_header_page_id_);
+  bool has_room = this->MoveBuckets(old_header, header, 0, old_header->GetSize());
+  this->buffer_pool_manager_->UnpinPage(this->old_header_page_id_, false);
+  if (has_room) {
+    this->FreeTable(this->old_header_page_id_);
+    this->old_header_page_id_ = INVALID_PAGE_ID;
+  }
+  return has_room;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FreeTable(page_id_t header_page_id) {
+  HashTableHeaderPage *header = this->FetchHeaderPage(header_page_id);
+  for (size_t block_index = 0; block_index < header->NumBlocks(); block_index++) {
+    this->buffer_pool_manager_->DeletePage(header->GetBlockPageId(block_index));
+  }
+  this->buffer_pool_manager_->UnpinPage(header_page_id, false);
+  this->buffer_pool_manager_->DeletePage(header_page_id);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  HashTableHeaderPage *old_header;
+  HashTableHeaderPage *header = this->BeginOperation(&old_header);
+  size_t begin = result->size();
+  auto collect = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot) {
+    if (block->IsReadable(slot)) {
+      ValueType value = block->ValueAt(slot);
+      // a pair that moved on during the probe, to the new table or further along the probe, is seen twice
+      if (std::find(result->begin() + begin, result->end(), value) == result->end()) {
+        result->push_back(value);
+      }
+    }
+    return false;
+  };
+  // the old table first: an entry that moves meanwhile is in the new one before the probe gets there
+  if (old_header != nullptr) {
+    this->Probe(old_header, key, false, collect);
+  }
+  this->Probe(header, key, false, collect);
+  bool found = result->size() > begin;
+  this->EndOperation(old_header);
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  while (true) {
+    HashTableHeaderPage *old_header;
+    HashTableHeaderPage *header = this->BeginOperation(&old_header);
+    size_t size = header->GetSize();
+    // the same pair twice is not allowed, in either table
+    bool duplicate = old_header != nullptr &&
+                     this->Probe(old_header, key, false, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot) {
+                       return block->IsReadable(slot) && block->ValueAt(slot) == value;
+                     });
+    bool inserted = false;
+    bool has_room = duplicate || this->InsertImpl(header, key, value, &inserted);
+    this->EndOperation(old_header);
+    if (has_room) {
+      return inserted;
+    }
+    // every bucket holds an entry or a tombstone: grow the table, unless it cannot grow any more
+    if (!this->Resize(size) || this->GetSize() <= size) {
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::InsertImpl(HashTableHeaderPage *header, const KeyType &key, const ValueType &value,
+                                 bool *inserted) {
+  uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(this->hash_fn_.GetHash(key));
+  return this->Probe(header, key, true, [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot) {
+    return this->InsertAt(block, slot, key, value, fingerprint, inserted);
+  });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::InsertAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot, const KeyType &key,
+                               const ValueType &value, uint8_t fingerprint, bool *inserted) {
+  if (!block->IsOccupied(slot)) {
+    *inserted = block->Insert(slot, key, value, fingerprint);
+    return true;
+  }
+  // the same pair twice is not allowed
+  return block->ValueAt(slot) == value;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::BlockHasPair(HASH_TABLE_BLOCK_TYPE *block, const KeyType &key, const ValueType &value,
+                                   uint8_t fingerprint, slot_offset_t begin, slot_offset_t limit, slot_offset_t *end) {
+  return this->ProbeBlock(block, key, fingerprint, begin, limit, end,
+                          [&](HASH_TABLE_BLOCK_TYPE *probed_block, slot_offset_t slot) {
+                            return probed_block->IsReadable(slot) && probed_block->ValueAt(slot) == value;
+                          });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t HASH_TABLE_TYPE::BulkInsert(Transaction *transaction, const std::vector<MappingType> &pairs) {
+  // room for the pairs at a load factor of at most a half, the table doubles when it fills anyway
+  this->Resize(pairs.size());
+  this->table_latch_.WLock();
+  HashTableHeaderPage *header = this->FetchHeaderPage(this->header_page_id_);
+  size_t size = header->GetSize();
+  // the pairs that could not be inserted together, Insert grows the table for them
+  std::vector<size_t> left;
+  size_t num_inserted = 0;
+  if (!this->FinishMigration(header)) {
+    for (size_t i = 0; i < pairs.size(); i++) {
+      left.push_back(i);
+    }
+  } else {
+    // partition the pairs by the block of their bucket
+    std::vector<uint64_t> hashes(pairs.size());
+    std::vector<size_t> block_begin(header->NumBlocks() + 1, 0);
+    for (size_t i = 0; i < pairs.size(); i++) {
+      hashes[i] = this->hash_fn_.GetHash(pairs[i].first);
+      block_begin[hashes[i] % size / BLOCK_ARRAY_SIZE + 1]++;
+    }
+    for (size_t block_index = 0; block_index < header->NumBlocks(); block_index++) {
+      block_begin[block_index + 1] += block_begin[block_index];
+    }
+    std::vector<size_t> order(pairs.size());
+    std::vector<size_t> next(block_begin.begin(), block_begin.end() - 1);
+    for (size_t i = 0; i < pairs.size(); i++) {
+      order[next[hashes[i] % size / BLOCK_ARRAY_SIZE]++] = i;
+    }
+
+    // the probe of a pair ends in its block unless the block is full from its bucket on
+    std::vector<size_t> spilled;
+    for (size_t block_index = 0; block_index < header->NumBlocks(); block_index++) {
+      if (block_begin[block_index] == block_begin[block_index + 1]) {
+        continue;
+      }
+      page_id_t block_page_id = header->GetBlockPageId(block_index);
+      Page *page = this->buffer_pool_manager_->FetchPage(block_page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+      }
+      page->WLatch();
+      auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+      slot_offset_t limit = std::min(size, (block_index + 1) * BLOCK_ARRAY_SIZE) - block_index * BLOCK_ARRAY_SIZE;
+      for (size_t k = block_begin[block_index]; k < block_begin[block_index + 1]; k++) {
+        size_t i = order[k];
+        const KeyType &key = pairs[i].first;
+        uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(hashes[i]);
+        slot_offset_t begin = hashes[i] % size - block_index * BLOCK_ARRAY_SIZE;
+        // max_probe_length_ is SIZE_MAX without a bound, so it is not added to begin
+        slot_offset_t probe_limit = begin + std::min<size_t>(limit - begin, this->max_probe_length_);
+        slot_offset_t end;
+        bool inserted = false;
+        if (!this->ProbeBlock(block, key, fingerprint, begin, probe_limit, &end,
+                              [&](HASH_TABLE_BLOCK_TYPE *probed_block, slot_offset_t slot) {
+                                return this->InsertAt(probed_block, slot, key, pairs[i].second, fingerprint,
+                                                      &inserted);
+                              })) {
+          spilled.push_back(i);
+        }
+        num_inserted += inserted ? 1 : 0;
+      }
+      page->WUnlatch();
+      this->buffer_pool_manager_->UnpinPage(block_page_id, true);
+    }
+
+    this->num_bulk_spilled_ = spilled.size();
+    for (size_t i : spilled) {
+      bool inserted = false;
+      if (!this->InsertImpl(header, pairs[i].first, pairs[i].second, &inserted)) {
+        left.push_back(i);
+      }
+      num_inserted += inserted ? 1 : 0;
+    }
+  }
+  this->buffer_pool_manager_->UnpinPage(this->header_page_id_, false);
+  this->table_latch_.WUnlock();
+
+  for (size_t i : left) {
+    num_inserted += this->Insert(transaction, pairs[i].first, pairs[i].second) ? 1 : 0;
+  }
+  return num_inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +439,161 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  HashTableHeaderPage *old_header;
+  HashTableHeaderPage *header = this->BeginOperation(&old_header);
+  auto remove = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot) {
+    if (block->IsReadable(slot) && block->ValueAt(slot) == value) {
+      block->Remove(slot);
+      return true;
+    }
+    return false;
+  };
+  bool removed = old_header != nullptr && this->Probe(old_header, key, true, remove);
+  removed = removed || this->Probe(header, key, true, remove);
+  this->EndOperation(old_header);
+  return removed;
+}
+
+/*****************************************************************************
+ * DESTROY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Destroy() {
+  this->table_latch_.WLock();
+  if (this->old_header_page_id_ != INVALID_PAGE_ID) {
+    this->FreeTable(this->old_header_page_id_);
+    this->old_header_page_id_ = INVALID_PAGE_ID;
+  }
+  this->FreeTable(this->header_page_id_);
+  this->header_page_id_ = INVALID_PAGE_ID;
+  this->table_latch_.WUnlock();
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+bool HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  this->table_latch_.WLock();
+  HashTableHeaderPage *header = this->FetchHeaderPage(this->header_page_id_);
+  size_t size = header->GetSize();
+  // the header page lists a bounded number of blocks
+  size_t max_size = HashTableHeaderPage::MaxBlocks() * BLOCK_ARRAY_SIZE;
+  size_t new_size = std::min(2 * initial_size, max_size);
+  // another insert may have grown the table meanwhile
+  if (new_size <= size) {
+    this->buffer_pool_manager_->UnpinPage(this->header_page_id_, false);
+    this->table_latch_.WUnlock();
+    return true;
+  }
+  page_id_t new_header_page_id = this->CreateTable(new_size);
+  bool rehash = false;
+  if (this->old_header_page_id_ != INVALID_PAGE_ID) {
+    HashTableHeaderPage *old_header = this->FetchHeaderPage(this->old_header_page_id_);
+    // the table filled before the last resize finished moving entries: the entries of both tables are copied at once,
+    // to a table twice as large again while they do not fit, they stay where they are if none of the sizes fits them
+    rehash = this->migrated_ < old_header->GetSize();
+    while (rehash) {
+      HashTableHeaderPage *new_header = this->FetchHeaderPage(new_header_page_id);
+      bool has_room = this->CopyTable(old_header, new_header) && this->CopyTable(header, new_header);
+      this->buffer_pool_manager_->UnpinPage(new_header_page_id, false);
+      if (has_room) {
+        break;
+      }
+      this->FreeTable(new_header_page_id);
+      if (new_size == max_size) {
+        this->buffer_pool_manager_->UnpinPage(this->old_header_page_id_, false);
+        this->buffer_pool_manager_->UnpinPage(this->header_page_id_, false);
+        this->table_latch_.WUnlock();
+        return false;
+      }
+      new_size = std::min(2 * new_size, max_size);
+      new_header_page_id = this->CreateTable(new_size);
+    }
+    this->buffer_pool_manager_->UnpinPage(this->old_header_page_id_, false);
+    this->FreeTable(this->old_header_page_id_);
+  }
+  this->buffer_pool_manager_->UnpinPage(this->header_page_id_, false);
+
+  if (rehash) {
+    this->FreeTable(this->header_page_id_);
+    this->old_header_page_id_ = INVALID_PAGE_ID;
+  } else {
+    this->old_header_page_id_ = this->header_page_id_;
+  }
+  this->header_page_id_ = new_header_page_id;
+  this->migrate_next_ = 0;
+  this->migrated_ = 0;
+  this->table_latch_.WUnlock();
+  return true;
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  this->table_latch_.RLock();
+  size_t size = this->FetchHeaderPage(this->header_page_id_)->GetSize();
+  this->buffer_pool_manager_->UnpinPage(this->header_page_id_, false);
+  this->table_latch_.RUnlock();
+  return size;
+}
+
+/*****************************************************************************
+ * GETAVERAGEPROBELENGTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+double HASH_TABLE_TYPE::GetAverageProbeLength() {
+  std::vector<size_t> histogram = this->GetProbeLengthHistogram();
+  size_t entries = 0;
+  size_t probed = 0;
+  for (size_t i = 0; i < histogram.size(); i++) {
+    entries += histogram[i];
+    probed += histogram[i] * (i + 1);
+  }
+  return entries == 0 ? 0 : static_cast<double>(probed) / entries;
+}
+
+/*****************************************************************************
+ * GETPROBELENGTHHISTOGRAM
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+std::vector<size_t> HASH_TABLE_TYPE::GetProbeLengthHistogram() {
+  HashTableHeaderPage *old_header;
+  HashTableHeaderPage *header = this->BeginOperation(&old_header);
+  std::vector<size_t> histogram;
+  for (HashTableHeaderPage *table : {old_header, header}) {
+    if (table == nullptr) {
+      continue;
+    }
+    size_t size = table->GetSize();
+    for (size_t block_index = 0; block_index < table->NumBlocks(); block_index++) {
+      page_id_t block_page_id = table->GetBlockPageId(block_index);
+      Page *page = this->buffer_pool_manager_->FetchPage(block_page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+      }
+      page->RLatch();
+      auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+      size_t block_size = std::min(BLOCK_ARRAY_SIZE, size - block_index * BLOCK_ARRAY_SIZE);
+      for (slot_offset_t slot = 0; slot < block_size; slot++) {
+        if (block->IsReadable(slot)) {
+          size_t bucket = block_index * BLOCK_ARRAY_SIZE + slot;
+          size_t home = this->hash_fn_.GetHash(block->KeyAt(slot)) % size;
+          size_t probe_length = (bucket + size - home) % size + 1;
+          if (histogram.size() < probe_length) {
+            histogram.resize(probe_length, 0);
+          }
+          histogram[probe_length - 1]++;
+        }
+      }
+      page->RUnlatch();
+      this->buffer_pool_manager_->UnpinPage(block_page_id, false);
+    }
+  }
+  this->EndOperation(old_header);
+  return histogram;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -73,4 +604,12 @@ template class LinearProbeHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class LinearProbeHashTable<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class LinearProbeHashTable<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class LinearProbeHashTable<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class LinearProbeHashTable<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class LinearProbeHashTable<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class LinearProbeHashTable<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+template class LinearProbeHashTable<NormalizedKey<256>, RID, NormalizedComparator<256>>;
+
 }  // namespace bustub
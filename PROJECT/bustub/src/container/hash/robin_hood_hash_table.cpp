@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// robin_hood_hash_table.cpp
+//
+// Identification: src/container/hash/robin_hood_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/hash/robin_hood_hash_table.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ROBIN_HOOD_HASH_TABLE_TYPE::RobinHoodHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                               const KeyComparator &comparator, size_t num_buckets,
+                                               HashFunction<KeyType> hash_fn)
+    : LinearProbeHashTable<KeyType, ValueType, KeyComparator>(name, buffer_pool_manager, comparator, num_buckets,
+                                                              std::move(hash_fn)) {
+  this->max_probe_length_ = HASH_TABLE_MAX_PROBE_LENGTH;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ROBIN_HOOD_HASH_TABLE_TYPE::BlockLatches::BlockLatches(BufferPoolManager *buffer_pool_manager,
+                                                       HashTableHeaderPage *header,
+                                                       const std::vector<size_t> &block_indexes)
+    : buffer_pool_manager_(buffer_pool_manager), header_(header) {
+  std::vector<size_t> sorted = block_indexes;
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  for (size_t block_index : sorted) {
+    this->BlockOf(block_index * BLOCK_ARRAY_SIZE);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ROBIN_HOOD_HASH_TABLE_TYPE::BlockLatches::~BlockLatches() {
+  for (size_t i = 0; i < this->pages_.size(); i++) {
+    this->pages_[i]->WUnlatch();
+    this->buffer_pool_manager_->UnpinPage(this->pages_[i]->GetPageId(), this->dirty_);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_BLOCK_TYPE *ROBIN_HOOD_HASH_TABLE_TYPE::BlockLatches::BlockOf(size_t bucket) {
+  size_t block_index = bucket / BLOCK_ARRAY_SIZE;
+  auto latched = std::find(this->block_indexes_.begin(), this->block_indexes_.end(), block_index);
+  if (latched != this->block_indexes_.end()) {
+    return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(this->pages_[latched - this->block_indexes_.begin()]->GetData());
+  }
+  // latching it now could deadlock with an insert that latched it first and waits for ours
+  if (!this->block_indexes_.empty() && this->block_indexes_.back() > block_index) {
+    this->block_indexes_.push_back(block_index);
+    return nullptr;
+  }
+  Page *page = this->buffer_pool_manager_->FetchPage(this->header_->GetBlockPageId(block_index));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+  }
+  page->WLatch();
+  this->block_indexes_.push_back(block_index);
+  this->pages_.push_back(page);
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool ROBIN_HOOD_HASH_TABLE_TYPE::InsertImpl(HashTableHeaderPage *header, const KeyType &key, const ValueType &value,
+                                            bool *inserted) {
+  size_t size = header->GetSize();
+  std::vector<size_t> block_indexes;
+  while (true) {
+    BlockLatches latches(this->buffer_pool_manager_, header, block_indexes);
+    int result = this->InsertLatched(&latches, size, key, value, inserted);
+    if (result >= 0) {
+      return result == 1;
+    }
+    block_indexes = latches.GetBlockIndexes();
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+int ROBIN_HOOD_HASH_TABLE_TYPE::InsertLatched(BlockLatches *latches, size_t size, const KeyType &key,
+                                              const ValueType &value, bool *inserted) {
+  uint64_t hash = this->hash_fn_.GetHash(key);
+  uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(hash);
+  size_t home = hash % size;
+  size_t probe_length = std::min(size, this->max_probe_length_);
+
+  // the same pair twice is not allowed, it is within probe_length buckets from home
+  size_t probed = 0;
+  while (probed < probe_length) {
+    size_t bucket = (home + probed) % size;
+    size_t block_index = bucket / BLOCK_ARRAY_SIZE;
+    HASH_TABLE_BLOCK_TYPE *block = latches->BlockOf(bucket);
+    if (block == nullptr) {
+      return -1;
+    }
+    slot_offset_t begin = bucket - block_index * BLOCK_ARRAY_SIZE;
+    slot_offset_t limit = std::min(size, (block_index + 1) * BLOCK_ARRAY_SIZE) - block_index * BLOCK_ARRAY_SIZE;
+    limit = std::min(limit, begin + probe_length - probed);
+    slot_offset_t end;
+    if (this->BlockHasPair(block, key, value, fingerprint, begin, limit, &end)) {
+      return 1;
+    }
+    if (end < limit) {
+      break;
+    }
+    probed += limit - begin;
+  }
+
+  // find the buckets where what is carried swaps, and the one that takes the last of it, before moving anything
+  std::vector<size_t> swaps;
+  size_t distance = 0;
+  size_t bucket = home;
+  for (size_t walked = 0;; walked++) {
+    // what is carried would end up too far, or the table is full
+    if (distance >= probe_length || walked == size) {
+      return 0;
+    }
+    HASH_TABLE_BLOCK_TYPE *block = latches->BlockOf(bucket);
+    if (block == nullptr) {
+      return -1;
+    }
+    slot_offset_t slot = bucket % BLOCK_ARRAY_SIZE;
+    if (!block->IsOccupied(slot) || !block->IsReadable(slot)) {
+      break;
+    }
+    size_t entry_distance = (bucket + size - this->hash_fn_.GetHash(block->KeyAt(slot)) % size) % size;
+    if (entry_distance < distance) {
+      swaps.push_back(bucket);
+      distance = entry_distance;
+    }
+    bucket = (bucket + 1) % size;
+    distance++;
+  }
+
+  KeyType carried_key = key;
+  ValueType carried_value = value;
+  uint8_t carried_fingerprint = fingerprint;
+  for (size_t swap : swaps) {
+    HASH_TABLE_BLOCK_TYPE *block = latches->BlockOf(swap);
+    slot_offset_t slot = swap % BLOCK_ARRAY_SIZE;
+    KeyType entry_key = block->KeyAt(slot);
+    ValueType entry_value = block->ValueAt(slot);
+    block->Replace(slot, carried_key, carried_value, carried_fingerprint);
+    carried_key = entry_key;
+    carried_value = entry_value;
+    carried_fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(this->hash_fn_.GetHash(entry_key));
+  }
+  HASH_TABLE_BLOCK_TYPE *block = latches->BlockOf(bucket);
+  slot_offset_t slot = bucket % BLOCK_ARRAY_SIZE;
+  if (block->IsOccupied(slot)) {
+    block->Replace(slot, carried_key, carried_value, carried_fingerprint);
+  } else {
+    block->Insert(slot, carried_key, carried_value, carried_fingerprint);
+  }
+  latches->SetDirty();
+  *inserted = true;
+  return 1;
+}
+
+template class RobinHoodHashTable<int, int, IntComparator>;
+
+template class RobinHoodHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class RobinHoodHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class RobinHoodHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class RobinHoodHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class RobinHoodHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
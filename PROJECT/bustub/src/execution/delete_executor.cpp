@@ -33,12 +33,15 @@ bool DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
       throw bustub::Exception("shit happens when deleting tuples!");
     }
     for (auto &index_info : this->exec_ctx_->GetCatalog()->GetTableIndexes(this->table_info_->name_)) {
-      index_info->index_->DeleteEntry(
-          tuple->KeyFromTuple(this->table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs()),
-          *rid, this->exec_ctx_->GetTransaction());
+      Index *index = index_info->index_.get();
+      index->DeleteEntry(
+          tuple->KeyFromTuple(this->table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()), *rid,
+          this->exec_ctx_->GetTransaction());
     }
     return true;
   }
+  // the deleted keys stay in the Bloom filters of the indexes until they are rebuilt
+  this->exec_ctx_->GetCatalog()->RebuildStaleBloomFilters(this->exec_ctx_->GetTransaction(), this->table_info_->name_);
   return false;
 }
 
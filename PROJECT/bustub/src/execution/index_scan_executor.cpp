@@ -9,7 +9,13 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
 #include "execution/executors/index_scan_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
@@ -18,26 +24,139 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanP
 }
 
 void IndexScanExecutor::Init() {
-  Index *target_index = this->exec_ctx_->GetCatalog()->GetIndex(this->plan_->GetIndexOid())->index_.get();
-  this->it_ =
-      reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(target_index)->GetBeginIterator();
+  Catalog *catalog = this->exec_ctx_->GetCatalog();
+  IndexInfo *index_info = catalog->GetIndex(this->plan_->GetIndexOid());
+  TableMetadata *table_info = catalog->GetTable(index_info->table_name_);
+  this->table_heap_ = table_info->table_.get();
+  this->table_schema_ = &table_info->schema_;
+
+  // seek straight to the first bound in scan order instead of filtering the whole index
+  Index *target_index = index_info->index_.get();
+  this->index_ = target_index;
+  if (!this->plan_->IsPointLookup() && !target_index->SupportsRangeScan()) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Index only looks up the entries of one key.");
+  }
+  const Schema *key_schema = target_index->GetKeySchema();
+  this->low_key_ = Tuple();
+  this->high_key_ = Tuple();
+  if (!this->plan_->GetLowKey().empty()) {
+    this->low_key_ = Tuple(this->plan_->GetLowKey(), key_schema);
+  }
+  if (!this->plan_->GetHighKey().empty()) {
+    this->high_key_ = Tuple(this->plan_->GetHighKey(), key_schema);
+  }
+  this->rids_.clear();
+  this->entries_.clear();
+  this->cursor_ = 0;
+  this->remaining_ = this->plan_->GetLimit();
+  this->exhausted_ = false;
+  this->num_resume_entries_ = 0;
+
+  // the table is skipped when the index entries hold every column the scan reads
+  const std::vector<uint32_t> &entry_attrs = target_index->GetEntryAttrs();
+  this->index_only_ = this->plan_->IsIndexOnly() && target_index->SupportsIndexOnlyScan();
+  for (auto column : this->plan_->GetReferencedColumns()) {
+    if (std::find(entry_attrs.begin(), entry_attrs.end(), column) == entry_attrs.end()) {
+      this->index_only_ = false;
+    }
+  }
+  // a hash index finds the entries of one key without a range scan
+  if (!target_index->SupportsRangeScan()) {
+    target_index->ScanKey(this->low_key_, &this->rids_, this->exec_ctx_->GetTransaction());
+    if (this->rids_.size() > this->plan_->GetLimit()) {
+      this->rids_.resize(this->plan_->GetLimit());
+    }
+    this->exhausted_ = true;
+  }
+}
+
+bool IndexScanExecutor::FetchBatch() {
+  this->rids_.clear();
+  this->entries_.clear();
+  this->cursor_ = 0;
+  if (this->exhausted_ || this->remaining_ == 0) {
+    return false;
+  }
+  // the entries of the resume key scanned before come first again, they are fetched past the batch and skipped
+  size_t batch_size = std::min<size_t>(this->remaining_, INDEX_SCAN_BATCH_SIZE);
+  size_t limit = this->num_resume_entries_ + batch_size;
+  const Tuple *low_key = this->plan_->GetLowKey().empty() ? nullptr : &this->low_key_;
+  const Tuple *high_key = this->plan_->GetHighKey().empty() ? nullptr : &this->high_key_;
+  bool low_inclusive = this->plan_->IsLowInclusive();
+  bool high_inclusive = this->plan_->IsHighInclusive();
+  if (this->num_resume_entries_ > 0) {
+    if (this->plan_->IsDescending()) {
+      high_key = &this->resume_key_;
+      high_inclusive = true;
+    } else {
+      low_key = &this->resume_key_;
+      low_inclusive = true;
+    }
+  }
+  if (this->index_only_) {
+    this->index_->ScanRangeEntries(low_key, high_key, low_inclusive, high_inclusive, this->plan_->IsDescending(),
+                                   limit, &this->entries_, &this->rids_, this->exec_ctx_->GetTransaction());
+  } else {
+    this->index_->ScanRange(low_key, high_key, low_inclusive, high_inclusive, this->plan_->IsDescending(), limit,
+                            &this->rids_, this->exec_ctx_->GetTransaction());
+  }
+  this->exhausted_ = this->rids_.size() < limit;
+  size_t num_skipped = std::min(this->num_resume_entries_, this->rids_.size());
+  this->rids_.erase(this->rids_.begin(), this->rids_.begin() + num_skipped);
+  if (this->index_only_) {
+    this->entries_.erase(this->entries_.begin(), this->entries_.begin() + num_skipped);
+  }
+  this->remaining_ -= this->rids_.size();
+  return !this->rids_.empty();
+}
+
+void IndexScanExecutor::NoteScanned(Tuple *tuple) {
+  Tuple key = tuple->KeyFromTuple(*this->table_schema_, *this->index_->GetKeySchema(), this->index_->GetKeyAttrs());
+  bool same_key = this->num_resume_entries_ > 0;
+  for (uint32_t i = 0; same_key && i < this->index_->GetKeySchema()->GetColumnCount(); i++) {
+    Value value = key.GetValue(this->index_->GetKeySchema(), i);
+    Value resume_value = this->resume_key_.GetValue(this->index_->GetKeySchema(), i);
+    same_key = value.IsNull() ? resume_value.IsNull()
+                              : !resume_value.IsNull() && value.CompareEquals(resume_value) == CmpBool::CmpTrue;
+  }
+  if (same_key) {
+    this->num_resume_entries_++;
+  } else {
+    this->resume_key_ = key;
+    this->num_resume_entries_ = 1;
+  }
+}
+
+Tuple IndexScanExecutor::TupleFromEntry(const Tuple &entry) {
+  // a tuple of the table layout, with the columns the index does not store left NULL
+  std::vector<Value> values;
+  values.reserve(this->table_schema_->GetColumnCount());
+  for (const auto &column : this->table_schema_->GetColumns()) {
+    values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  const std::vector<uint32_t> &entry_attrs = this->index_->GetEntryAttrs();
+  for (uint32_t i = 0; i < entry_attrs.size(); i++) {
+    values[entry_attrs[i]] = entry.GetValue(this->index_->GetEntrySchema(), i);
+  }
+  return Tuple(values, this->table_schema_);
 }
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
-  while (!this->it_.isEnd()) {
-    auto p = *this->it_;
-    Tuple this_one{p.second};
-    *tuple = this_one;
-    *rid = p.second;
-    if (this->plan_->GetPredicate() != nullptr) {
-      if (this->plan_->GetPredicate()->Evaluate(tuple, this->GetOutputSchema()).GetAs<bool>()) {
-        ++this->it_;
-        return true;
-      } else {
-        ++this->it_;
-      }
+  while (this->cursor_ < this->rids_.size() || this->FetchBatch()) {
+    *rid = this->rids_[this->cursor_];
+    if (this->index_only_) {
+      *tuple = this->TupleFromEntry(this->entries_[this->cursor_]);
     } else {
-      ++this->it_;
+      this->table_heap_->GetTuple(*rid, tuple, this->exec_ctx_->GetTransaction());
+    }
+    this->cursor_++;
+    // the key is only needed to resume from, the last batch has none after it
+    if (!this->exhausted_) {
+      this->NoteScanned(tuple);
+    }
+    // the tuple has the table layout, which the column indexes of the predicate refer to
+    if (this->plan_->GetPredicate() == nullptr ||
+        this->plan_->GetPredicate()->Evaluate(tuple, this->table_schema_).GetAs<bool>()) {
       return true;
     }
   }
@@ -45,27 +45,32 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
       if (this->target_table_->InsertTuple(to_insert_tuple, &to_insert_rid, this->exec_ctx_->GetTransaction())) {
         for (auto &index_info : this->exec_ctx_->GetCatalog()->GetTableIndexes(this->target_table_metadata_->name_)) {
           index_info->index_->InsertEntry(
-              to_insert_tuple.KeyFromTuple(this->target_table_metadata_->schema_, index_info->key_schema_,
-                                           index_info->index_->GetKeyAttrs()),
+              to_insert_tuple.KeyFromTuple(this->target_table_metadata_->schema_, *index_info->index_->GetEntrySchema(),
+                                           index_info->index_->GetEntryAttrs()),
               to_insert_rid, this->exec_ctx_->GetTransaction());
         }
         this->it_++;
         return true;
       }
     }
+    // the inserted keys may have filled the Bloom filters of the indexes past what they were sized for
+    this->exec_ctx_->GetCatalog()->RebuildStaleBloomFilters(this->exec_ctx_->GetTransaction(),
+                                                            this->target_table_metadata_->name_);
     return false;
   } else {
     if (this->child_executor_->Next(&to_insert_tuple, &to_insert_rid)) {
       if (this->target_table_->InsertTuple(to_insert_tuple, &to_insert_rid, this->exec_ctx_->GetTransaction())) {
         for (auto &index_info : this->exec_ctx_->GetCatalog()->GetTableIndexes(this->target_table_metadata_->name_)) {
           index_info->index_->InsertEntry(
-              to_insert_tuple.KeyFromTuple(this->target_table_metadata_->schema_, index_info->key_schema_,
-                                           index_info->index_->GetKeyAttrs()),
+              to_insert_tuple.KeyFromTuple(this->target_table_metadata_->schema_, *index_info->index_->GetEntrySchema(),
+                                           index_info->index_->GetEntryAttrs()),
               to_insert_rid, this->exec_ctx_->GetTransaction());
         }
         return true;
       }
     }
+    this->exec_ctx_->GetCatalog()->RebuildStaleBloomFilters(this->exec_ctx_->GetTransaction(),
+                                                            this->target_table_metadata_->name_);
     return false;
   }
 }
@@ -27,35 +27,51 @@ void NestIndexJoinExecutor::Init() {
   this->index_info_ = this->exec_ctx_->GetCatalog()->GetIndex(
       this->plan_->GetIndexName(), this->exec_ctx_->GetCatalog()->GetTable(this->plan_->GetInnerTableOid())->name_);
   this->table_info_ = this->exec_ctx_->GetCatalog()->GetTable(this->plan_->GetInnerTableOid());
+  this->outer_tuples_.clear();
+  this->inner_rids_.clear();
+  this->outer_index_ = 0;
+  this->inner_index_ = 0;
 }
 
 bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  Tuple left_tuple, right_to_search_tuple;
-  RID left_tuple_RID, right_to_search_RID;
-  while (this->child_executor_->Next(&right_to_search_tuple, &right_to_search_RID)) {
-    left_tuple = right_to_search_tuple.KeyFromTuple(*this->plan_->OuterTableSchema(), this->index_info_->key_schema_,
-                                                    this->index_info_->index_->GetKeyAttrs());
-    std::vector<RID> result;
-    this->index_info_->index_->ScanKey(left_tuple, &result, this->exec_ctx_->GetTransaction());
-    if (result.size() > 0) {
-      assert(result.size() == 1);
-      Tuple t;
-      this->table_info_->table_->GetTuple(result[0], &t, this->exec_ctx_->GetTransaction());
-      if (this->plan_->Predicate()
-              ->EvaluateJoin(&t, this->plan_->InnerTableSchema(), &right_to_search_tuple,
-                             this->plan_->OuterTableSchema())
-              .GetAs<bool>()) {
-        std::vector<Value> values;
-        for (auto &col : GetOutputSchema()->GetColumns()) {
-          values.push_back(col.GetExpr()->EvaluateJoin(&t, this->plan_->InnerTableSchema(), &right_to_search_tuple,
-                                                       this->plan_->OuterTableSchema()));
+  while (true) {
+    // an outer tuple may match several inner tuples, they are joined one per call
+    for (; this->outer_index_ < this->outer_tuples_.size(); this->outer_index_++, this->inner_index_ = 0) {
+      Tuple &outer_tuple = this->outer_tuples_[this->outer_index_];
+      const std::vector<RID> &inner_rids = this->inner_rids_[this->outer_index_];
+      while (this->inner_index_ < inner_rids.size()) {
+        Tuple t;
+        this->table_info_->table_->GetTuple(inner_rids[this->inner_index_++], &t, this->exec_ctx_->GetTransaction());
+        if (this->plan_->Predicate()
+                ->EvaluateJoin(&t, this->plan_->InnerTableSchema(), &outer_tuple, this->plan_->OuterTableSchema())
+                .GetAs<bool>()) {
+          std::vector<Value> values;
+          for (auto &col : GetOutputSchema()->GetColumns()) {
+            values.push_back(col.GetExpr()->EvaluateJoin(&t, this->plan_->InnerTableSchema(), &outer_tuple,
+                                                         this->plan_->OuterTableSchema()));
+          }
+          *tuple = Tuple(values, GetOutputSchema());
+          return true;
         }
-        *tuple = Tuple(values, GetOutputSchema());
-        return true;
       }
     }
+    // probe the keys of the next batch of outer tuples together
+    this->outer_tuples_.clear();
+    this->outer_index_ = 0;
+    this->inner_index_ = 0;
+    std::vector<Tuple> keys;
+    Tuple outer_tuple;
+    RID outer_rid;
+    while (this->outer_tuples_.size() < OUTER_BATCH_SIZE && this->child_executor_->Next(&outer_tuple, &outer_rid)) {
+      keys.push_back(outer_tuple.KeyFromTuple(*this->plan_->OuterTableSchema(), this->index_info_->key_schema_,
+                                              this->index_info_->index_->GetKeyAttrs()));
+      this->outer_tuples_.push_back(outer_tuple);
+    }
+    if (this->outer_tuples_.empty()) {
+      return false;
+    }
+    this->index_info_->index_->ScanKeys(keys, &this->inner_rids_, this->exec_ctx_->GetTransaction());
   }
-  return false;
 }
 
 }  // namespace bustub
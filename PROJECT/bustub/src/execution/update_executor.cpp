@@ -32,15 +32,18 @@ bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
     Tuple updated_tuple = this->GenerateUpdatedTuple(*tuple);
     this->table_info_->table_->UpdateTuple(updated_tuple, updated_tuple.GetRid(), this->exec_ctx_->GetTransaction());
     for (auto &index_info : this->exec_ctx_->GetCatalog()->GetTableIndexes(this->table_info_->name_)) {
-      index_info->index_->DeleteEntry(
-          tuple->KeyFromTuple(this->table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs()),
-          *rid, this->exec_ctx_->GetTransaction());
-      index_info->index_->InsertEntry(updated_tuple.KeyFromTuple(this->table_info_->schema_, index_info->key_schema_,
-                                                                 index_info->index_->GetKeyAttrs()),
-                                      updated_tuple.GetRid(), this->exec_ctx_->GetTransaction());
+      Index *index = index_info->index_.get();
+      index->DeleteEntry(
+          tuple->KeyFromTuple(this->table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()), *rid,
+          this->exec_ctx_->GetTransaction());
+      index->InsertEntry(
+          updated_tuple.KeyFromTuple(this->table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs()),
+          updated_tuple.GetRid(), this->exec_ctx_->GetTransaction());
     }
     return true;
   }
+  // the deleted keys stay in the Bloom filters of the indexes until they are rebuilt
+  this->exec_ctx_->GetCatalog()->RebuildStaleBloomFilters(this->exec_ctx_->GetTransaction(), this->table_info_->name_);
   return false;
 }
 }  // namespace bustub
@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
@@ -91,6 +95,14 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Read a page into the buffer pool in the background, e.g. the next leaves of an index scan, so that a later
+   * FetchPage finds it there. The page is not pinned, and nothing is read if it is already in the pool, if too many
+   * pages are waiting to be read, or if no frame can be freed.
+   * @param page_id id of page to be prefetched
+   */
+  void PrefetchPage(page_id_t page_id);
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
@@ -154,6 +166,17 @@ class BufferPoolManager {
 
   bool HasFreePage();
 
+  /**
+   * Read the pages asked for by PrefetchPage, until the buffer pool is destroyed.
+   */
+  void RunPrefetch();
+
+  /**
+   * Read a page into a free or victim frame and leave it unpinned, unless it is already in the pool.
+   * @param page_id id of page to be read
+   */
+  void PrefetchPageImpl(page_id_t page_id);
+
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
@@ -170,5 +193,15 @@ class BufferPoolManager {
   std::list<frame_id_t> free_list_;
   /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
   std::mutex latch_;
+  /** Pages being read by the prefetch thread, without latch_, FetchPage waits on loaded_cv_ for them. */
+  std::unordered_set<page_id_t> loading_;
+  std::condition_variable loaded_cv_;
+  /** Pages waiting to be prefetched, with the thread reading them, started by the first PrefetchPage. */
+  std::deque<page_id_t> prefetch_queue_;
+  std::thread *prefetch_thread_{nullptr};
+  bool stop_prefetch_{false};
+  /** This latch protects the prefetch queue, the thread and the stop flag. */
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
 };
 }  // namespace bustub
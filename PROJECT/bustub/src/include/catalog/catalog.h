@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -10,6 +12,8 @@
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
+#include "storage/index/index_statistics.h"
+#include "storage/index/linear_probe_hash_table_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -51,6 +55,8 @@ struct IndexInfo {
   index_oid_t index_oid_;
   std::string table_name_;
   const size_t key_size_;
+  /** Size and key distribution of the index as of the last Catalog::AnalyzeIndex, nullptr before */
+  std::unique_ptr<IndexStatistics> stats_;
 };
 
 /**
@@ -104,7 +110,7 @@ class Catalog {
   }
 
   /**
-   * Create a new index, populate existing data of the table and return its metadata.
+   * Create a new index, populate existing data of the table, compute its statistics and return its metadata.
    * @param txn the transaction in which the table is being created
    * @param index_name the name of the new index
    * @param table_name the name of the table
@@ -112,22 +118,97 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param is_unique false for an index whose key may repeat, e.g. on a join column
+   * @param include_attrs non-key columns stored with every key for index-only scans, the key type must hold them
+   * @param index_type a B+ tree, or a hash table for an index only looked up by equality
+   * @param options how a B+ tree stores its entries, fixed-size slots by default
+   * @throws Exception if the table holds equal keys for a unique B+ tree index, nothing is created then
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    IndexMetadata *metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs);
-    Index *index = new BPlusTreeIndex<KeyType, ValueType, KeyComparator>(metadata, this->bpm_);
-    IndexInfo *info = new IndexInfo(key_schema, index_name, std::unique_ptr<Index>(index), this->next_index_oid_,
-                                    table_name, keysize);
+                         size_t keysize, bool is_unique = true, const std::vector<uint32_t> &include_attrs = {},
+                         IndexType index_type = IndexType::BPlusTree, const IndexOptions &options = {}) {
+    auto metadata = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique,
+                                                    include_attrs, options, index_type);
+    // the index owns its metadata once it is constructed, and frees its pages if filling it throws
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::Hash) {
+      auto hash_index = std::make_unique<LinearProbeHashTableIndex<KeyType, ValueType, KeyComparator>>(
+          metadata.release(), this->bpm_, HASH_INDEX_MIN_BUCKETS, HashFunction<KeyType>());
+      hash_index->BuildFromTable(this->GetTable(table_name)->table_.get(), schema, txn);
+      index = std::move(hash_index);
+    } else {
+      auto tree_index =
+          std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(metadata.release(), this->bpm_);
+      // the tuples already in the table are sorted and loaded bottom up, on every core
+      tree_index->BuildFromTable(this->GetTable(table_name)->table_.get(), schema,
+                                 std::max(1U, std::thread::hardware_concurrency()), txn);
+      index = std::move(tree_index);
+    }
+    IndexInfo *info =
+        new IndexInfo(key_schema, index_name, std::move(index), this->next_index_oid_, table_name, keysize);
+    this->AnalyzeIndex(txn, info);
     this->indexes_[this->next_index_oid_] = std::unique_ptr<IndexInfo>(info);
     this->index_names_[table_name][index_name] = this->next_index_oid_;
     this->next_index_oid_++;
     return info;
   }
 
+  /**
+   * Recompute the statistics of an index, exactly or from a sample of its leaves.
+   * @param txn the transaction in which the statistics are computed
+   * @param index_info the index
+   * @param sample_leaves the number of leaves to sample, 0 to read every leaf
+   * @return false if the index keeps no statistics, its stats_ are then left as they were
+   */
+  bool AnalyzeIndex(Transaction *txn, IndexInfo *index_info, size_t sample_leaves = 0) {
+    auto stats = std::make_unique<IndexStatistics>();
+    if (!index_info->index_->ComputeStatistics(sample_leaves, INDEX_HISTOGRAM_BUCKETS, stats.get(), txn)) {
+      return false;
+    }
+    index_info->stats_ = std::move(stats);
+    return true;
+  }
+
+  /**
+   * (Re)build a Bloom filter of the keys of an index from its table, ScanKey then answers most keys the index does not
+   * hold without reading a page. The index adds inserted keys to the filter from then on.
+   * @param txn the transaction in which the filter is built
+   * @param index_info the index
+   */
+  void BuildBloomFilter(Transaction *txn, IndexInfo *index_info) {
+    TableHeap *table_heap = this->GetTable(index_info->table_name_)->table_.get();
+    const Schema &schema = this->GetTable(index_info->table_name_)->schema_;
+    Index *index = index_info->index_.get();
+    // sized for the keys the filter it replaces holds, or the entries the statistics counted on a first build; one
+    // sized too small reports NeedsRebuild once the keys are in and is rebuilt after the next statement
+    size_t expected_keys = index->BloomFilterNumLiveKeys();
+    if (index->GetBloomFilter() == nullptr && index_info->stats_ != nullptr) {
+      expected_keys = index_info->stats_->num_entries_;
+    }
+    index->BeginBloomFilterBuild(expected_keys);
+    for (auto iter = table_heap->Begin(txn); iter != table_heap->End(); ++iter) {
+      index->AddToBloomFilterBuild(iter->KeyFromTuple(schema, *index->GetKeySchema(), index->GetKeyAttrs()));
+    }
+    index->FinishBloomFilterBuild();
+  }
+
+  /**
+   * Rebuild the Bloom filters of the indexes of a table that hold too many deleted keys, or more keys than they were
+   * sized for, e.g. after a statement deleted or updated tuples.
+   * @param txn the transaction in which the filters are rebuilt
+   * @param table_name the name of the table
+   */
+  void RebuildStaleBloomFilters(Transaction *txn, const std::string &table_name) {
+    for (IndexInfo *index_info : this->GetTableIndexes(table_name)) {
+      if (index_info->index_->BloomFilterNeedsRebuild()) {
+        this->BuildBloomFilter(txn, index_info);
+      }
+    }
+  }
+
   IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
     if (this->index_names_.find(table_name) == this->index_names_.end()) {
       throw new std::out_of_range(table_name + " doesn't exist!");
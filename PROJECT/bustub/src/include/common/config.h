@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// config.h
+//
+// Identification: src/include/common/config.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+namespace bustub {
+
+/** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
+extern std::chrono::milliseconds cycle_detection_interval;
+
+/** Background compaction of B+ trees with lazy merging runs every INDEX_COMPACTION_INTERVAL milliseconds. */
+extern std::chrono::milliseconds index_compaction_interval;
+
+/** True if logging should be enabled, false otherwise. */
+extern std::atomic<bool> enable_logging;
+
+/** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
+extern std::chrono::duration<int64_t> log_timeout;
+
+static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
+static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
+static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
+static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
+static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
+static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
+static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int INDEX_HISTOGRAM_BUCKETS = 32;                            // buckets of an index histogram
+static constexpr int INDEX_SCAN_PREFETCH_LEAVES = 4;                          // leaves an index scan reads ahead
+static constexpr int INDEX_SCAN_BATCH_SIZE = 256;                             // RIDs an index scan fetches at once
+static constexpr int HASH_TABLE_MIGRATE_BUCKETS = 64;                         // buckets a hash table op rehashes
+static constexpr int HASH_INDEX_MIN_BUCKETS = 1024;                           // initial buckets of a hash index
+static constexpr int HASH_TABLE_MAX_PROBE_LENGTH = 64;                        // buckets a Robin Hood probe reaches
+static constexpr int BLOOM_FILTER_BITS_PER_KEY = 10;                          // bits of a Bloom filter per key
+static constexpr int BLOOM_FILTER_NUM_PROBES = 6;                             // bits a Bloom filter sets per key
+static constexpr int BLOOM_FILTER_MIN_KEYS = 1024;                            // smallest key capacity of a filter
+
+using frame_id_t = int32_t;    // frame id type
+using page_id_t = int32_t;     // page id type
+using txn_id_t = int32_t;      // transaction id type
+using lsn_t = int32_t;         // log sequence number type
+using slot_offset_t = size_t;  // slot offset type
+using oid_t = uint16_t;
+
+}  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
@@ -27,17 +28,39 @@ using hash_t = std::size_t;
 class HashUtil {
  private:
   static const hash_t prime_factor = 10000019;
+  // odd 64-bit constants from the digits of the golden ratio and of pi
+  static const uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+  static const uint64_t seed = 0x243f6a8885a308d3ULL;
+
+  /** @return the high and the low half of the 128-bit product xor'ed, every bit depends on every bit of the inputs */
+  static inline uint64_t MultiplyFold(uint64_t l, uint64_t r) {
+    __uint128_t product = static_cast<__uint128_t>(l) * r;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  }
 
  public:
+  /**
+   * Hashes the bytes eight at a time, folding each word in with one 64x64->128 bit multiply, in the spirit of wyhash.
+   */
   static inline hash_t HashBytes(const char *bytes, size_t length) {
-    // https://github.com/greenplum-db/gpos/blob/b53c1acd6285de94044ff91fbee91589543feba1/libgpos/src/utils.cpp#L126
-    hash_t hash = length;
-    for (size_t i = 0; i < length; ++i) {
-      hash = ((hash << 5) ^ (hash >> 27)) ^ bytes[i];
+    uint64_t hash = seed ^ length;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, bytes + i, sizeof(uint64_t));
+      hash = MultiplyFold(hash ^ word, multiplier);
     }
-    return hash;
+    if (i < length) {
+      uint64_t word = 0;
+      memcpy(&word, bytes + i, length - i);
+      hash = MultiplyFold(hash ^ word, multiplier);
+    }
+    return MultiplyFold(hash ^ seed, multiplier);
   }
 
+  /** @return the hash of an integer, one multiply, with well mixed low and high bits */
+  static inline hash_t HashInt(uint64_t value) { return MultiplyFold(value ^ seed, multiplier); }
+
   static inline hash_t CombineHashes(hash_t l, hash_t r) {
     hash_t both[2];
     both[0] = l;
@@ -82,6 +105,10 @@ class HashUtil {
       }
       case TypeId::DECIMAL: {
         auto raw = val->GetAs<double>();
+        // -0.0 equals 0.0, and so must hash alike
+        if (raw == 0) {
+          raw = 0;
+        }
         return Hash<double>(&raw);
       }
       case TypeId::VARCHAR: {
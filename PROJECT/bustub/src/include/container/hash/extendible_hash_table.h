@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hash table that is backed by a buffer pool
+ * manager. Non-unique keys are supported. Supports insert and delete.
+ *
+ * A directory page maps the lowest global depth bits of the hash of a key to a
+ * bucket page, so a lookup reads one bucket. The table grows by splitting the
+ * one bucket that is full, doubling the directory only when that bucket's
+ * local depth is the global depth, and shrinks by merging an emptied bucket
+ * with its split image. Inserts, removes and lookups share table_latch_ and
+ * latch the bucket page; splits and merges take table_latch_ exclusively.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable, of one bucket
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the pair is there already
+   * @throws Exception OUT_OF_RANGE if the bucket of the pair is full and
+   * cannot split: every pair in it has the hash of key, or the directory
+   * cannot grow any more
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth();
+
+  /**
+   * Asserts the invariants of the directory.
+   */
+  void VerifyIntegrity();
+
+ private:
+  uint32_t Hash(const KeyType &key);
+
+  HashTableDirectoryPage *FetchDirectoryPage();
+
+  Page *FetchBucketPage(page_id_t bucket_page_id);
+
+  /**
+   * Splits the bucket of a key until the pair fits, with table_latch_ held exclusively.
+   * @return true if the pair was inserted, false if it is there already
+   */
+  bool SplitInsert(const KeyType &key, const ValueType &value);
+
+  /**
+   * Merges the bucket of a key with its split image while either of them is empty, and halves the directory while it
+   * can, with table_latch_ held exclusively.
+   */
+  void Merge(const KeyType &key);
+
+  // member variable
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers includes inserts and removes, writers are splits and merges
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
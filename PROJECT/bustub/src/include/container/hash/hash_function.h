@@ -13,11 +13,15 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 
-#include "murmur3/MurmurHash3.h"
+#include "common/util/hash_util.h"
 
 namespace bustub {
 
+template <size_t KeySize>
+class GenericKey;
+
 template <typename KeyType>
 class HashFunction {
  public:
@@ -26,10 +30,52 @@ class HashFunction {
    * @return the hashed value
    */
   virtual uint64_t GetHash(KeyType key) {
-    uint64_t hash[2];
-    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
-                                 reinterpret_cast<void *>(&hash));
-    return hash[0];
+    return HashUtil::HashBytes(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  }
+};
+
+/*
+ * Integer keys are hashed as one word.
+ */
+template <>
+inline uint64_t HashFunction<int32_t>::GetHash(int32_t key) {
+  return HashUtil::HashInt(static_cast<uint64_t>(key));
+}
+
+template <>
+inline uint64_t HashFunction<int64_t>::GetHash(int64_t key) {
+  return HashUtil::HashInt(static_cast<uint64_t>(key));
+}
+
+template <>
+inline uint64_t HashFunction<uint32_t>::GetHash(uint32_t key) {
+  return HashUtil::HashInt(key);
+}
+
+template <>
+inline uint64_t HashFunction<uint64_t>::GetHash(uint64_t key) {
+  return HashUtil::HashInt(key);
+}
+
+/*
+ * A generic key is zeroed past the tuple it was set from, so only the bytes up
+ * to its last word that is not zero are hashed: keys that are equal byte by
+ * byte still hash the same, and a bigint in a GenericKey<64> hashes one word.
+ */
+template <size_t KeySize>
+class HashFunction<GenericKey<KeySize>> {
+ public:
+  virtual uint64_t GetHash(const GenericKey<KeySize> &key) {
+    size_t length = KeySize;
+    while (length >= sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, key.data_ + length - sizeof(uint64_t), sizeof(uint64_t));
+      if (word != 0) {
+        break;
+      }
+      length -= sizeof(uint64_t);
+    }
+    return HashUtil::HashBytes(key.data_, length);
   }
 };
 
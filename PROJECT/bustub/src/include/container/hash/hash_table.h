@@ -52,6 +52,22 @@ class HashTable {
    * @return the value(s) associated with the given key
    */
   virtual bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) = 0;
+
+  /**
+   * Inserts many key-value pairs, e.g. to build an index over a table. Tables
+   * that can size themselves for the pairs and insert them together override
+   * this.
+   * @param transaction the current transaction
+   * @param pairs the pairs to insert
+   * @return the number of pairs inserted
+   */
+  virtual size_t BulkInsert(Transaction *transaction, const std::vector<MappingType> &pairs) {
+    size_t inserted = 0;
+    for (const auto &pair : pairs) {
+      inserted += this->Insert(transaction, pair.first, pair.second) ? 1 : 0;
+    }
+    return inserted;
+  }
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -32,6 +33,17 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Bucket i is slot i % BLOCK_ARRAY_SIZE of block i / BLOCK_ARRAY_SIZE, the
+ * header page lists the blocks. Inserts, removes and lookups share table_latch_
+ * and latch one block page at a time while they probe. Removed entries leave
+ * tombstones, which are only dropped by a resize.
+ *
+ * Resize takes table_latch_ exclusively only to allocate a table twice the
+ * size. The entries move to it incrementally: every operation afterwards first
+ * rehashes the next HASH_TABLE_MIGRATE_BUCKETS buckets of the old table, and
+ * until all of them are done lookups and removes look in both tables, inserts
+ * go to the new one. The old pages are freed once the last bucket moved.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -74,11 +86,32 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
    */
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
+  /**
+   * Inserts many key-value pairs at once. The table first grows to twice the
+   * number of pairs and finishes moving the entries of a resize, then the
+   * pairs are partitioned by the block of their hash and inserted one block at
+   * a time, so each block page is fetched and latched once. Pairs whose probe
+   * runs past their block are inserted one by one afterwards. Takes
+   * table_latch_ exclusively.
+   * @param transaction the current transaction
+   * @param pairs the pairs to insert
+   * @return the number of pairs inserted, pairs already in the table are not
+   */
+  size_t BulkInsert(Transaction *transaction, const std::vector<MappingType> &pairs) override;
+
+  /**
+   * Deletes the pages of the table, e.g. of an index that failed to build.
+   * The table cannot be used afterwards.
+   */
+  void Destroy();
+
   /**
    * Resizes the table to at least twice the initial size provided.
    * @param initial_size the initial size of the hash table
+   * @return false if the entries of a migration left unfinished had no room in a table of the largest size, they stay
+   * in the tables they were in then
    */
-  void Resize(size_t initial_size);
+  bool Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
@@ -86,11 +119,139 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
    */
   size_t GetSize();
 
- private:
+  /**
+   * Gets the average number of buckets a lookup probes to find an entry, 1 if
+   * every entry is in the bucket of its hash.
+   * @return the average probe length of the entries
+   */
+  double GetAverageProbeLength();
+
+  /**
+   * Counts the entries by the number of buckets a lookup probes to find them.
+   * @return the number of entries found after probing i + 1 buckets, at index i
+   */
+  std::vector<size_t> GetProbeLengthHistogram();
+
+ protected:
+  /**
+   * Allocates a header page and the block pages for num_buckets buckets.
+   * @return the page id of the new header page
+   */
+  page_id_t CreateTable(size_t num_buckets);
+
+  /**
+   * Visits the buckets of a key in probe order, with the block page latched
+   * (exclusively if exclusive is set), until visit returns true, after the
+   * first bucket never occupied, or after max_probe_length_ buckets, or every
+   * bucket of the table. Only the
+   * buckets that hold the key are visited, and the one never occupied: the
+   * fingerprints of a block are matched first, and full keys are compared in
+   * the buckets whose fingerprint matches.
+   * @return true if visit returned true, false otherwise
+   */
+  template <typename Visitor>
+  bool Probe(HashTableHeaderPage *header, const KeyType &key, bool exclusive, Visitor &&visit);
+
+  /**
+   * Visits the buckets of a key in the slots [begin, limit) of a latched block
+   * like Probe does.
+   * @param[out] end the first slot never occupied from begin on, limit if there is none
+   * @return true if visit returned true, false otherwise
+   */
+  template <typename Visitor>
+  bool ProbeBlock(HASH_TABLE_BLOCK_TYPE *block, const KeyType &key, uint8_t fingerprint, slot_offset_t begin,
+                  slot_offset_t limit, slot_offset_t *end, Visitor &&visit);
+
+  /**
+   * Inserts a pair into a slot never occupied, or finds it in the slot of a
+   * key that matched, while probing for the pair.
+   * @param[out] inserted whether the pair was inserted
+   * @return true if the probe is over
+   */
+  bool InsertAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot, const KeyType &key, const ValueType &value,
+                uint8_t fingerprint, bool *inserted);
+
+  /**
+   * Looks for a pair in the slots [begin, limit) of a latched block like
+   * ProbeBlock does.
+   * @param[out] end the first slot never occupied from begin on, limit if there is none
+   * @return true if the block has the pair
+   */
+  bool BlockHasPair(HASH_TABLE_BLOCK_TYPE *block, const KeyType &key, const ValueType &value, uint8_t fingerprint,
+                    slot_offset_t begin, slot_offset_t limit, slot_offset_t *end);
+
+  /**
+   * Inserts a pair into the first bucket never occupied after its hash, unless
+   * the table already has it. The caller holds table_latch_.
+   * @param[out] inserted whether the pair was inserted
+   * @return false if every bucket the probe reaches is occupied, true otherwise
+   */
+  virtual bool InsertImpl(HashTableHeaderPage *header, const KeyType &key, const ValueType &value, bool *inserted);
+
+  /**
+   * Takes table_latch_ in read mode and pins the header page, and the one of
+   * the old table while it migrates, after moving some of its buckets.
+   * @param[out] old_header the header of the old table, nullptr if there is none
+   */
+  HashTableHeaderPage *BeginOperation(HashTableHeaderPage **old_header);
+
+  /**
+   * Unpins the header pages and releases table_latch_, then frees the old
+   * table if every bucket of it moved.
+   */
+  void EndOperation(HashTableHeaderPage *old_header);
+
+  /**
+   * Moves the entries of the next count buckets of the old table to the new
+   * one. Threads claim different buckets, each holding the latch of the old
+   * block while its entries move, so they are always in one of the tables.
+   * Buckets whose entries do not all fit in the new table are not counted as
+   * moved.
+   * @return true if this moved the last buckets
+   */
+  bool MigrateBuckets(HashTableHeaderPage *old_header, HashTableHeaderPage *header, size_t count);
+
+  /**
+   * Moves the entries of the buckets in [bucket, end) of a table to another
+   * one, and stops at the first entry that does not fit, which stays.
+   * @return false if the other table had no room for every entry
+   */
+  bool MoveBuckets(HashTableHeaderPage *from_header, HashTableHeaderPage *to_header, size_t bucket, size_t end);
+
+  /**
+   * Inserts every entry of a table into another one, leaving them in the
+   * first. The caller holds table_latch_ in write mode.
+   * @return false if the other table had no room for every entry
+   */
+  bool CopyTable(HashTableHeaderPage *from_header, HashTableHeaderPage *to_header);
+
+  /**
+   * Moves every entry left in the old table to the new one and frees it. The
+   * caller holds table_latch_ in write mode.
+   * @return false if the new table had no room for them, the old table is kept then
+   */
+  bool FinishMigration(HashTableHeaderPage *header);
+
+  /**
+   * Deletes the pages of a table. The caller holds table_latch_ in write mode.
+   */
+  void FreeTable(page_id_t header_page_id);
+
+  HashTableHeaderPage *FetchHeaderPage(page_id_t header_page_id);
+
   // member variable
   page_id_t header_page_id_;
+  // the table being migrated after a resize, INVALID_PAGE_ID if none
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // the next bucket of the old table to be claimed, and the buckets moved so far
+  std::atomic<size_t> migrate_next_{0};
+  std::atomic<size_t> migrated_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  // the buckets a probe reaches at most, inserts that would place an entry further grow the table instead
+  size_t max_probe_length_{SIZE_MAX};
+  // the pairs of the last BulkInsert whose probe ran past their block, inserted one by one
+  size_t num_bulk_spilled_{0};
 
   // Readers includes inserts and removes, writer is only resize
   ReaderWriterLatch table_latch_;
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// robin_hood_hash_table.h
+//
+// Identification: src/include/container/hash/robin_hood_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "container/hash/linear_probe_hash_table.h"
+
+namespace bustub {
+
+#define ROBIN_HOOD_HASH_TABLE_TYPE RobinHoodHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * A linear probing hash table that inserts with Robin Hood hashing: a pair
+ * being inserted takes the bucket of an entry nearer to its own bucket, which
+ * moves on in its place. Probes get about as long for every entry, and no
+ * entry is placed more than HASH_TABLE_MAX_PROBE_LENGTH buckets after its
+ * hash: the table grows when one would be, so lookups stop there, and most of
+ * them stay within one block page even in a full table.
+ *
+ * Lookups and removes are those of LinearProbeHashTable. An insert latches
+ * every block page its pairs move across, in the order of the blocks, so
+ * that concurrent inserts do not deadlock, and lookups that pass a moving
+ * pair see it once.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class RobinHoodHashTable : public LinearProbeHashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new RobinHoodHashTable
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param num_buckets initial number of buckets contained by this hash table
+   * @param hash_fn the hash function
+   */
+  explicit RobinHoodHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                              const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
+
+ protected:
+  /**
+   * Inserts a pair unless the table already has it. The pair walks from the
+   * bucket of its hash, swapping with every entry that is nearer its own
+   * bucket, until what it carries takes a bucket never occupied or a
+   * tombstone. The caller holds table_latch_.
+   * @param[out] inserted whether the pair was inserted
+   * @return false if an entry would end up further than max_probe_length_ buckets from its bucket, true otherwise
+   */
+  bool InsertImpl(HashTableHeaderPage *header, const KeyType &key, const ValueType &value, bool *inserted) override;
+
+ private:
+  /**
+   * Latches the block pages of an insert exclusively, in block order. A block
+   * that comes before one already latched is not latched, the insert is
+   * retried with every block it needs latched up front.
+   */
+  class BlockLatches {
+   public:
+    BlockLatches(BufferPoolManager *buffer_pool_manager, HashTableHeaderPage *header,
+                 const std::vector<size_t> &block_indexes);
+
+    ~BlockLatches();
+
+    /** @return the block of a bucket, latched, nullptr if it comes before a block already latched */
+    HASH_TABLE_BLOCK_TYPE *BlockOf(size_t bucket);
+
+    /** @return the indexes of the blocks latched, and of the one that was not */
+    const std::vector<size_t> &GetBlockIndexes() const { return this->block_indexes_; }
+
+    /** Marks the pages dirty, to be unpinned so. */
+    void SetDirty() { this->dirty_ = true; }
+
+   private:
+    BufferPoolManager *buffer_pool_manager_;
+    HashTableHeaderPage *header_;
+    std::vector<size_t> block_indexes_;
+    std::vector<Page *> pages_;
+    bool dirty_{false};
+  };
+
+  /**
+   * Inserts a pair with the blocks latched.
+   * @return 1 if the probe was over, 0 if there was no room, -1 if a block could not be latched
+   */
+  int InsertLatched(BlockLatches *latches, size_t size, const KeyType &key, const ValueType &value, bool *inserted);
+};
+
+}  // namespace bustub
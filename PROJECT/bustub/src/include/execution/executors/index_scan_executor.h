@@ -24,6 +24,11 @@ namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * The RIDs of the range are fetched from the index INDEX_SCAN_BATCH_SIZE at a
+ * time. A batch resumes from the key of the last entry scanned, and skips the
+ * entries of that key scanned before. Like table iterators, the scan sees the
+ * entries changed between batches, e.g. by the plan above it.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,8 +47,35 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  /** @return the tuple of the table an index entry stands for, as far as the entry holds its columns */
+  Tuple TupleFromEntry(const Tuple &entry);
+
+  /** Fetches the next batch of RIDs, and entries, of the range. @return false if there are none left */
+  bool FetchBatch();
+
+  /** Notes that the entry of tuple, a tuple of the table, was scanned, the next batch resumes from its key. */
+  void NoteScanned(Tuple *tuple);
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
-  IndexIterator<GenericKey<8>, RID, GenericComparator<8>> it_;
+  /** The scanned index, and the table it refers to. */
+  Index *index_;
+  TableHeap *table_heap_;
+  const Schema *table_schema_;
+  /** The bounds of the scanned range, as tuples of the key schema. */
+  Tuple low_key_;
+  Tuple high_key_;
+  /** The RIDs of the index entries of the current batch, and the next one to return. */
+  std::vector<RID> rids_;
+  size_t cursor_{0};
+  /** The number of entries left to fetch under the limit, and whether the index has none left in the range. */
+  size_t remaining_{0};
+  bool exhausted_{false};
+  /** The key of the last entry scanned, and the number of entries of that key scanned so far. */
+  Tuple resume_key_;
+  size_t num_resume_entries_{0};
+  /** Whether the tuples are built from the index entries, which are kept along the RIDs then. */
+  bool index_only_{false};
+  std::vector<Tuple> entries_;
 };
 }  // namespace bustub
@@ -53,5 +53,15 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   std::unique_ptr<AbstractExecutor> child_executor_;
   IndexInfo *index_info_;
   TableMetadata *table_info_;
+  /** The number of outer tuples whose keys are looked up in the index together. */
+  static constexpr size_t OUTER_BATCH_SIZE = 128;
+  /**
+   * A batch of outer tuples and the inner tuples each key matches, with duplicate keys there may be several, and
+   * the outer tuple and inner tuple to join next.
+   */
+  std::vector<Tuple> outer_tuples_;
+  std::vector<std::vector<RID>> inner_rids_;
+  size_t outer_index_{0};
+  size_t inner_index_{0};
 };
 }  // namespace bustub
@@ -12,13 +12,26 @@
 
 #pragma once
 
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * The scan may be bounded by a range of index keys, e.g. for WHERE ts BETWEEN lo AND hi, then it only reads the
+ * index entries within the range. The predicate is still checked against every tuple in the range.
+ * A descending scan returns the tuples from the largest key down. With a limit, e.g. for ORDER BY ... DESC LIMIT n
+ * on the index key, it stops after the first limit index entries, so it only reads the leaves those are on.
+ * An index-only scan builds the tuples from the index entries when the index stores every column the scan reads,
+ * as key or INCLUDE columns, instead of fetching each tuple from the table.
+ * A scan whose bounds are the same key, both inclusive, e.g. for WHERE id = 42, is a point lookup, the only scan a
+ * hash index supports.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -28,9 +41,30 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
    * @param table_oid the identifier of table to be scanned
+   * @param low_key the values of the index key columns the scan starts at, empty to start at the first key
+   * @param high_key the values of the index key columns the scan stops at, empty to scan to the last key
+   * @param low_inclusive whether keys equal to low_key are scanned
+   * @param high_inclusive whether keys equal to high_key are scanned
+   * @param descending whether the range is scanned in reverse key order
+   * @param limit the number of index entries to scan at most, the predicate is checked after the limit so it
+   * should only be set without one
+   * @param index_only whether the scan may return tuples built from the index entries, the columns the scan does
+   * not read are NULL in those, so it must not feed a delete or an update
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    std::vector<Value> low_key = {}, std::vector<Value> high_key = {}, bool low_inclusive = true,
+                    bool high_inclusive = true, bool descending = false,
+                    size_t limit = std::numeric_limits<size_t>::max(), bool index_only = false)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        low_key_(std::move(low_key)),
+        high_key_(std::move(high_key)),
+        low_inclusive_(low_inclusive),
+        high_inclusive_(high_inclusive),
+        descending_(descending),
+        limit_(limit),
+        index_only_(index_only) {}
 
   PlanType GetType() const override { return PlanType::IndexScan; }
 
@@ -40,11 +74,77 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return the lower bound of the scanned keys, empty if unbounded */
+  const std::vector<Value> &GetLowKey() const { return low_key_; }
+
+  /** @return the upper bound of the scanned keys, empty if unbounded */
+  const std::vector<Value> &GetHighKey() const { return high_key_; }
+
+  /** @return true if the lower bound is part of the range */
+  bool IsLowInclusive() const { return low_inclusive_; }
+
+  /** @return true if the upper bound is part of the range */
+  bool IsHighInclusive() const { return high_inclusive_; }
+
+  /** @return true if the range is scanned from the largest key down */
+  bool IsDescending() const { return descending_; }
+
+  /** @return the number of index entries to scan at most */
+  size_t GetLimit() const { return limit_; }
+
+  /** @return true if the scan only reads the entries of one key, e.g. for WHERE id = 42 */
+  bool IsPointLookup() const {
+    if (low_key_.empty() || low_key_.size() != high_key_.size() || !low_inclusive_ || !high_inclusive_) {
+      return false;
+    }
+    for (size_t i = 0; i < low_key_.size(); i++) {
+      if (low_key_[i].CompareEquals(high_key_[i]) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** @return true if the scan may skip the table when the index stores every column it reads */
+  bool IsIndexOnly() const { return index_only_; }
+
+  /** @return the table columns the output schema and the predicate read */
+  std::vector<uint32_t> GetReferencedColumns() const {
+    std::vector<uint32_t> columns;
+    std::vector<const AbstractExpression *> exprs;
+    for (const auto &column : OutputSchema()->GetColumns()) {
+      exprs.push_back(column.GetExpr());
+    }
+    exprs.push_back(predicate_);
+    while (!exprs.empty()) {
+      const AbstractExpression *expr = exprs.back();
+      exprs.pop_back();
+      if (expr == nullptr) {
+        continue;
+      }
+      if (const auto *column_value = dynamic_cast<const ColumnValueExpression *>(expr)) {
+        columns.push_back(column_value->GetColIdx());
+      }
+      exprs.insert(exprs.end(), expr->GetChildren().begin(), expr->GetChildren().end());
+    }
+    return columns;
+  }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** The range of index keys to scan. */
+  std::vector<Value> low_key_;
+  std::vector<Value> high_key_;
+  bool low_inclusive_;
+  bool high_inclusive_;
+  /** The scan order, and the number of index entries to stop after. */
+  bool descending_;
+  size_t limit_;
+  /** Whether the tuples may come from the index entries alone. */
+  bool index_only_;
 };
 
 }  // namespace bustub
@@ -15,6 +15,7 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
 
 #include "common/config.h"
@@ -91,6 +92,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of disk reads */
+  int GetNumReads() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -107,10 +111,13 @@ class DiskManager {
   std::string log_name_;
   // stream to write db file
   std::fstream db_io_;
+  // the buffer pool prefetch thread reads pages without the pool latch, so the db file has its own
+  std::mutex db_io_latch_;
   std::string file_name_;
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
   int num_writes_;
+  std::atomic<int> num_reads_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
 };
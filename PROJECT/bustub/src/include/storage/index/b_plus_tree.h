@@ -10,8 +10,11 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "concurrency/transaction.h"
@@ -23,15 +26,70 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * Size and key distribution of a B+ tree, exact or estimated from a sample of
+ * its leaves (see BPlusTree::GetStatistics).
+ */
+template <typename KeyType>
+struct BPlusTreeStatistics {
+  double num_entries_{0};
+  double num_leaves_{0};
+  int height_{0};
+  double avg_leaf_fill_{0};
+  double distinct_keys_{0};
+  // equi-depth histogram: the smallest key then the last key of each bucket,
+  // and the number of entries up to the end of each bucket
+  std::vector<KeyType> bucket_bounds_;
+  std::vector<double> bucket_depths_;
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the tree is built with unique_keys = false
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * With prefix compression (only for keys compared byte by byte), pages store
+ * variable-length keys without their trailing zero bytes, every page keeps
+ * the fences its parent gives it and stores the prefix shared by the fences
+ * once (see BPlusTreePage), and leaf splits push up the shortest key
+ * separating the two halves instead of the first key of the new leaf. Pages
+ * then hold as many entries as fit, at most leaf_max_size / internal_max_size,
+ * so the fanout follows the actual key lengths.
+ *
+ * Without unique keys, equal keys are stored side by side and may span
+ * several leaves, so point queries start from the leftmost leaf that may
+ * hold the key and follow the leaf chain. Entries are then removed by key and
+ * value. Compressed pages store the bytes of equal keys once.
+ *
+ * Leaves are linked both ways, so range scans and iterators also run from the
+ * largest key down, e.g. for ORDER BY ... DESC LIMIT n.
+ *
+ * With pinned_levels > 0, the internal pages of that many levels from the root
+ * stay pinned in the buffer pool, and lookups read them without fetching and
+ * unpinning them. The buffer pool must have frames to spare for them.
+ *
+ * The header page holds a record <index_name, root_page_id> of the tree,
+ * written whenever the root changes. With defer_root_write, the root page id
+ * is only kept in memory and the record is written by FlushRootPageId(), so
+ * that root splits and merges do not fetch and dirty the header page; the
+ * owner must then call it before the buffer pool is flushed or shut down
+ * (BPlusTreeIndex does when it is destroyed), or the record is left stale.
+ *
+ * With lazy_merge, deletes only rebalance a page once it is nearly empty
+ * (filled below 1 / LAZY_MERGE_FRACTION) instead of below half full, so that
+ * delete-then-insert churn does not merge and split the same pages over and
+ * over. Compact() rebalances the sparse leaves left behind, and may run in a
+ * background thread.
+ *
+ * Range scans ask the buffer pool to prefetch the next SetPrefetchLeaves()
+ * leaves (INDEX_SCAN_PREFETCH_LEAVES by default) while they read one, so that
+ * long scans of a cold index do not wait on every leaf. Iterators, which run
+ * without the tree latch, prefetch the next leaf only.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +98,11 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool prefix_compression = false, bool unique_keys = true, int pinned_levels = 0,
+                     bool lazy_merge = false, bool defer_root_write = false);
+
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -48,17 +110,57 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  // Build this B+ tree from entries sorted by key.
+  void BulkLoad(const std::vector<MappingType> &entries, Transaction *transaction = nullptr);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove the entry with this key and this value, one of the duplicates of key.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove the entries with keys between low_key and high_key, a nullptr bound is unbounded, returns how many.
+  size_t RemoveRange(const KeyType *low_key, const KeyType *high_key, bool low_inclusive, bool high_inclusive,
+                     Transaction *transaction = nullptr);
+
+  // Merge or refill the leaves below half full, returns the number of leaves rebalanced.
+  int Compact(Transaction *transaction = nullptr);
+
+  // Run Compact() every index_compaction_interval in a background thread, until stopped or destroyed.
+  void StartBackgroundCompaction();
+  void StopBackgroundCompaction();
+
+  // Write the root page id to the header page if it changed, returns false if the header page could not be fetched.
+  bool FlushRootPageId();
+
+  // Number of leaves scans read ahead, 0 to read leaves only once they get to them.
+  void SetPrefetchLeaves(int prefetch_leaves) { this->prefetch_leaves_ = prefetch_leaves; }
+
+  // return the values associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // return the values associated with each of the keys, in the order of the keys
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
+  // return the values of at most limit keys between low_key and high_key, a nullptr bound is unbounded,
+  // and their keys too if keys is not nullptr
+  void GetRange(const KeyType *low_key, const KeyType *high_key, bool low_inclusive, bool high_inclusive,
+                bool descending, size_t limit, std::vector<ValueType> *result, Transaction *transaction = nullptr,
+                std::vector<KeyType> *keys = nullptr);
+
+  // Size and key distribution, from every leaf or from sample_leaves random descents, with num_buckets buckets.
+  void GetStatistics(size_t sample_leaves, size_t num_buckets, BPlusTreeStatistics<KeyType> *stats);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // reverse index iterator, from the largest key (or the last key <= key) down, ends at end()
+  INDEXITERATOR_TYPE rbegin();
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -82,6 +184,14 @@ class BPlusTree {
  private:
   void StartNewTree(const KeyType &key, const ValueType &value);
 
+  Page *FindFirstLeafPage(const KeyType &key);
+
+  Page *FindLastLeafPage();
+
+  bool CollectDuplicates(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result);
+
+  void RelinkPrevPage(page_id_t page_id, page_id_t prev_page_id);
+
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
@@ -90,6 +200,31 @@ class BPlusTree {
   template <typename N>
   N *Split(N *node);
 
+  void FinishRemove(LeafPage *leaf_page, bool removed, Transaction *transaction = nullptr);
+
+  size_t RemoveRangeFrom(page_id_t page_id, const KeyType *low_key, const KeyType *high_key, bool low_inclusive,
+                         bool high_inclusive, page_id_t *low_leaf_page_id, page_id_t *high_leaf_page_id);
+
+  size_t DeleteSubtree(page_id_t page_id);
+
+  void RepairRangePath(const KeyType *key, bool first, bool last, Transaction *transaction = nullptr);
+
+  std::vector<page_id_t> FindRangePath(const KeyType *key, bool first, bool last);
+
+  template <typename N>
+  bool RepairRangePage(N *node, Transaction *transaction = nullptr);
+
+  void RangeInLeaf(LeafPage *leaf_page, const KeyType *low_key, const KeyType *high_key, bool low_inclusive,
+                   bool high_inclusive, int *begin, int *end);
+
+  size_t RemoveRangeByLeaf(const KeyType *low_key, const KeyType *high_key, bool low_inclusive, bool high_inclusive,
+                           Transaction *transaction = nullptr);
+
+  bool RebalanceRangeLeaf(page_id_t leaf_page_id, bool until_filled, Transaction *transaction = nullptr);
+
+  template <typename N>
+  bool NeedsRebalance(N *node) const;
+
   template <typename N>
   bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
 
@@ -102,7 +237,23 @@ class BPlusTree {
 
   bool AdjustRoot(BPlusTreePage *node);
 
-  void UpdateRootPageId(int insert_record = 0);
+  KeyType ShortestSeparator(const KeyType &left, const KeyType &right) const;
+
+  void UpdateRootPageId();
+
+  bool WriteRootPageId();
+
+  void PinTopLevels();
+
+  void ReleasePinnedPages();
+
+  Page *FetchTreePage(page_id_t page_id);
+
+  void UnpinTreePage(Page *page);
+
+  void DeleteTreePage(page_id_t page_id);
+
+  void RunBackgroundCompaction();
 
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
@@ -116,6 +267,23 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool prefix_compression_;
+  bool unique_keys_;
+  int pinned_levels_;
+  // internal pages of the top pinned_levels_ levels, pinned for as long as they are there
+  std::unordered_map<page_id_t, Page *> pinned_pages_;
+  // whether the header page has a record of this tree, and whether the root changed since it was written
+  bool root_record_inserted_;
+  bool root_page_id_dirty_;
+  bool defer_root_write_;
+  // the fraction of a leaf BulkLoad fills, the rest is left for later inserts
+  static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;
+  // only rebalance nearly empty pages on deletes, and the thread running Compact() meanwhile
+  static constexpr int LAZY_MERGE_FRACTION = 8;
+  bool lazy_merge_;
+  std::atomic<bool> enable_compaction_;
+  std::thread *compaction_thread_;
+  int prefetch_leaves_;
 
   ReaderWriterLatch rwlatch_;
 };
@@ -17,6 +17,7 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -27,23 +28,51 @@ class BPlusTreeIndex : public Index {
  public:
   BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
 
+  ~BPlusTreeIndex() override;
+
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                Transaction *transaction) override;
+
+  void ScanRange(const Tuple *low_key, const Tuple *high_key, bool low_inclusive, bool high_inclusive,
+                 bool descending, size_t limit, std::vector<RID> *result, Transaction *transaction) override;
+
+  bool SupportsIndexOnlyScan() const override { return index_only_scan_; }
+
+  void ScanRangeEntries(const Tuple *low_key, const Tuple *high_key, bool low_inclusive, bool high_inclusive,
+                        bool descending, size_t limit, std::vector<Tuple> *entries, std::vector<RID> *result,
+                        Transaction *transaction) override;
+
+  bool ComputeStatistics(size_t sample_leaves, size_t num_buckets, IndexStatistics *stats,
+                         Transaction *transaction) override;
+
+  // fill the index with the tuples of table_heap, using num_threads threads, throws if a unique index would get
+  // equal keys or the buffer pool has no frame for a table page, the index is then left empty
+  void BuildFromTable(TableHeap *table_heap, const Schema &schema, size_t num_threads, Transaction *transaction);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  INDEXITERATOR_TYPE GetReverseBeginIterator(const KeyType &key);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  BufferPoolManager *buffer_pool_manager_;
+  // whether the keys hold whole entries, key and INCLUDE columns, that scans can decode
+  bool index_only_scan_;
 };
 
 }  // namespace bustub
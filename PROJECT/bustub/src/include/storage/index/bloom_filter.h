@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+/**
+ * A Bloom filter over the hashes of index keys: a key never inserted is
+ * reported as absent with a probability of about 99% at capacity, a key
+ * inserted is never reported as absent. Keys cannot be removed, the filter is
+ * rebuilt instead.
+ *
+ * The bits of a key are all in one block of 512 bits, a cache line, picked by
+ * the high half of its hash, so a lookup misses the cache once. Inserts and
+ * lookups may run concurrently.
+ */
+class BloomFilter {
+ public:
+  /**
+   * Creates an empty filter sized for capacity keys, BLOOM_FILTER_BITS_PER_KEY bits each.
+   */
+  explicit BloomFilter(size_t capacity);
+
+  /** Adds the hash of a key. */
+  void Insert(hash_t hash);
+
+  /** @return false if no key with this hash was inserted, true if one may have been */
+  bool MayContain(hash_t hash) const;
+
+  /** @return the number of keys the filter was sized for */
+  size_t GetCapacity() const { return this->capacity_; }
+
+  /** @return the number of keys inserted, counting repeated keys every time */
+  size_t GetNumKeys() const { return this->num_keys_; }
+
+  /** @return the number of bytes SerializeTo writes */
+  uint32_t GetSerializedSize() const;
+
+  /** Writes the filter to storage, GetSerializedSize() bytes. */
+  void SerializeTo(char *storage) const;
+
+  /** @return the filter SerializeTo wrote to storage */
+  static std::unique_ptr<BloomFilter> DeserializeFrom(const char *storage);
+
+ private:
+  static constexpr size_t WORDS_PER_BLOCK = 8;
+  static constexpr size_t BITS_PER_BLOCK = WORDS_PER_BLOCK * 64;
+
+  /** Finds the BLOOM_FILTER_NUM_PROBES bits of a hash, as indexes into words_ and masks. */
+  void Probe(hash_t hash, size_t *words, uint64_t *masks) const;
+
+  size_t capacity_;
+  std::atomic<size_t> num_keys_{0};
+  size_t num_blocks_;
+  std::vector<std::atomic<uint64_t>> words_;
+};
+
+}  // namespace bustub
@@ -35,6 +35,9 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // the tuple layout is kept as is, so the key schema is only needed when comparing
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
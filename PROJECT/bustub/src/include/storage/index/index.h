@@ -18,6 +18,9 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/index/index_bloom_filter.h"
+#include "storage/index/index_statistics.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -32,17 +35,54 @@ namespace bustub {
  * mapping relation and does the conversion between tuple key and index key
  */
 class Transaction;
+/**
+ * The structures an index can be built on. A B+ tree keeps the keys in order for range scans, a hash table only finds
+ * the entries of one key, reading fewer pages.
+ */
+enum class IndexType { BPlusTree, Hash };
+
+/**
+ * How the structure of an index stores its entries. The options change how many pages an index takes and how it is
+ * searched, not what it returns, and only B+ tree indexes read them.
+ */
+struct IndexOptions {
+  // slotted pages with fence-key prefix compression and suffix truncation instead of fixed-size slots, only for
+  // normalized (byte-compared) keys, see BPlusTree
+  bool prefix_compression_{false};
+  // levels of internal pages from the root kept pinned in the buffer pool, which needs frames to spare for them
+  int pinned_levels_{0};
+  // deletes only rebalance nearly empty pages, the sparse leaves are left to compaction, see BPlusTree
+  bool lazy_merge_{false};
+  // compact the leaves every index_compaction_interval in a background thread while the index lives
+  bool background_compaction_{false};
+  // keep the root page id in memory and only write it to the header page when the index is destroyed, see BPlusTree
+  bool defer_root_write_{false};
+};
+
 class IndexMetadata {
  public:
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, std::vector<uint32_t> include_attrs = {},
+                IndexOptions options = {}, IndexType index_type = IndexType::BPlusTree)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)),
+        is_unique_(is_unique),
+        options_(options),
+        index_type_(index_type) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs_);
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  }
 
   inline const std::string &GetName() const { return name_; }
 
@@ -60,13 +100,35 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns the non-key columns of the base table the index stores with each
+  // key (INCLUDE), so that scans reading only those can skip the table
+  inline const std::vector<uint32_t> &GetIncludeAttrs() const { return include_attrs_; }
+
+  // Returns the schema of an index entry, the key columns followed by the
+  // INCLUDE columns, and its mapping to base table columns. Entries are
+  // inserted and deleted as tuples of this schema.
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
+  inline const std::vector<uint32_t> &GetEntryAttrs() const { return entry_attrs_; }
+
+  // Whether a key maps to at most one tuple, secondary indexes on e.g. join
+  // columns hold duplicate keys
+  inline bool IsUnique() const { return is_unique_; }
+
+  // Returns how the index stores its entries
+  inline const IndexOptions &GetOptions() const { return options_; }
+
+  // Returns the structure the index is built on
+  inline IndexType GetIndexType() const { return index_type_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
 
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
-       << "Type = B+Tree, "
+       << "Type = " << (index_type_ == IndexType::Hash ? "Hash" : "B+Tree") << ", "
+       << "Unique = " << is_unique_ << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
 
@@ -80,6 +142,13 @@ class IndexMetadata {
   const std::vector<uint32_t> key_attrs_;
   // schema of the indexed key
   Schema *key_schema_;
+  // The non-key columns stored with the key, and the schema of key and INCLUDE columns together
+  const std::vector<uint32_t> include_attrs_;
+  std::vector<uint32_t> entry_attrs_;
+  Schema *entry_schema_;
+  bool is_unique_;
+  IndexOptions options_;
+  IndexType index_type_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -102,7 +171,7 @@ class IndexMetadata {
  */
 class Index {
  public:
-  explicit Index(IndexMetadata *metadata) : metadata_(metadata) {}
+  explicit Index(IndexMetadata *metadata) : metadata_(metadata), bloom_filter_(metadata->GetIndexColumnCount()) {}
 
   virtual ~Index() { delete metadata_; }
 
@@ -117,6 +186,10 @@ class Index {
 
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
+  const std::vector<uint32_t> &GetEntryAttrs() const { return metadata_->GetEntryAttrs(); }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -129,7 +202,8 @@ class Index {
   ///////////////////////////////////////////////////////////////////
   // Point Modification
   ///////////////////////////////////////////////////////////////////
-  // designed for secondary indexes.
+  // designed for secondary indexes. The key is a tuple of the entry schema,
+  // it carries the INCLUDE columns after the key columns.
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
   // delete the index entry linked to given tuple
@@ -137,11 +211,100 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  // scan a batch of keys, result[i] gets the RIDs of keys[i]. Indexes that can
+  // share work between the keys of a batch override this.
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                        Transaction *transaction) {
+    result->assign(keys.size(), std::vector<RID>());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*result)[i], transaction);
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Range Scan
+  ///////////////////////////////////////////////////////////////////
+  // append the RIDs of at most limit keys between low_key and high_key, in
+  // key order or in reverse key order when descending, a nullptr bound is
+  // unbounded
+  virtual void ScanRange(const Tuple *low_key, const Tuple *high_key, bool low_inclusive, bool high_inclusive,
+                         bool descending, size_t limit, std::vector<RID> *result, Transaction *transaction) = 0;
+
+  // whether ScanRange is supported, else only the entries of one key can be
+  // looked up, with ScanKey
+  virtual bool SupportsRangeScan() const { return true; }
+
+  ///////////////////////////////////////////////////////////////////
+  // Index-only Scan
+  ///////////////////////////////////////////////////////////////////
+  // whether ScanRangeEntries can return the stored key and INCLUDE columns
+  virtual bool SupportsIndexOnlyScan() const { return false; }
+
+  // like ScanRange, and also append the index entries of the RIDs, as tuples
+  // of the entry schema, so callers reading only those columns need not fetch
+  // the tuples from the table
+  virtual void ScanRangeEntries(const Tuple *low_key, const Tuple *high_key, bool low_inclusive, bool high_inclusive,
+                                bool descending, size_t limit, std::vector<Tuple> *entries, std::vector<RID> *result,
+                                Transaction *transaction) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Index does not support index-only scans.");
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Statistics
+  ///////////////////////////////////////////////////////////////////
+  // fill stats with the size and key distribution of the index, from all of
+  // it when sample_leaves is 0, else estimated from that many leaves. Returns
+  // false when the index keeps no statistics.
+  virtual bool ComputeStatistics(size_t sample_leaves, size_t num_buckets, IndexStatistics *stats,
+                                 Transaction *transaction) {
+    return false;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Bloom Filter
+  ///////////////////////////////////////////////////////////////////
+  // an index may keep a Bloom filter of its keys, ScanKey then answers most
+  // keys that are not in the index without reading a page. Keys are added as
+  // they are inserted but never removed, so the filter is rebuilt from the
+  // table once BloomFilterNeedsRebuild: start a build sized for the keys of
+  // the table, add every key the table holds, and finish it. Keys inserted
+  // while the build runs go into it too.
+  void BeginBloomFilterBuild(size_t expected_keys) { bloom_filter_.BeginBuild(expected_keys); }
+
+  // add a key, a tuple of the key schema, to the filter being built
+  void AddToBloomFilterBuild(const Tuple &key) { bloom_filter_.AddToBuild(key, GetKeySchema()); }
+
+  // start looking up keys in the filter being built
+  void FinishBloomFilterBuild() { bloom_filter_.FinishBuild(); }
+
+  // look up keys in filter, e.g. one read back with BloomFilter::DeserializeFrom, which must hold every key of the
+  // index, or stop using a filter when it is nullptr
+  void SetBloomFilter(std::shared_ptr<BloomFilter> filter) { bloom_filter_.Set(std::move(filter)); }
+
+  std::shared_ptr<BloomFilter> GetBloomFilter() const { return bloom_filter_.Get(); }
+
+  // the keys a rebuilt filter is expected to hold, see IndexBloomFilter::GetNumLiveKeys
+  size_t BloomFilterNumLiveKeys() const { return bloom_filter_.GetNumLiveKeys(); }
+
+  // whether the filter is worth rebuilding, see IndexBloomFilter::NeedsRebuild
+  bool BloomFilterNeedsRebuild() const { return bloom_filter_.NeedsRebuild(); }
+
+ protected:
+  // false if the index surely holds no entry of key, a tuple of the key schema
+  bool MayContainKey(const Tuple &key) const { return bloom_filter_.MayContain(key, GetKeySchema()); }
+
+  // add the key of an entry, a tuple of the entry schema, to the filters, before it is inserted
+  void AddEntryToBloomFilter(const Tuple &entry) { bloom_filter_.Add(entry, GetEntrySchema()); }
+
+  // count an entry deleted, its key stays in the filter
+  void NoteBloomFilterDelete() { bloom_filter_.NoteDelete(); }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
   //===--------------------------------------------------------------------===//
   IndexMetadata *metadata_;
+  IndexBloomFilter bloom_filter_;
 };
 
 }  // namespace bustub
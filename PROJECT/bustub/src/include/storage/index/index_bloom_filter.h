@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_bloom_filter.h
+//
+// Identification: src/include/storage/index/index_bloom_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "catalog/schema.h"
+#include "storage/index/bloom_filter.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * The Bloom filter of the keys of an index: the filter looked up, the one
+ * being built to replace it, and the number of entries deleted since the
+ * filter looked up was built. Keys are hashed from the key columns, which come
+ * first in both a key and an entry of the index, so either can be added or
+ * looked up with its schema.
+ *
+ * Keys inserted while a build runs go into both filters. The filters are
+ * swapped atomically, so lookups and inserts may run concurrently with a
+ * build.
+ */
+class IndexBloomFilter {
+ public:
+  /**
+   * Creates one with no filter, every key may be in the index.
+   * @param num_key_columns the number of key columns of the index
+   */
+  explicit IndexBloomFilter(uint32_t num_key_columns) : num_key_columns_(num_key_columns) {}
+
+  /** Starts building a filter sized for expected_keys keys. */
+  void BeginBuild(size_t expected_keys);
+
+  /** Adds a key, a tuple of schema, to the filter being built. */
+  void AddToBuild(const Tuple &key, const Schema *schema);
+
+  /** Looks up keys in the filter being built from now on. */
+  void FinishBuild();
+
+  /** Looks up keys in filter, which must hold every key of the index, or in no filter when it is nullptr. */
+  void Set(std::shared_ptr<BloomFilter> filter);
+
+  /** @return the filter looked up, nullptr if there is none */
+  std::shared_ptr<BloomFilter> Get() const { return std::atomic_load(&this->filter_); }
+
+  /**
+   * @return true if half the keys of the filter were deleted since it was built, or it holds more keys than it was
+   * sized for, and so reports too many keys that are not in the index
+   */
+  bool NeedsRebuild() const;
+
+  /** @return false if the index surely holds no entry of key, a tuple of schema */
+  bool MayContain(const Tuple &key, const Schema *schema) const;
+
+  /** Adds the key of an entry, a tuple of schema, to the filters, before the entry is inserted. */
+  void Add(const Tuple &entry, const Schema *schema);
+
+  /** @return the keys of the filter looked up less the entries deleted since it was built, 0 if there is none */
+  size_t GetNumLiveKeys() const;
+
+  /** Counts an entry deleted, its key stays in the filter. */
+  void NoteDelete() { this->num_deletes_++; }
+
+ private:
+  /** @return the hash of the key columns of tuple */
+  hash_t Hash(const Tuple &tuple, const Schema *schema) const;
+
+  uint32_t num_key_columns_;
+  // the filter looked up, and the one being built, nullptr when there is none
+  std::shared_ptr<BloomFilter> filter_;
+  std::shared_ptr<BloomFilter> building_;
+  std::atomic<size_t> num_deletes_{0};
+};
+
+}  // namespace bustub
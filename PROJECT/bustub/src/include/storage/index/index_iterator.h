@@ -13,6 +13,7 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -25,7 +26,11 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   IndexIterator();
 
-  IndexIterator(Page *left_most_page, int k, BufferPoolManager *buffer_pool_manager);
+  // a reverse iterator walks from entry k towards the smallest key, through the previous leaf links. Unless
+  // prefetch_leaves is 0, it asks the buffer pool to prefetch the next leaf in its direction halfway through each
+  // leaf: it holds no tree latch to read the parent listing the leaves further on.
+  IndexIterator(Page *left_most_page, int k, BufferPoolManager *buffer_pool_manager, bool reverse = false,
+                int prefetch_leaves = 0);
 
   ~IndexIterator();
 
@@ -41,11 +46,23 @@ class IndexIterator {
     return !(this->curr_page_ == itr.curr_page_ && this->k_ == itr.k_);
   }
 
+  // prefetch up to count leaves after leaf (before it when reverse): its sibling, then the ones after that sibling
+  // in their parent, which only a caller holding the tree latch may read
+  static void PrefetchLeaves(const B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, bool reverse, int count,
+                             BufferPoolManager *buffer_pool_manager);
+
  private:
+  void PrefetchAtMiddle();
+
   Page *curr_page_;
   int k_;
   BufferPoolManager *buffer_pool_manager_;
-  // add your own private member variables here
+  bool reverse_;
+  // copy of the current entry, slots of prefix compressed leaves can't be referenced
+  MappingType item_;
+  int prefetch_leaves_{0};
+  // the last leaf the following leaves were prefetched from
+  page_id_t prefetched_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
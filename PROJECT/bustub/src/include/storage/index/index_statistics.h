@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_statistics.h
+//
+// Identification: src/include/storage/index/index_statistics.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Size and key distribution of an index, for estimating how many entries a
+ * scan reads, e.g. to choose between a sequential scan and an index scan.
+ * Computed from every leaf they are exact, from a sample of leaves they are
+ * estimates. They are not kept up to date by inserts and deletes, but
+ * recomputed by Catalog::AnalyzeIndex.
+ */
+struct IndexStatistics {
+  size_t num_entries_{0};
+  size_t num_leaves_{0};
+  uint32_t height_{0};
+  // the average fraction of a leaf in use
+  double avg_leaf_fill_{0};
+  size_t distinct_keys_{0};
+  // equi-depth histogram over the first key column: histogram_bounds_[0] is the
+  // smallest value, bucket i holds the values after histogram_bounds_[i] up to
+  // histogram_bounds_[i + 1], and histogram_depths_[i] entries in all are in
+  // buckets 0 to i. Empty when the keys cannot be decoded.
+  std::vector<Value> histogram_bounds_;
+  std::vector<double> histogram_depths_;
+
+  // the fraction of the entries that have one given key
+  double EstimateEqualSelectivity() const;
+
+  // the fraction of the entries whose first key column lies between low and
+  // high, a nullptr bound is unbounded. Bounds are taken as inclusive.
+  double EstimateRangeSelectivity(const Value *low, const Value *high) const;
+
+ private:
+  // the estimated number of entries whose first key column is below value
+  double EstimateEntriesBelow(const Value &value) const;
+};
+
+}  // namespace bustub
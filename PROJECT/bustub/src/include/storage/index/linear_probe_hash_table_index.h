@@ -19,6 +19,7 @@
 #include "container/hash/hash_function.h"
 #include "container/hash/linear_probe_hash_table.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -38,6 +39,14 @@ class LinearProbeHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanRange(const Tuple *low_key, const Tuple *high_key, bool low_inclusive, bool high_inclusive,
+                 bool descending, size_t limit, std::vector<RID> *result, Transaction *transaction) override;
+
+  bool SupportsRangeScan() const override { return false; }
+
+  // fill the index with the tuples of table_heap, the pages of the index are freed if it throws and it cannot be used
+  void BuildFromTable(TableHeap *table_heap, const Schema &schema, Transaction *transaction);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -0,0 +1,191 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Normalized key is an order-preserving binary encoding of an index key.
+ *
+ * Unlike GenericKey, which keeps the serialized tuple and needs the key
+ * schema to compare, every column is encoded so that comparing two keys
+ * with memcmp yields the same order as comparing the column values:
+ *  - integers are stored big-endian with the sign bit flipped
+ *  - decimals are stored as their IEEE bits, with all bits flipped for
+ *    negative numbers and only the sign bit flipped otherwise
+ *  - timestamps are stored big-endian
+ *  - varchars get a null marker byte, then the bytes with 0x00 escaped as
+ *    0x00 0xFF, then a 0x00 0x00 terminator
+ *
+ * Fixed length types have no marker byte, a NULL is encoded as the NULL
+ * sentinel of its type. The sentinels of the integer and boolean types and of
+ * decimals are below every other value, so these NULLs sort first, but the
+ * timestamp sentinel is the largest timestamp, so NULL timestamps sort last.
+ * Varchar NULLs sort first by their marker byte. Keys are stored in
+ * KeySize bytes, zero padded: varchar keys are variable-length only up to
+ * that bound, e.g. a single varchar of at most KeySize - 3 bytes without
+ * '\0'. SetFromKey throws OUT_OF_RANGE for a key whose encoding is longer,
+ * instead of cutting it, so that keys differing past the bound never compare
+ * equal.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
+    // intialize to 0
+    memset(data_, 0, KeySize);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      offset = EncodeValue(tuple.GetValue(key_schema, i), offset);
+    }
+    if (offset > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE,
+                      "Key takes " + std::to_string(offset) + " bytes, more than its " + std::to_string(KeySize));
+    }
+  }
+
+  // NOTE: for test purpose only
+  // encode the key as a single bigint column
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    EncodeUnsigned(static_cast<uint64_t>(key) ^ SIGN_BIT_64, sizeof(int64_t), 0);
+  }
+
+  // NOTE: for test purpose only
+  // decode the first 8 bytes as a bigint column
+  inline int64_t ToString() const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(int64_t) && i < KeySize; i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data_[i]);
+    }
+    return static_cast<int64_t>(bits ^ SIGN_BIT_64);
+  }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  // actual location of data, extends past the end.
+  char data_[KeySize];
+
+ private:
+  static constexpr uint64_t SIGN_BIT_64 = 1ULL << 63;
+
+  /**
+   * Appends the order-preserving encoding of one column at offset, the bytes past KeySize are not written.
+   * @return offset right after the encoded column, past KeySize if it did not fit, for SetFromKey to reject the key
+   */
+  inline size_t EncodeValue(const Value &val, size_t offset) {
+    switch (val.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return EncodeUnsigned(static_cast<uint8_t>(val.GetAs<int8_t>()) ^ 0x80U, sizeof(int8_t), offset);
+      case TypeId::SMALLINT:
+        return EncodeUnsigned(static_cast<uint16_t>(val.GetAs<int16_t>()) ^ 0x8000U, sizeof(int16_t), offset);
+      case TypeId::INTEGER:
+        return EncodeUnsigned(static_cast<uint32_t>(val.GetAs<int32_t>()) ^ 0x80000000U, sizeof(int32_t), offset);
+      case TypeId::BIGINT:
+        return EncodeUnsigned(static_cast<uint64_t>(val.GetAs<int64_t>()) ^ SIGN_BIT_64, sizeof(int64_t), offset);
+      case TypeId::TIMESTAMP:
+        return EncodeUnsigned(val.GetAs<uint64_t>(), sizeof(uint64_t), offset);
+      case TypeId::DECIMAL: {
+        double d = val.GetAs<double>();
+        // -0.0 and 0.0 are equal, so they must encode the same way
+        if (d == 0) {
+          d = 0;
+        }
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(double));
+        bits = (bits & SIGN_BIT_64) != 0 ? ~bits : bits ^ SIGN_BIT_64;
+        return EncodeUnsigned(bits, sizeof(double), offset);
+      }
+      case TypeId::VARCHAR: {
+        if (val.IsNull()) {
+          return EncodeByte(0x00, offset);
+        }
+        offset = EncodeByte(0x01, offset);
+        const char *str = val.GetData();
+        uint32_t len = val.GetLength();
+        // the trailing '\0' of the stored string is replaced by the terminator
+        if (len > 0 && str[len - 1] == '\0') {
+          len--;
+        }
+        for (uint32_t i = 0; i < len; i++) {
+          offset = EncodeByte(str[i], offset);
+          if (str[i] == '\0') {
+            offset = EncodeByte(static_cast<char>(0xFF), offset);
+          }
+        }
+        offset = EncodeByte(0x00, offset);
+        return EncodeByte(0x00, offset);
+      }
+      default:
+        break;
+    }
+    throw Exception(ExceptionType::MISMATCH_TYPE, "Cannot normalize key of this type.");
+  }
+
+  inline size_t EncodeUnsigned(uint64_t bits, size_t width, size_t offset) {
+    for (size_t i = 0; i < width; i++) {
+      offset = EncodeByte(static_cast<char>((bits >> (8 * (width - i - 1))) & 0xFF), offset);
+    }
+    return offset;
+  }
+
+  inline size_t EncodeByte(char byte, size_t offset) {
+    if (offset < KeySize) {
+      data_[offset] = byte;
+    }
+    return offset + 1;
+  }
+};
+
+/**
+ * Function object returns < 0 if lhs < rhs, > 0 if lhs > rhs and 0 if equal.
+ * Normalized keys are compared byte by byte, no values are materialized.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+
+  NormalizedComparator(const NormalizedComparator &other) = default;
+
+  // constructor, the key schema is already folded into the encoding
+  explicit NormalizedComparator(Schema *key_schema) {}
+};
+
+/**
+ * Tells whether a comparator orders keys by their raw bytes, like memcmp with
+ * missing trailing bytes read as zeros. B+ tree pages may then strip the key
+ * prefix shared by a page and truncate separators.
+ */
+template <typename KeyComparator>
+struct IsBytewiseComparator : std::false_type {};
+
+template <size_t KeySize>
+struct IsBytewiseComparator<NormalizedComparator<KeySize>> : std::true_type {};
+
+}  // namespace bustub
@@ -17,12 +17,15 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 32
+// one slot is kept free for the entry that overflows the page before a split
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)) - 1)
+#define INTERNAL_SLOT_SIZE (KEY_SLOT_HEADER_SIZE + sizeof(ValueType))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
- * K(i) <= K < K(i+1).
+ * K(i) <= K < K(i+1), or K(i) <= K <= K(i+1) when duplicate keys span
+ * several children.
  * NOTE: since the number of keys does not equal to number of child pointers,
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
@@ -31,26 +34,45 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * With variable-length keys (see BPlusTreePage), the array holds slots of
+ * INTERNAL_SLOT_SIZE bytes instead, | KeyOffset (2) | KeyLength (2) | PAGE_ID |,
+ * and the key bytes are packed at the end of the page like in leaf pages.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool variable_length_keys = false);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
+  bool IsOverfull() const;
+  bool IsUnderfull(int fraction = 2) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  ValueType LookupFirst(const KeyType &key, const KeyComparator &comparator) const;
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator, bool first = false) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   void Remove(int index);
+  void RemoveRange(int begin, int end);
   ValueType RemoveAndReturnOnlyChild();
 
+  // key prefix compression of variable-length keys, a nullptr fence is unbounded
+  void SetFences(const KeyType *low_fence, const KeyType *high_fence);
+  KeyType GetLowFence() const;
+  bool GetHighFence(KeyType *high_fence) const;
+  int GetEntrySpace(const KeyType &key, const KeyType *low_fence, const KeyType *high_fence) const;
+  int GetSpaceWithFences(const KeyType *low_fence, const KeyType *high_fence) const;
+  bool FitsWithFences(const KeyType *low_fence, const KeyType *high_fence, int size, int space) const;
+
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
+  int GetSplitIndex() const;
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                         BufferPoolManager *buffer_pool_manager);
@@ -61,6 +83,11 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  char *SlotAt(int index);
+  const char *SlotAt(int index) const;
+  void InsertAt(int index, const MappingType &item);
+  void RemoveAt(int index);
+  void Truncate(int size);
   MappingType array[0];
 };
 }  // namespace bustub
@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_key_search.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_KEY_SEARCH_TYPE BPlusTreeKeySearch<KeyType, ValueType, KeyComparator>
+
+/**
+ * In-node search over the sorted (key, value) array of a B+ tree page.
+ *
+ * The generic version is a binary search that calls the comparator once per
+ * probe. Key types that can be searched faster specialize this class on the
+ * comparator, so pages pick their search routine at compile time.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class BPlusTreeKeySearch {
+ public:
+  /**
+   * @return the first index in [begin, end) whose key is >= key, end if there is none
+   */
+  static int LowerBound(const std::pair<KeyType, ValueType> *array, int begin, int end, const KeyType &key,
+                        const KeyComparator &comparator) {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (comparator(array[mid].first, key) < 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  /**
+   * @return the first index in [begin, end) whose key is > key, end if there is none
+   */
+  static int UpperBound(const std::pair<KeyType, ValueType> *array, int begin, int end, const KeyType &key,
+                        const KeyComparator &comparator) {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (comparator(array[mid].first, key) <= 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+};
+
+/**
+ * A single bigint column normalized into 8 bytes is a big-endian unsigned
+ * integer, so the page is searched as an array of uint64 without calling the
+ * comparator: a binary search narrows the range down to a few cache lines,
+ * then a SIMD scan counts the keys below the probe, four at a time with AVX2
+ * or two at a time with SSE4.2.
+ */
+template <typename ValueType>
+class BPlusTreeKeySearch<NormalizedKey<8>, ValueType, NormalizedComparator<8>> {
+  using Entry = std::pair<NormalizedKey<8>, ValueType>;
+
+ public:
+  static int LowerBound(const Entry *array, int begin, int end, const NormalizedKey<8> &key,
+                        const NormalizedComparator<8> &comparator) {
+    return Search<false>(array, begin, end, Decode(key));
+  }
+
+  static int UpperBound(const Entry *array, int begin, int end, const NormalizedKey<8> &key,
+                        const NormalizedComparator<8> &comparator) {
+    return Search<true>(array, begin, end, Decode(key));
+  }
+
+ private:
+  /** Ranges at most this long are scanned instead of bisected. */
+  static constexpr int LINEAR_SCAN_THRESHOLD = 16;
+
+  static inline uint64_t Decode(const NormalizedKey<8> &key) {
+    uint64_t bits;
+    memcpy(&bits, key.data_, sizeof(uint64_t));
+    return __builtin_bswap64(bits);
+  }
+
+  /**
+   * Inclusive == false finds the first key >= probe, Inclusive == true finds the first key > probe.
+   */
+  template <bool Inclusive>
+  static int Search(const Entry *array, int begin, int end, uint64_t probe) {
+    while (end - begin > LINEAR_SCAN_THRESHOLD) {
+      int mid = begin + (end - begin) / 2;
+      uint64_t mid_key = Decode(array[mid].first);
+      if (mid_key < probe || (Inclusive && mid_key == probe)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    // keys are sorted, so the answer is begin plus the number of keys on the left of it
+    return begin + CountBelow<Inclusive>(array, begin, end, probe);
+  }
+
+  template <bool Inclusive>
+  static int CountBelow(const Entry *array, int begin, int end, uint64_t probe) {
+    int count = 0;
+    int i = begin;
+#if defined(__AVX2__)
+    // signed 64-bit compare only, so shift both sides into signed order
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i probe_vec = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(probe)), sign);
+    const __m256i offsets = _mm256_setr_epi64x(0, sizeof(Entry), 2 * sizeof(Entry), 3 * sizeof(Entry));
+    const __m256i bswap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1,
+                                           0, 15, 14, 13, 12, 11, 10, 9, 8);
+    for (; i + 4 <= end; i += 4) {
+      __m256i keys =
+          _mm256_i64gather_epi64(reinterpret_cast<const long long *>(array[i].first.data_), offsets, 1);  // NOLINT
+      keys = _mm256_xor_si256(_mm256_shuffle_epi8(keys, bswap), sign);
+      __m256i below = Inclusive ? _mm256_xor_si256(_mm256_cmpgt_epi64(keys, probe_vec), _mm256_set1_epi64x(-1))
+                                : _mm256_cmpgt_epi64(probe_vec, keys);
+      count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(below)));
+    }
+#elif defined(__SSE4_2__)
+    const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+    const __m128i probe_vec = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(probe)), sign);
+    for (; i + 2 <= end; i += 2) {
+      __m128i keys = _mm_set_epi64x(static_cast<int64_t>(Decode(array[i + 1].first)),
+                                    static_cast<int64_t>(Decode(array[i].first)));
+      keys = _mm_xor_si128(keys, sign);
+      __m128i below = Inclusive ? _mm_xor_si128(_mm_cmpgt_epi64(keys, probe_vec), _mm_set1_epi64x(-1))
+                                : _mm_cmpgt_epi64(probe_vec, keys);
+      count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(below)));
+    }
+#endif
+    for (; i < end; i++) {
+      uint64_t k = Decode(array[i].first);
+      count += static_cast<int>(k < probe || (Inclusive && k == probe));
+    }
+    return count;
+  }
+};
+
+/**
+ * In-node search over variable-length slots (see BPlusTreePage), only for keys
+ * that compare byte by byte. Slots start with the offset of their key bytes in
+ * the page and their length, keys lack the page prefix and trailing zeros.
+ * Inclusive == false finds the first key >= key, Inclusive == true finds the
+ * first key > key.
+ */
+template <bool Inclusive>
+int VariableSlotSearch(const char *page, const char *slots, size_t slot_size, int begin, int end, const char *prefix,
+                       size_t prefix_size, const char *key, size_t key_size) {
+  int cmp = memcmp(key, prefix, prefix_size);
+  if (cmp != 0) {
+    return cmp < 0 ? begin : end;
+  }
+  while (key_size > prefix_size && key[key_size - 1] == 0) {
+    key_size--;
+  }
+  const char *suffix = key + prefix_size;
+  int suffix_size = static_cast<int>(key_size - prefix_size);
+  while (begin < end) {
+    int mid = begin + (end - begin) / 2;
+    uint16_t offset;
+    uint16_t length;
+    memcpy(&offset, slots + mid * slot_size, sizeof(uint16_t));
+    memcpy(&length, slots + mid * slot_size + sizeof(uint16_t), sizeof(uint16_t));
+    // neither side has trailing zeros, so on a tie the longer key is larger
+    cmp = memcmp(page + offset, suffix, std::min<int>(length, suffix_size));
+    if (cmp == 0) {
+      cmp = length - suffix_size;
+    }
+    if (cmp < 0 || (Inclusive && cmp == 0)) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+}  // namespace bustub
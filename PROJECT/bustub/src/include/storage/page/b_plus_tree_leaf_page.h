@@ -18,46 +18,78 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 40
+// one slot is kept free for the entry that overflows the page before a split
+#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType) - 1)
+#define LEAF_SLOT_SIZE (KEY_SLOT_HEADER_SIZE + sizeof(ValueType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Equal keys (duplicates of a non-unique index) are kept next to each
+ * other. Leaves are doubly linked in key order, so that range scans can run in
+ * either direction.
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 40 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | PrefixSize (2) | KeyHeapSize (2) |
+ *  ---------------------------------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | LowFenceSize (2) | HighFenceSize (2) | NextPageId (4) | PrevPageId (4) |
+ *  ---------------------------------------------------------------------
+ *
+ * With variable-length keys (see BPlusTreePage), the array holds slots of
+ * LEAF_SLOT_SIZE bytes instead:
+ *  ----------------------------------------------------------------------
+ * | HEADER | SLOT(1) | ... | SLOT(n) | FREE | KEY(n) ... KEY(1) | FENCES |
+ *  ----------------------------------------------------------------------
+ * where SLOT(i) is | KeyOffset (2) | KeyLength (2) | RID(i) |. The page is
+ * then full when the next key might not fit, rather than at max size.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool variable_length_keys = false);
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  bool IsOverfull() const;
+  bool IsUnderfull(int fraction = 2) const;
+  double GetFillFactor() const;
+
+  // key prefix compression of variable-length keys, a nullptr fence is unbounded
+  void SetFences(const KeyType *low_fence, const KeyType *high_fence);
+  KeyType GetLowFence() const;
+  bool GetHighFence(KeyType *high_fence) const;
+  int GetEntrySpace(const KeyType &key, const KeyType *low_fence, const KeyType *high_fence) const;
+  int GetSpaceWithFences(const KeyType *low_fence, const KeyType *high_fence) const;
+  bool FitsWithFences(const KeyType *low_fence, const KeyType *high_fence, int size, int space) const;
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+  int RemoveAndDeleteRecord(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+  int RemoveRange(int begin, int end);
 
   // Split and Merge utility methods
+  int GetSplitIndex() const;
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
@@ -67,7 +99,13 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+  char *SlotAt(int index);
+  const char *SlotAt(int index) const;
+  void InsertAt(int index, const MappingType &item);
+  void RemoveAt(int index);
+  void Truncate(int size);
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   MappingType array[0];
 };
 }  // namespace bustub
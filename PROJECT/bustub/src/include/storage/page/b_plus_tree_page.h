@@ -17,6 +17,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 
@@ -27,18 +28,41 @@ namespace bustub {
 // define page type enum
 enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
 
+// a variable-length slot starts with the offset and the length of its key
+#define KEY_SLOT_HEADER_SIZE (2 * sizeof(uint16_t))
+
 /**
  * Both internal and leaf page are inherited from this page.
  *
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 24 bytes in total):
+ * Header format (size in byte, 32 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | PrefixSize (2) | KeyHeapSize (2) |
  * ----------------------------------------------------------------------------
+ * | LowFenceSize (2) | HighFenceSize (2) |
+ * ----------------------------------------
+ *
+ * Pages either store fixed-size key & value pairs in an array, or variable-
+ * length keys in slots (KeyHeapSize is -1 for the former). A variable-length
+ * slot holds the offset and length of its key followed by the value, while the
+ * key bytes are packed in a heap that grows from the end of the page towards
+ * the slots. Trailing zero bytes of a key are not stored, they read back as
+ * padding, and equal keys (duplicates, which are always adjacent) point to
+ * the same bytes, so every further duplicate only costs its slot.
+ *
+ * Key prefix compression: every key stored in a page lies between the low
+ * fence (inclusive) and the high fence (exclusive) that the separators of its
+ * parent give it, so all of them share the common prefix of the two fences.
+ * Pages with variable-length keys may keep fences, then the prefix is kept
+ * once, as the head of the low fence, and stripped from every key. Fences sit
+ * at the end of the page without their trailing zero bytes, right after the
+ * key heap; a page without a high fence is unbounded on the right. This only
+ * holds for keys that compare byte by byte (see IsBytewiseComparator), other
+ * pages keep PrefixSize at 0.
  */
 class BPlusTreePage {
  public:
@@ -62,6 +86,30 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  int GetPrefixSize() const;
+  bool HasVariableLengthKeys() const;
+
+ protected:
+  void ResetKeyLayout(bool variable_length_keys);
+  const char *GetKeyPrefix() const;
+  void CopyLowFence(char *key, size_t key_size) const;
+  bool CopyHighFence(char *key, size_t key_size) const;
+  void SetFenceData(char *slots, size_t slot_size, size_t key_size, const char *low_fence, const char *high_fence);
+
+  // variable-length key slots, see the layout above
+  void ReadSlotKey(const char *slot, char *key, size_t key_size) const;
+  void InsertSlot(char *slots, size_t slot_size, int index, const char *key, size_t key_size);
+  void RemoveSlot(char *slots, size_t slot_size, int index);
+  void CompactKeyHeap(char *slots, size_t slot_size);
+  bool IsSharedSlot(const char *slots, size_t slot_size, int index) const;
+  int GetSlotSpace(const char *slots, size_t slot_size, int index) const;
+  int GetFreeSpace(const char *slots, size_t slot_size) const;
+  int GetUsedSpace(size_t slot_size) const;
+  int GetKeySpace(const char *key, size_t key_size, const char *low_fence, const char *high_fence) const;
+  int GetSlotSpaceWithFences(const char *slots, size_t slot_size, size_t key_size, const char *low_fence,
+                             const char *high_fence) const;
+  int GetCapacityWithFences(const char *slots, size_t key_size, const char *low_fence, const char *high_fence) const;
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
@@ -70,6 +118,10 @@ class BPlusTreePage {
   int max_size_ __attribute__((__unused__));
   page_id_t parent_page_id_ __attribute__((__unused__));
   page_id_t page_id_ __attribute__((__unused__));
+  int16_t prefix_size_ __attribute__((__unused__));
+  int16_t key_heap_size_ __attribute__((__unused__));
+  int16_t low_fence_size_ __attribute__((__unused__));
+  int16_t high_fence_size_ __attribute__((__unused__));
 };
 
 }  // namespace bustub
@@ -22,15 +22,22 @@
 
 namespace bustub {
 /**
- * Store indexed key and and value together within block page. Supports
- * non-unique keys.
+ * Store indexed key and and value within block page. Supports non-unique
+ * keys.
  *
- * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ * Every readable slot also has a one byte fingerprint of the hash of its key,
+ * and tombstones and never occupied slots have 0, so a probe matches the
+ * fingerprints of 32 slots at once, and compares full keys only in the slots
+ * whose fingerprint matches.
  *
- *  Here '+' means concatenation.
+ * The keys are stored apart from the values, so a probe that compares keys
+ * reads them from consecutive cache lines, and pairs whose key and value
+ * would be padded as a std::pair take no padding.
+ *
+ * Block page format:
+ *  -------------------------------------------------------------------------------
+ * | OCCUPIED | READABLE | FINGERPRINTS | KEY(1) ... KEY(n) | VALUE(1) ... VALUE(n) |
+ *  -------------------------------------------------------------------------------
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -64,11 +71,23 @@ class HashTableBlockPage {
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint the fingerprint of the hash of key
    * @return If the value is inserted successfully, it returns true. If the
    * index is marked as occupied before the key and value can be inserted,
    * Insert returns false.
    */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
+
+  /**
+   * Overwrites the key and value at an occupied index, a pair or a tombstone,
+   * which becomes readable. The caller holds the page latch exclusively.
+   *
+   * @param bucket_ind index to write the key and value to
+   * @param key key to write
+   * @param value value to write
+   * @param fingerprint the fingerprint of the hash of key
+   */
+  void Replace(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
 
   /**
    * Removes a key and value at index.
@@ -93,12 +112,44 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Matches the fingerprints of a group of FINGERPRINT_GROUP_SIZE slots, with
+   * AVX2 or SSE2 where available.
+   *
+   * @param group the first index of the group, a multiple of FINGERPRINT_GROUP_SIZE
+   * @param fingerprint the fingerprint to look for
+   * @return a mask with bit i set if index group + i has the fingerprint
+   */
+  uint32_t MatchFingerprints(slot_offset_t group, uint8_t fingerprint) const;
+
+  /**
+   * Finds the first index in [begin, end) that was never occupied, skipping
+   * eight occupied indexes at a time.
+   *
+   * @return the index, end if they are all occupied
+   */
+  slot_offset_t FindUnoccupied(slot_offset_t begin, slot_offset_t end) const;
+
+  /**
+   * @return the fingerprint of a hash, its top seven bits and a set high bit
+   * so that it is never 0
+   */
+  static uint8_t Fingerprint(uint64_t hash);
+
+  /** The number of slots whose fingerprints MatchFingerprints compares at once. */
+  static constexpr slot_offset_t FINGERPRINT_GROUP_SIZE = 32;
+
  private:
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
-  MappingType array_[0];
+
+  // the fingerprint of the key of each readable slot, 0 otherwise, padded to whole groups
+  uint8_t fingerprints_[(BLOCK_ARRAY_SIZE - 1) / FINGERPRINT_GROUP_SIZE * FINGERPRINT_GROUP_SIZE +
+                        FINGERPRINT_GROUP_SIZE];
+  KeyType keys_[BLOCK_ARRAY_SIZE];
+  ValueType values_[BLOCK_ARRAY_SIZE];
 };
 
 }  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Store indexed key and value together within a bucket page of an
+ * extendible hash table. Supports non-unique keys. Unlike a block page of
+ * the linear probing hash table, all the pairs of a bucket hash to it, so a
+ * removed slot is taken again by the next insert. The bucket page is
+ * protected by its page latch.
+ *
+ * Bucket page format (keys are stored in no particular order):
+ *  ----------------------------------------------------------------
+ * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------
+ *
+ *  Here '+' means concatenation.
+ *
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /**
+   * Scans the bucket and collects the values that have the matching key.
+   *
+   * @return true if at least one key matched
+   */
+  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result);
+
+  /**
+   * Inserts a pair into the first free slot.
+   *
+   * @return false if the bucket already has the pair, or is full
+   */
+  bool Insert(KeyType key, ValueType value, KeyComparator cmp);
+
+  /**
+   * Removes a pair.
+   *
+   * @return true if the bucket had the pair
+   */
+  bool Remove(KeyType key, ValueType value, KeyComparator cmp);
+
+  /**
+   * Gets the key at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the key at
+   * @return key at index bucket_idx of the bucket
+   */
+  KeyType KeyAt(uint32_t bucket_idx) const;
+
+  /**
+   * Gets the value at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the value at
+   * @return value at index bucket_idx of the bucket
+   */
+  ValueType ValueAt(uint32_t bucket_idx) const;
+
+  /**
+   * Removes the pair at bucket_idx.
+   *
+   * @param bucket_idx the index to remove the pair at
+   */
+  void RemoveAt(uint32_t bucket_idx);
+
+  /**
+   * Returns whether or not an index has ever held a pair, slots are taken in
+   * order so the first one not occupied ends the pairs.
+   *
+   * @param bucket_idx index to look at
+   * @return true if the index is occupied, false otherwise
+   */
+  bool IsOccupied(uint32_t bucket_idx) const;
+
+  /**
+   * Returns whether or not an index is readable (valid key/value pair)
+   *
+   * @param bucket_idx index to look at
+   * @return true if the index is readable, false otherwise
+   */
+  bool IsReadable(uint32_t bucket_idx) const;
+
+  /**
+   * @return the number of readable pairs in the bucket
+   */
+  uint32_t NumReadable() const;
+
+  /**
+   * @return whether every slot of the bucket holds a pair
+   */
+  bool IsFull() const;
+
+  /**
+   * @return whether the bucket holds no pair
+   */
+  bool IsEmpty() const;
+
+  /**
+   * Removes every pair from the bucket.
+   */
+  void Reset();
+
+ private:
+  char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+
+  // 0 if removed/brand new (never occupied), 1 otherwise.
+  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
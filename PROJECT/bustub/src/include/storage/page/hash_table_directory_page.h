@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Directory Page for extendible hash table.
+ *
+ * The lowest global depth bits of the hash of a key index the directory. A
+ * bucket of local depth d is referenced by the 2 ^ (global depth - d) entries
+ * that agree on the lowest d bits.
+ *
+ * Directory format (size in byte):
+ * ----------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | LocalDepths (512) | BucketPageIds (2048) | Free (1524) |
+ * ----------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return the mask of the hash bits that index the directory
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Doubles the directory: the new upper half points to the same buckets as the lower half.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halves the directory, the caller checks CanShrink first.
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return whether every bucket has a local depth below the global depth, so the directory can halve
+   */
+  bool CanShrink() const;
+
+  /**
+   * @return the number of entries in the directory, 2 ^ global depth
+   */
+  uint32_t Size() const;
+
+  /**
+   * @param bucket_idx index in the directory
+   * @return the page id of the bucket at bucket_idx
+   */
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx index in the directory
+   * @param bucket_page_id the page id of the bucket to be set at bucket_idx
+   */
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  /**
+   * @param bucket_idx index in the directory
+   * @return the local depth of the bucket at bucket_idx
+   */
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx index in the directory
+   * @param local_depth the local depth to be set at bucket_idx
+   */
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  /**
+   * @param bucket_idx index in the directory
+   * @return the index of the bucket bucket_idx splits from, or merges with: the one that differs in its highest local
+   * depth bit
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  /**
+   * Asserts that every bucket is referenced by exactly 2 ^ (global depth - local depth) entries with the same local
+   * depth, and no local depth exceeds the global depth.
+   */
+  void VerifyIntegrity() const;
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+}  // namespace bustub
@@ -12,13 +12,46 @@
 
 #pragma once
 
+#include <cstddef>
+
+#include "common/config.h"
+
 #define MappingType std::pair<KeyType, ValueType>
 
-/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
- * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
- * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
- * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+namespace bustub {
+
+/** The number of (key, value) pairs a block page has room for. Each pair needs a key and a value, which the page
+ * stores in separate arrays, two additional bits for occupied_ and readable_, and a fingerprint byte, and the
+ * fingerprints are padded to whole groups of 32 for SIMD matching. This is the largest number of pairs for which all
+ * of that, with the keys and the values aligned, fits in a page: pairs that would have padding between the key and
+ * the value, or after the value, take none. */
+template <typename KeyType, typename ValueType>
+constexpr size_t HashTableBlockArraySize() {
+  size_t num_slots = PAGE_SIZE / (sizeof(KeyType) + sizeof(ValueType));
+  while (num_slots > 0) {
+    size_t size = 2 * ((num_slots - 1) / 8 + 1) + ((num_slots - 1) / 32 * 32 + 32);
+    size = (size + alignof(KeyType) - 1) / alignof(KeyType) * alignof(KeyType) + num_slots * sizeof(KeyType);
+    size = (size + alignof(ValueType) - 1) / alignof(ValueType) * alignof(ValueType) + num_slots * sizeof(ValueType);
+    if (size <= static_cast<size_t>(PAGE_SIZE)) {
+      return num_slots;
+    }
+    num_slots--;
+  }
+  return 0;
+}
+
+}  // namespace bustub
+
+#define BLOCK_ARRAY_SIZE (HashTableBlockArraySize<KeyType, ValueType>())
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs in a bucket page of an extendible hash table. Buckets have no
+ * fingerprints, so each pair needs two additional bits only: 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1). */
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+
+/** DIRECTORY_ARRAY_SIZE is the number of bucket page ids a directory page has room for, 2 ^ the largest global
+ * depth. */
+#define DIRECTORY_ARRAY_SIZE 512
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
@@ -30,7 +30,13 @@ static char *buffer_used;
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+    : file_name_(db_file),
+      next_page_id_(0),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -81,6 +87,7 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  std::lock_guard<std::mutex> guard(db_io_latch_);
   // set write cursor to offset
   num_writes_ += 1;
   db_io_.seekp(offset);
@@ -99,6 +106,8 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   int offset = page_id * PAGE_SIZE;
+  std::lock_guard<std::mutex> guard(db_io_latch_);
+  num_reads_ += 1;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
@@ -207,6 +216,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -9,7 +9,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+#include <random>
 #include <string>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -19,13 +23,30 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool prefix_compression, bool unique_keys,
+                          int pinned_levels, bool lazy_merge, bool defer_root_write)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      prefix_compression_(prefix_compression && IsBytewiseComparator<KeyComparator>::value),
+      unique_keys_(unique_keys),
+      pinned_levels_(pinned_levels),
+      root_record_inserted_(false),
+      root_page_id_dirty_(false),
+      defer_root_write_(defer_root_write),
+      lazy_merge_(lazy_merge),
+      enable_compaction_(false),
+      compaction_thread_(nullptr),
+      prefetch_leaves_(INDEX_SCAN_PREFETCH_LEAVES) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  this->StopBackgroundCompaction();
+  this->ReleasePinnedPages();
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -36,25 +57,222 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return this->root_page_id_ == INVALID_PAG
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key, the only one with unique
+ * keys
  * This method is used for point query
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
   this->rwlatch_.RLock();
-  Page *target_page = FindLeafPage(key, false);
-  if (target_page != nullptr) {
-    ValueType val;
-    if (reinterpret_cast<LeafPage *>(target_page->GetData())->Lookup(key, &val, this->comparator_)) {
-      result->push_back(val);
+  Page *target_page = this->unique_keys_ ? FindLeafPage(key, false) : this->FindFirstLeafPage(key);
+  if (target_page == nullptr) {
+    this->rwlatch_.RUnlock();
+    return false;
+  }
+  if (!this->unique_keys_) {
+    size_t size_before = result->size();
+    bool collected = this->CollectDuplicates(reinterpret_cast<LeafPage *>(target_page->GetData()), key, result);
+    this->buffer_pool_manager_->UnpinPage(target_page->GetPageId(), false);
+    this->rwlatch_.RUnlock();
+    if (!collected) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    return result->size() > size_before;
+  }
+  ValueType val;
+  bool found = reinterpret_cast<LeafPage *>(target_page->GetData())->Lookup(key, &val, this->comparator_);
+  if (found) {
+    result->push_back(val);
+  }
+  this->buffer_pool_manager_->UnpinPage(target_page->GetPageId(), false);
+  this->rwlatch_.RUnlock();
+  return found;
+}
+
+/*
+ * Return the values associated with each of the input keys, results[i] holds
+ * the values of keys[i]
+ * This method is used for batches of point queries (IN-lists, index nested
+ * loop joins): the keys are probed in sorted order along one root-to-leaf
+ * path that stays pinned, and the path is only climbed as high as the first
+ * page whose key range holds the next key, so neighbouring keys share their
+ * internal pages and often their leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), std::vector<ValueType>());
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return this->comparator_(keys[a], keys[b]) < 0; });
+
+  this->rwlatch_.RLock();
+  if (this->IsEmpty()) {
+    this->rwlatch_.RUnlock();
+    return;
+  }
+  // the pinned pages from the root down, each with the separator right of it in its parent, the keys it holds are
+  // below that separator (at most equal to it without unique keys, where the descent goes to the leftmost child)
+  struct PathEntry {
+    Page *page_;
+    bool bounded_;
+    KeyType upper_;
+  };
+  std::vector<PathEntry> path;
+  path.push_back({this->FetchTreePage(this->root_page_id_), false, KeyType()});
+  for (size_t n = 0; n < order.size(); n++) {
+    size_t i = order[n];
+    const KeyType &key = keys[i];
+    // a key probed twice gets the same values
+    if (n > 0 && this->comparator_(keys[order[n - 1]], key) == 0) {
+      (*results)[i] = (*results)[order[n - 1]];
+      continue;
+    }
+    // keys come in increasing order, so only the upper bounds can rule a page out
+    while (path.size() > 1) {
+      const PathEntry &entry = path.back();
+      int cmp = entry.bounded_ ? this->comparator_(key, entry.upper_) : -1;
+      if (cmp < 0 || (cmp == 0 && !this->unique_keys_)) {
+        break;
+      }
+      this->UnpinTreePage(entry.page_);
+      path.pop_back();
+    }
+    while (!reinterpret_cast<BPlusTreePage *>(path.back().page_->GetData())->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(path.back().page_->GetData());
+      int index = internal->LookupIndex(key, this->comparator_, !this->unique_keys_);
+      PathEntry child{this->FetchTreePage(internal->ValueAt(index)), path.back().bounded_,
+                      path.back().upper_};
+      if (index + 1 < internal->GetSize()) {
+        child.bounded_ = true;
+        child.upper_ = internal->KeyAt(index + 1);
+      }
+      path.push_back(child);
+    }
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(path.back().page_->GetData());
+    if (this->unique_keys_) {
+      ValueType value;
+      if (leaf->Lookup(key, &value, this->comparator_)) {
+        (*results)[i].push_back(value);
+      }
+    } else if (!this->CollectDuplicates(leaf, key, &(*results)[i])) {
+      for (auto &entry : path) {
+        this->UnpinTreePage(entry.page_);
+      }
       this->rwlatch_.RUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+  }
+  for (auto &entry : path) {
+    this->UnpinTreePage(entry.page_);
+  }
+  this->rwlatch_.RUnlock();
+}
+
+/*
+ * Append the values of the keys in [low_key, high_key] to result, in key
+ * order (or in reverse key order when descending), with the bounds excluded
+ * unless inclusive, and stop after limit values. A nullptr bound is
+ * unbounded. The keys of the values are appended to keys, if given.
+ * This method is used for range query: it seeks to the first leaf of the
+ * range in the scan direction and stops at the first key past the other
+ * bound, so it only reads the leaves of the range. Leaves that end within the
+ * range are copied without comparing their keys against the far bound.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetRange(const KeyType *low_key, const KeyType *high_key, bool low_inclusive,
+                              bool high_inclusive, bool descending, size_t limit, std::vector<ValueType> *result,
+                              Transaction *transaction, std::vector<KeyType> *keys) {
+  if (limit == 0) {
+    return;
+  }
+  this->rwlatch_.RLock();
+  // the bound the scan starts from, and the bound it stops at
+  const KeyType *start_key = descending ? high_key : low_key;
+  const KeyType *stop_key = descending ? low_key : high_key;
+  bool stop_inclusive = descending ? low_inclusive : high_inclusive;
+  Page *page;
+  if (start_key == nullptr) {
+    page = descending ? this->FindLastLeafPage() : this->FindLeafPage(KeyType(), true);
+  } else {
+    // the rightmost leaf that may hold high_key, the leftmost one that may hold low_key
+    page = descending ? this->FindLeafPage(*start_key, false) : this->FindFirstLeafPage(*start_key);
+  }
+  if (page == nullptr) {
+    this->rwlatch_.RUnlock();
+    return;
+  }
+  auto before_stop = [&](const KeyType &key) {
+    if (stop_key == nullptr) {
       return true;
-    } else {
-      this->rwlatch_.RUnlock();
+    }
+    int cmp = this->comparator_(key, *stop_key);
+    return (descending ? cmp > 0 : cmp < 0) || (cmp == 0 && stop_inclusive);
+  };
+
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index;
+  if (start_key == nullptr) {
+    index = descending ? leaf->GetSize() - 1 : 0;
+  } else {
+    index = leaf->KeyIndex(*start_key, this->comparator_);
+    if (descending) {
+      // start from the last duplicate of high_key
+      while (index < leaf->GetSize() && this->comparator_(leaf->KeyAt(index), *start_key) == 0) {
+        index++;
+      }
+      index--;
     }
   }
-  return false;
+  // an exclusive start_key is skipped with its duplicates, which may continue in the following leaves
+  bool skip_start = start_key != nullptr && !(descending ? high_inclusive : low_inclusive);
+  bool done = false;
+  while (!done) {
+    int size = leaf->GetSize();
+    bool whole_leaf = size > 0 && before_stop(leaf->KeyAt(descending ? 0 : size - 1));
+    // the scan goes on past this leaf, read the next ones meanwhile
+    if (whole_leaf && limit > static_cast<size_t>(size)) {
+      INDEXITERATOR_TYPE::PrefetchLeaves(leaf, descending, this->prefetch_leaves_, this->buffer_pool_manager_);
+    }
+    for (; index >= 0 && index < size; index += descending ? -1 : 1) {
+      MappingType item = leaf->GetItem(index);
+      if (!whole_leaf && !before_stop(item.first)) {
+        done = true;
+        break;
+      }
+      if (skip_start) {
+        if (this->comparator_(item.first, *start_key) == 0) {
+          continue;
+        }
+        skip_start = false;
+      }
+      result->push_back(item.second);
+      if (keys != nullptr) {
+        keys->push_back(item.first);
+      }
+      if (--limit == 0) {
+        done = true;
+        break;
+      }
+    }
+    page_id_t next_page_id = descending ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+    done = done || next_page_id == INVALID_PAGE_ID;
+    this->buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    if (!done) {
+      Page *next_page = this->buffer_pool_manager_->FetchPage(next_page_id);
+      if (next_page == nullptr) {
+        this->rwlatch_.RUnlock();
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+      }
+      leaf = reinterpret_cast<LeafPage *>(next_page->GetData());
+      index = descending ? leaf->GetSize() - 1 : 0;
+    }
+  }
+  this->rwlatch_.RUnlock();
 }
 
 /*****************************************************************************
@@ -64,8 +282,8 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: with unique keys, if user try to insert duplicate keys return
+ * false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
@@ -80,6 +298,74 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     return rev;
   }
 }
+
+/*
+ * Build the tree from entries sorted by key, the way index creation fills a
+ * new index from an existing table.
+ * Leaves are filled left to right up to BULK_LOAD_FILL_FACTOR, so that the
+ * first inserts into a leaf after the build do not split it, and every new
+ * leaf is attached to the right end of its parent level, which splits like on
+ * inserts. With unique keys, only the first of equal keys is kept. A tree that
+ * is not empty gets the entries inserted one by one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoad(const std::vector<MappingType> &entries, Transaction *transaction) {
+  this->rwlatch_.WLock();
+  if (!this->IsEmpty()) {
+    for (auto &entry : entries) {
+      this->InsertIntoLeaf(entry.first, entry.second, transaction);
+    }
+    this->rwlatch_.WUnlock();
+    return;
+  }
+  LeafPage *leaf = nullptr;
+  for (size_t i = 0; i < entries.size(); i++) {
+    const KeyType &key = entries[i].first;
+    if (this->unique_keys_ && i > 0 && this->comparator_(entries[i - 1].first, key) == 0) {
+      continue;
+    }
+    if (leaf != nullptr) {
+      leaf->Insert(key, entries[i].second, this->comparator_);
+      if (!leaf->IsOverfull() && leaf->GetFillFactor() <= BULK_LOAD_FILL_FACTOR) {
+        continue;
+      }
+      leaf->RemoveAndDeleteRecord(key, entries[i].second, this->comparator_);
+    }
+
+    // the entry starts the next leaf
+    page_id_t new_page_id;
+    Page *new_page_ptr = this->buffer_pool_manager_->NewPage(&new_page_id);
+    if (new_page_ptr == nullptr) {
+      throw new Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    LeafPage *new_leaf = reinterpret_cast<LeafPage *>(new_page_ptr->GetData());
+    new_leaf->Init(new_page_id, INVALID_PAGE_ID, this->leaf_max_size_, this->prefix_compression_);
+    if (leaf == nullptr) {
+      this->root_page_id_ = new_page_id;
+      UpdateRootPageId();
+    } else {
+      KeyType last_key = leaf->KeyAt(leaf->GetSize() - 1);
+      KeyType separator = this->prefix_compression_ ? this->ShortestSeparator(last_key, key) : key;
+      if (this->prefix_compression_) {
+        new_leaf->SetFences(&separator, nullptr);
+        KeyType low_fence = leaf->GetLowFence();
+        leaf->SetFences(&low_fence, &separator);
+      }
+      new_leaf->SetParentPageId(leaf->GetParentPageId());
+      new_leaf->SetPrevPageId(leaf->GetPageId());
+      leaf->SetNextPageId(new_page_id);
+      this->InsertIntoParent(leaf, separator, new_leaf, transaction);
+      this->buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+    }
+    leaf = new_leaf;
+    leaf->Insert(key, entries[i].second, this->comparator_);
+  }
+  if (leaf != nullptr) {
+    this->buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  }
+  this->rwlatch_.WUnlock();
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -92,9 +378,10 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   if (root_page == nullptr) {
     throw new Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
   }
-  UpdateRootPageId(1);
   LeafPage *page = reinterpret_cast<LeafPage *>(root_page->GetData());
-  page->Init(this->root_page_id_, INVALID_PAGE_ID, this->leaf_max_size_);
+  page->Init(this->root_page_id_, INVALID_PAGE_ID, this->leaf_max_size_, this->prefix_compression_);
+  // after the root is initialized, so that it is not taken for an internal page to pin
+  UpdateRootPageId();
   page->Insert(key, value, this->comparator_);
   this->buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
@@ -104,39 +391,34 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * Without unique keys, the entry goes in front of the duplicates in the leaf.
+ * @return: with unique keys, if user try to insert duplicate keys return
+ * false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  page_id_t curr_page_id = this->root_page_id_;
-  while (curr_page_id != INVALID_PAGE_ID) {
-    BPlusTreePage *curr_page_ptr =
-        reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(curr_page_id)->GetData());
-    if (curr_page_ptr->IsLeafPage()) {
-      LeafPage *leaf_page_ptr = reinterpret_cast<LeafPage *>(curr_page_ptr);
-      ValueType v;
-      // key already exists
-      if (leaf_page_ptr->Lookup(key, &v, this->comparator_)) {
-        return false;
-      }
-      int size = leaf_page_ptr->Insert(key, value, this->comparator_);
-      // overflow
-      if (size > leaf_page_ptr->GetMaxSize()) {
-        BPlusTreePage *new_leaf_page_ptr = Split(curr_page_ptr);
-        this->InsertIntoParent(curr_page_ptr, reinterpret_cast<LeafPage *>(new_leaf_page_ptr)->KeyAt(0),
-                               new_leaf_page_ptr, transaction);
-        this->buffer_pool_manager_->UnpinPage(new_leaf_page_ptr->GetPageId(), true);
-      }
-      this->buffer_pool_manager_->UnpinPage(leaf_page_ptr->GetPageId(), true);
-      return true;
-    } else {
-      InternalPage *internal_page_ptr = reinterpret_cast<InternalPage *>(curr_page_ptr);
-      curr_page_id = internal_page_ptr->Lookup(key, this->comparator_);
-      this->buffer_pool_manager_->UnpinPage(curr_page_ptr->GetPageId(), false);
-    }
+  Page *leaf = this->FindLeafPage(key, false);
+  if (leaf == nullptr) {
+    return false;
   }
-  return false;
+  LeafPage *leaf_page_ptr = reinterpret_cast<LeafPage *>(leaf->GetData());
+  ValueType v;
+  // key already exists
+  if (this->unique_keys_ && leaf_page_ptr->Lookup(key, &v, this->comparator_)) {
+    this->buffer_pool_manager_->UnpinPage(leaf_page_ptr->GetPageId(), false);
+    return false;
+  }
+  leaf_page_ptr->Insert(key, value, this->comparator_);
+  // overflow
+  if (leaf_page_ptr->IsOverfull()) {
+    LeafPage *new_leaf_page_ptr = Split(leaf_page_ptr);
+    // the low fence of the new leaf is the truncated separator
+    KeyType separator = this->prefix_compression_ ? new_leaf_page_ptr->GetLowFence() : new_leaf_page_ptr->KeyAt(0);
+    this->InsertIntoParent(leaf_page_ptr, separator, new_leaf_page_ptr, transaction);
+    this->buffer_pool_manager_->UnpinPage(new_leaf_page_ptr->GetPageId(), true);
+  }
+  this->buffer_pool_manager_->UnpinPage(leaf_page_ptr->GetPageId(), true);
+  return true;
 }
 
 /*
@@ -154,20 +436,55 @@ N *BPLUSTREE_TYPE::Split(N *node) {
   if (new_page_ptr == nullptr) {
     throw new Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
   }
+  // the first moved entry starts the new page
+  int first = node->GetSplitIndex();
+  KeyType separator;
+  KeyType high_fence;
+  bool bounded = false;
+  if (this->prefix_compression_) {
+    bounded = node->GetHighFence(&high_fence);
+  }
   if (node->IsLeafPage()) {
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
     LeafPage *recipient = reinterpret_cast<LeafPage *>(new_page_ptr->GetData());
-    recipient->Init(new_page_id, node->GetParentPageId(), node->GetMaxSize());
+    recipient->Init(new_page_id, node->GetParentPageId(), this->leaf_max_size_, this->prefix_compression_);
+    // fence the new page first, so that it has room for the entries it receives
+    if (this->prefix_compression_) {
+      separator = this->ShortestSeparator(leaf->KeyAt(first - 1), leaf->KeyAt(first));
+      recipient->SetFences(&separator, bounded ? &high_fence : nullptr);
+    }
 
-    reinterpret_cast<LeafPage *>(node)->MoveHalfTo(recipient);
-    reinterpret_cast<LeafPage *>(node)->SetNextPageId(new_page_id);
+    leaf->MoveHalfTo(recipient);
+    recipient->SetNextPageId(leaf->GetNextPageId());
+    recipient->SetPrevPageId(leaf->GetPageId());
+    leaf->SetNextPageId(new_page_id);
+    this->RelinkPrevPage(recipient->GetNextPageId(), new_page_id);
 
-    return recipient;
+    if (this->prefix_compression_) {
+      KeyType low_fence = leaf->GetLowFence();
+      leaf->SetFences(&low_fence, &separator);
+    }
+    return reinterpret_cast<N *>(recipient);
   } else {
+    InternalPage *internal = reinterpret_cast<InternalPage *>(node);
     InternalPage *recipient = reinterpret_cast<InternalPage *>(new_page_ptr->GetData());
-    recipient->Init(new_page_id, node->GetParentPageId(), node->GetMaxSize());
+    recipient->Init(new_page_id, node->GetParentPageId(), this->internal_max_size_, this->prefix_compression_);
+    if (this->prefix_compression_) {
+      separator = internal->KeyAt(first);
+      recipient->SetFences(&separator, bounded ? &high_fence : nullptr);
+    }
 
-    reinterpret_cast<InternalPage *>(node)->MoveHalfTo(recipient, this->buffer_pool_manager_);
-    return recipient;
+    internal->MoveHalfTo(recipient, this->buffer_pool_manager_);
+    // the new page is on the same level, so it is pinned with the pages around it
+    if (this->pinned_pages_.count(internal->GetPageId()) != 0) {
+      this->pinned_pages_[new_page_id] = this->buffer_pool_manager_->FetchPage(new_page_id);
+    }
+
+    if (this->prefix_compression_) {
+      KeyType low_fence = internal->GetLowFence();
+      internal->SetFences(&low_fence, &separator);
+    }
+    return reinterpret_cast<N *>(recipient);
   }
 }
 
@@ -191,27 +508,25 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
       throw new Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
     }
     this->root_page_id_ = new_root_page_id;
-    UpdateRootPageId(0);
 
-    InternalPage *new_root_tree_page =
-        reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(new_root_page_id)->GetData());
-    new_root_tree_page->Init(new_root_page_id, INVALID_PAGE_ID, this->internal_max_size_);
+    InternalPage *new_root_tree_page = reinterpret_cast<InternalPage *>(new_root_page->GetData());
+    new_root_tree_page->Init(new_root_page_id, INVALID_PAGE_ID, this->internal_max_size_, this->prefix_compression_);
     old_node->SetParentPageId(new_root_page_id);
     new_node->SetParentPageId(new_root_page_id);
     new_root_tree_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    // after the new root is filled in, the pinned levels are read from it
+    UpdateRootPageId();
 
-    this->buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+    this->buffer_pool_manager_->UnpinPage(new_root_page_id, true);
     return;
   }
   page_id_t parent_id = old_node->GetParentPageId();
-  BPlusTreePage *parent_page =
-      reinterpret_cast<BPlusTreePage *>(this->buffer_pool_manager_->FetchPage(parent_id)->GetData());
-  int size =
-      reinterpret_cast<InternalPage *>(parent_page)->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-  if (size > parent_page->GetMaxSize()) {
-    BPlusTreePage *new_split_page = this->Split(parent_page);
-    this->InsertIntoParent(parent_page, reinterpret_cast<InternalPage *>(new_split_page)->KeyAt(0), new_split_page,
-                           transaction);
+  InternalPage *parent_page =
+      reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(parent_id)->GetData());
+  parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  if (parent_page->IsOverfull()) {
+    InternalPage *new_split_page = this->Split(parent_page);
+    this->InsertIntoParent(parent_page, new_split_page->KeyAt(0), new_split_page, transaction);
 
     this->buffer_pool_manager_->UnpinPage(new_split_page->GetPageId(), true);
   }
@@ -231,35 +546,497 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   this->rwlatch_.WLock();
-  if (this->IsEmpty()) {
-    return;
-  }
-  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, false));
-  if (leaf_page == nullptr) {
+  Page *page = FindLeafPage(key, false);
+  if (page == nullptr) {
     this->rwlatch_.WUnlock();
     return;
   }
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int size_before_deletion = leaf_page->GetSize();
   int size_after_deletion = leaf_page->RemoveAndDeleteRecord(key, this->comparator_);
-  // underflow happends
-  if (size_after_deletion < leaf_page->GetMinSize()) {
-    if (CoalesceOrRedistribute(leaf_page, transaction)) {
-      this->buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
+  this->FinishRemove(leaf_page, size_after_deletion < size_before_deletion, transaction);
+  this->rwlatch_.WUnlock();
+}
+
+/*
+ * Delete the key & value pair with both input key and input value
+ * Duplicates of key may span several leaves, so start from the leftmost leaf
+ * that may hold key, and follow the leaf chain while the leaves end with keys
+ * <= key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  this->rwlatch_.WLock();
+  Page *page = this->FindFirstLeafPage(key);
+  while (page != nullptr) {
+    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    int size_before_deletion = leaf_page->GetSize();
+    int size_after_deletion = leaf_page->RemoveAndDeleteRecord(key, value, this->comparator_);
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    if (size_after_deletion < size_before_deletion || size_after_deletion == 0 ||
+        this->comparator_(leaf_page->KeyAt(size_after_deletion - 1), key) > 0 || next_page_id == INVALID_PAGE_ID) {
+      this->FinishRemove(leaf_page, size_after_deletion < size_before_deletion, transaction);
+      break;
     }
+    this->buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    page = this->buffer_pool_manager_->FetchPage(next_page_id);
+  }
+  this->rwlatch_.WUnlock();
+}
+
+/*
+ * Delete every entry with a key between low_key and high_key, a nullptr bound
+ * is unbounded. Only the pages on the paths to the two ends of the range are
+ * changed entry by entry: the subtrees between those paths are covered by the
+ * range, and are freed and dropped from their parent at once. The pages left
+ * under-full on the two paths are then merged or refilled in one pass.
+ * Prefix-compressed pages would have to widen their fences over the dropped
+ * subtrees, which they may have no room for, so those trees are walked leaf
+ * by leaf instead, see RemoveRangeByLeaf().
+ * @return: the number of entries deleted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::RemoveRange(const KeyType *low_key, const KeyType *high_key, bool low_inclusive,
+                                   bool high_inclusive, Transaction *transaction) {
+  this->rwlatch_.WLock();
+  size_t removed = 0;
+  if (this->IsEmpty()) {
+    this->rwlatch_.WUnlock();
+    return removed;
+  }
+  if (this->prefix_compression_) {
+    removed = this->RemoveRangeByLeaf(low_key, high_key, low_inclusive, high_inclusive, transaction);
+    this->rwlatch_.WUnlock();
+    return removed;
+  }
+  page_id_t low_leaf_page_id = INVALID_PAGE_ID;
+  page_id_t high_leaf_page_id = INVALID_PAGE_ID;
+  removed = this->RemoveRangeFrom(this->root_page_id_, low_key, high_key, low_inclusive, high_inclusive,
+                                  &low_leaf_page_id, &high_leaf_page_id);
+  // link the leaves the two ends were found in over the leaves dropped between them, an unbounded end dropped the
+  // leaves up to the end of the chain
+  if (removed > 0 && high_key == nullptr) {
+    Page *page = this->buffer_pool_manager_->FetchPage(low_leaf_page_id);
+    reinterpret_cast<LeafPage *>(page->GetData())->SetNextPageId(INVALID_PAGE_ID);
+    this->buffer_pool_manager_->UnpinPage(low_leaf_page_id, true);
+  } else if (removed > 0 && low_key == nullptr) {
+    this->RelinkPrevPage(high_leaf_page_id, INVALID_PAGE_ID);
+  } else if (low_leaf_page_id != high_leaf_page_id) {
+    Page *page = this->buffer_pool_manager_->FetchPage(low_leaf_page_id);
+    reinterpret_cast<LeafPage *>(page->GetData())->SetNextPageId(high_leaf_page_id);
+    this->buffer_pool_manager_->UnpinPage(low_leaf_page_id, true);
+    this->RelinkPrevPage(high_leaf_page_id, low_leaf_page_id);
+  }
+  if (removed > 0) {
+    this->RepairRangePath(low_key, low_inclusive, false, transaction);
+    this->RepairRangePath(high_key, !high_inclusive, true, transaction);
   }
   this->rwlatch_.WUnlock();
+  return removed;
+}
+
+/*
+ * Delete the entries of the range under page_id. The child of an internal page
+ * holding the low end and the one holding the high end are descended into,
+ * the children between them are freed without reading their entries. A
+ * nullptr end is past the edge of the page, and covers the children up to it,
+ * only with both ends unbounded is the first child still descended into.
+ * Records the first and the last leaf the descents end in.
+ * NOTE: pages are left under-full, RepairRangePath() fixes them
+ * @return: the number of entries deleted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::RemoveRangeFrom(page_id_t page_id, const KeyType *low_key, const KeyType *high_key,
+                                       bool low_inclusive, bool high_inclusive, page_id_t *low_leaf_page_id,
+                                       page_id_t *high_leaf_page_id) {
+  Page *page = this->buffer_pool_manager_->FetchPage(page_id);
+  size_t removed = 0;
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    int begin;
+    int end;
+    this->RangeInLeaf(leaf_page, low_key, high_key, low_inclusive, high_inclusive, &begin, &end);
+    if (begin < end) {
+      leaf_page->RemoveRange(begin, end);
+      removed = end - begin;
+    }
+    if (*low_leaf_page_id == INVALID_PAGE_ID) {
+      *low_leaf_page_id = page_id;
+    }
+    *high_leaf_page_id = page_id;
+    this->buffer_pool_manager_->UnpinPage(page_id, removed > 0);
+    return removed;
+  }
+
+  InternalPage *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+  // child i holds the keys from KeyAt(i) to KeyAt(i + 1), both included with duplicates: past first, every key is
+  // above the low end, and before last, every key is below the high end
+  int first = low_key == nullptr ? 0 : internal_page->LookupIndex(*low_key, this->comparator_, low_inclusive);
+  int last = high_key == nullptr ? internal_page->GetSize() - 1
+                                 : internal_page->LookupIndex(*high_key, this->comparator_, !high_inclusive);
+  // the children dropped whole, from drop_begin to drop_end (exclusive)
+  int drop_begin = first + 1;
+  int drop_end = first + 1;
+  if (first == last && low_key != nullptr && high_key != nullptr) {
+    removed = this->RemoveRangeFrom(internal_page->ValueAt(first), low_key, high_key, low_inclusive, high_inclusive,
+                                    low_leaf_page_id, high_leaf_page_id);
+  } else if (first <= last) {
+    if (low_key != nullptr || high_key == nullptr) {
+      removed = this->RemoveRangeFrom(internal_page->ValueAt(first), low_key, nullptr, low_inclusive, high_inclusive,
+                                      low_leaf_page_id, high_leaf_page_id);
+    } else {
+      drop_begin = 0;
+    }
+    drop_end = high_key == nullptr ? internal_page->GetSize() : last;
+    for (int i = drop_begin; i < drop_end; i++) {
+      removed += this->DeleteSubtree(internal_page->ValueAt(i));
+    }
+    // the child of the high end now follows the one of the low end, with its own separator
+    internal_page->RemoveRange(drop_begin, drop_end);
+    if (high_key != nullptr) {
+      removed += this->RemoveRangeFrom(internal_page->ValueAt(drop_begin), nullptr, high_key, low_inclusive,
+                                       high_inclusive, low_leaf_page_id, high_leaf_page_id);
+    }
+  }
+  this->buffer_pool_manager_->UnpinPage(page_id, drop_begin < drop_end);
+  return removed;
+}
+
+/*
+ * Free the pages of the subtree under page_id. Leaves are only read for their
+ * size.
+ * @return: the number of entries in the subtree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::DeleteSubtree(page_id_t page_id) {
+  Page *page = this->buffer_pool_manager_->FetchPage(page_id);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  size_t entries = 0;
+  if (node->IsLeafPage()) {
+    entries = node->GetSize();
+  } else {
+    InternalPage *internal_page = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal_page->GetSize(); i++) {
+      entries += this->DeleteSubtree(internal_page->ValueAt(i));
+    }
+  }
+  this->buffer_pool_manager_->UnpinPage(page_id, false);
+  this->DeleteTreePage(page_id);
+  return entries;
+}
+
+/*
+ * Merge or refill the pages RemoveRangeFrom() left under-full on the path to
+ * one end of the range, top-down: a page is repaired once its parent is, so
+ * that it has a sibling in it to merge with, and the merges it passes up stop
+ * at pages already repaired. The path is found again from the root after each
+ * page repaired, since merges move the end of the range to other pages.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RepairRangePath(const KeyType *key, bool first, bool last, Transaction *transaction) {
+  bool repaired = true;
+  while (repaired) {
+    repaired = false;
+    for (page_id_t page_id : this->FindRangePath(key, first, last)) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(this->buffer_pool_manager_->FetchPage(page_id)->GetData());
+      repaired = node->IsLeafPage() ? this->RepairRangePage(reinterpret_cast<LeafPage *>(node), transaction)
+                                    : this->RepairRangePage(reinterpret_cast<InternalPage *>(node), transaction);
+      if (repaired) {
+        break;
+      }
+    }
+  }
+}
+
+/*
+ * The page ids from the root down to a leaf, the one of the leftmost leaf
+ * that may hold key if first, the rightmost one otherwise. A nullptr key leads
+ * to the first leaf, or to the last one if last.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<page_id_t> BPLUSTREE_TYPE::FindRangePath(const KeyType *key, bool first, bool last) {
+  std::vector<page_id_t> path;
+  page_id_t curr_page_id = this->root_page_id_;
+  while (curr_page_id != INVALID_PAGE_ID) {
+    path.push_back(curr_page_id);
+    Page *curr_page = this->FetchTreePage(curr_page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+    if (node->IsLeafPage()) {
+      this->UnpinTreePage(curr_page);
+      break;
+    }
+    InternalPage *internal_page = reinterpret_cast<InternalPage *>(node);
+    int index = last ? internal_page->GetSize() - 1 : 0;
+    if (key != nullptr) {
+      index = internal_page->LookupIndex(*key, this->comparator_, first);
+    }
+    curr_page_id = internal_page->ValueAt(index);
+    this->UnpinTreePage(curr_page);
+  }
+  return path;
+}
+
+/*
+ * Merge or refill node, pinned, until it is no longer under-full. The root is
+ * left under-full unless it is an empty leaf or has a single child. Then unpin
+ * (and delete) node.
+ * @return: whether the tree changed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::RepairRangePage(N *node, Transaction *transaction) {
+  page_id_t page_id = node->GetPageId();
+  bool should_delete = false;
+  bool repaired = false;
+  while (!should_delete && this->NeedsRebalance(node)) {
+    if (node->IsRootPage() && node->GetSize() > (node->IsLeafPage() ? 0 : 1)) {
+      break;
+    }
+    should_delete = this->CoalesceOrRedistribute(node, transaction);
+    repaired = true;
+  }
+  this->buffer_pool_manager_->UnpinPage(page_id, repaired);
+  if (should_delete) {
+    this->DeleteTreePage(page_id);
+  }
+  return repaired;
+}
+
+/*
+ * The entries of leaf_page with keys in the range, from begin to end
+ * (exclusive), a nullptr bound is unbounded
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RangeInLeaf(LeafPage *leaf_page, const KeyType *low_key, const KeyType *high_key,
+                                 bool low_inclusive, bool high_inclusive, int *begin, int *end) {
+  int size = leaf_page->GetSize();
+  *begin = 0;
+  if (low_key != nullptr) {
+    *begin = leaf_page->KeyIndex(*low_key, this->comparator_);
+    while (!low_inclusive && *begin < size && this->comparator_(leaf_page->KeyAt(*begin), *low_key) == 0) {
+      (*begin)++;
+    }
+  }
+  *end = size;
+  if (high_key != nullptr) {
+    *end = std::max(*begin, leaf_page->KeyIndex(*high_key, this->comparator_));
+    while (high_inclusive && *end < size && this->comparator_(leaf_page->KeyAt(*end), *high_key) == 0) {
+      (*end)++;
+    }
+  }
+}
+
+/*
+ * RemoveRange() for prefix-compressed trees: the leaves of the range are
+ * walked once, their entries are dropped, all of them at once in the leaves
+ * the range covers, and each changed leaf is merged or refilled right after
+ * the walk moved past it, so the emptied leaves fold into the leaf before them
+ * and free the internal pages left without children.
+ * @return: the number of entries deleted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::RemoveRangeByLeaf(const KeyType *low_key, const KeyType *high_key, bool low_inclusive,
+                                         bool high_inclusive, Transaction *transaction) {
+  Page *page = low_key == nullptr ? this->FindLeafPage(KeyType(), true) : this->FindFirstLeafPage(*low_key);
+  size_t removed = 0;
+  // the last leaf changed, not rebalanced before the walk is done with the leaf after it, which it may absorb
+  page_id_t pending_page_id = INVALID_PAGE_ID;
+  while (page != nullptr) {
+    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    page_id_t leaf_page_id = leaf_page->GetPageId();
+    int size = leaf_page->GetSize();
+    int begin;
+    int end;
+    this->RangeInLeaf(leaf_page, low_key, high_key, low_inclusive, high_inclusive, &begin, &end);
+    if (begin < end) {
+      leaf_page->RemoveRange(begin, end);
+      removed += end - begin;
+    }
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    this->buffer_pool_manager_->UnpinPage(leaf_page_id, begin < end);
+    // once leaf_page is folded into the pending leaf, that one stays pending
+    if (pending_page_id == INVALID_PAGE_ID || !this->RebalanceRangeLeaf(pending_page_id, false, transaction)) {
+      pending_page_id = begin < end ? leaf_page_id : INVALID_PAGE_ID;
+    }
+    // the range ends in this leaf unless it reached its last entry
+    bool done = end < size || next_page_id == INVALID_PAGE_ID;
+    page = done ? nullptr : this->buffer_pool_manager_->FetchPage(next_page_id);
+  }
+  if (pending_page_id != INVALID_PAGE_ID) {
+    this->RebalanceRangeLeaf(pending_page_id, true, transaction);
+  }
+  return removed;
+}
+
+/*
+ * Merge or refill a leaf left under-full by RemoveRangeByLeaf(). An empty leaf that
+ * absorbed an empty right sibling is still empty, with until_filled it goes on
+ * with the sibling after that one.
+ * @return: whether the leaf is still there and absorbed its right sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RebalanceRangeLeaf(page_id_t leaf_page_id, bool until_filled, Transaction *transaction) {
+  LeafPage *leaf_page =
+      reinterpret_cast<LeafPage *>(this->buffer_pool_manager_->FetchPage(leaf_page_id)->GetData());
+  page_id_t next_page_id = leaf_page->GetNextPageId();
+  bool should_delete = false;
+  bool dirty = false;
+  while (!should_delete && this->NeedsRebalance(leaf_page)) {
+    page_id_t sibling_page_id = leaf_page->GetNextPageId();
+    should_delete = this->CoalesceOrRedistribute(leaf_page, transaction);
+    dirty = true;
+    if (!until_filled || leaf_page->GetSize() > 0 || leaf_page->GetNextPageId() == sibling_page_id) {
+      break;
+    }
+  }
+  bool absorbed = !should_delete && leaf_page->GetNextPageId() != next_page_id;
+  this->buffer_pool_manager_->UnpinPage(leaf_page_id, dirty);
+  if (should_delete) {
+    this->DeleteTreePage(leaf_page_id);
+  }
+  return absorbed;
+}
+
+/*
+ * Rebalance the tree after an entry was removed from leaf_page, if any, then
+ * unpin (and delete) leaf_page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FinishRemove(LeafPage *leaf_page, bool removed, Transaction *transaction) {
+  page_id_t leaf_page_id = leaf_page->GetPageId();
+  bool should_delete = false;
+  // underflow happends
+  if (removed && this->NeedsRebalance(leaf_page)) {
+    should_delete = CoalesceOrRedistribute(leaf_page, transaction);
+  }
+  this->buffer_pool_manager_->UnpinPage(leaf_page_id, removed);
+  if (should_delete) {
+    this->DeleteTreePage(leaf_page_id);
+  }
+}
+
+/*
+ * Whether node must be merged or refilled after losing an entry: below half
+ * full, or lazily only once nearly empty. Even lazily, leaves are never left
+ * empty and internal pages never left with a single child, which has no
+ * sibling to merge with.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::NeedsRebalance(N *node) const {
+  if (!this->lazy_merge_) {
+    return node->IsUnderfull();
+  }
+  return node->GetSize() < (node->IsLeafPage() ? 1 : 2) || node->IsUnderfull(LAZY_MERGE_FRACTION);
+}
+
+/*
+ * Walk the leaf chain and merge or refill every leaf below half full, and the
+ * internal pages that get below half full on the way, like eager deletes
+ * would have. The tree latch is taken for one leaf at a time, so that other
+ * operations run in between: the walk goes on from the leaf holding the first
+ * key of the next leaf, found from the root again.
+ * @return: the number of leaves that were rebalanced
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  int rebalanced = 0;
+  bool first_leaf = true;
+  KeyType next_key;
+  while (true) {
+    this->rwlatch_.WLock();
+    Page *page = this->IsEmpty() ? nullptr : this->FindLeafPage(next_key, first_leaf);
+    if (page == nullptr) {
+      this->rwlatch_.WUnlock();
+      break;
+    }
+    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    page_id_t leaf_page_id = leaf_page->GetPageId();
+    bool should_delete = false;
+    bool dirty = !leaf_page->IsRootPage() && leaf_page->IsUnderfull();
+    if (dirty) {
+      bool lazy_merge = this->lazy_merge_;
+      this->lazy_merge_ = false;
+      // a refill moves one entry, and merging two sparse leaves may leave one below half full still: go on until the
+      // leaf is half full, unless it was merged away or fences leave no room to move entries into it
+      int size;
+      do {
+        size = leaf_page->GetSize();
+        should_delete = this->CoalesceOrRedistribute(leaf_page, transaction);
+      } while (!should_delete && !leaf_page->IsRootPage() && leaf_page->IsUnderfull() && leaf_page->GetSize() != size);
+      this->lazy_merge_ = lazy_merge;
+      rebalanced++;
+    }
+    // a merge keeps the next page of leaf_page, or gives it the next page of the sibling it absorbed
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    this->buffer_pool_manager_->UnpinPage(leaf_page_id, dirty);
+    if (should_delete) {
+      this->DeleteTreePage(leaf_page_id);
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      this->rwlatch_.WUnlock();
+      break;
+    }
+    Page *next_page = this->buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      this->rwlatch_.WUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!");
+    }
+    // the leaf holding it is found with the same lookup as inserts, it comes after every leaf walked so far
+    next_key = reinterpret_cast<LeafPage *>(next_page->GetData())->KeyAt(0);
+    this->buffer_pool_manager_->UnpinPage(next_page_id, false);
+    first_leaf = false;
+    this->rwlatch_.WUnlock();
+  }
+  return rebalanced;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartBackgroundCompaction() {
+  if (this->compaction_thread_ != nullptr) {
+    return;
+  }
+  this->enable_compaction_ = true;
+  this->compaction_thread_ = new std::thread(&BPLUSTREE_TYPE::RunBackgroundCompaction, this);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopBackgroundCompaction() {
+  if (this->compaction_thread_ == nullptr) {
+    return;
+  }
+  this->enable_compaction_ = false;
+  this->compaction_thread_->join();
+  delete this->compaction_thread_;
+  this->compaction_thread_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RunBackgroundCompaction() {
+  while (this->enable_compaction_) {
+    std::this_thread::sleep_for(index_compaction_interval);
+    if (this->enable_compaction_) {
+      // a pass that finds no frame for a leaf stops there, the next one starts over
+      try {
+        this->Compact();
+      } catch (Exception &e) {
+        continue;
+      }
+    }
+  }
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * NOTE: input page stays pinned, the caller unpins (and deletes) it
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  // std::cout << "coalesce Or Redistribute: " << node->GetPageId() << std::endl;
   if (node->IsRootPage()) {
     return this->AdjustRoot(node);
   }
@@ -268,51 +1045,48 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
       reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
   int pos = parent_page->ValueIndex(node->GetPageId());
 
-  page_id_t left_subling_id = INVALID_PAGE_ID, right_subling_id = INVALID_PAGE_ID;
-  N *left_subling_page = nullptr, *right_subling_page = nullptr;
+  // prefer the left sibling, the leftmost child has to use its right one
+  page_id_t sibling_page_id = parent_page->ValueAt(pos == 0 ? 1 : pos - 1);
+  N *sibling_page = reinterpret_cast<N *>(this->buffer_pool_manager_->FetchPage(sibling_page_id)->GetData());
 
-  if (pos - 1 >= 0) {
-    left_subling_id = parent_page->ValueAt(pos - 1);
-    left_subling_page = reinterpret_cast<N *>(this->buffer_pool_manager_->FetchPage(left_subling_id)->GetData());
-  }
-  if (pos + 1 < parent_page->GetSize()) {
-    right_subling_id = parent_page->ValueAt(pos + 1);
-    right_subling_page = reinterpret_cast<N *>(this->buffer_pool_manager_->FetchPage(right_subling_id)->GetData());
-  }
-
-  N *to_coalesce_subling_page = nullptr;
-  if (left_subling_page != nullptr) {
-    if (left_subling_page->GetSize() + node->GetSize() > node->GetMaxSize()) {
-      this->Redistribute(left_subling_page, node, 1);
-      this->buffer_pool_manager_->UnpinPage(left_subling_id, true);
-      this->buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-      return false;
-    }
-    to_coalesce_subling_page = left_subling_page;
-  } else if (right_subling_page != nullptr) {
-    if (right_subling_page->GetSize() + node->GetSize() > node->GetMaxSize()) {
-      this->Redistribute(right_subling_page, node, 0);
-      this->buffer_pool_manager_->UnpinPage(right_subling_id, true);
-      this->buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-      return false;
+  // the merged page is bounded by the fences of both pages
+  bool fits = sibling_page->GetSize() + node->GetSize() <= node->GetMaxSize();
+  if (this->prefix_compression_) {
+    N *left = pos == 0 ? node : sibling_page;
+    N *right = pos == 0 ? sibling_page : node;
+    KeyType low_fence = left->GetLowFence();
+    KeyType high_fence;
+    const KeyType *high = right->GetHighFence(&high_fence) ? &high_fence : nullptr;
+    int space = right->GetSpaceWithFences(&low_fence, high);
+    if (!node->IsLeafPage()) {
+      // the separator comes down as the first key of right
+      space += left->GetEntrySpace(parent_page->KeyAt(pos == 0 ? 1 : pos), &low_fence, high);
     }
-    to_coalesce_subling_page = right_subling_page;
+    fits = left->FitsWithFences(&low_fence, high, right->GetSize(), space);
   }
-  if (this->Coalesce(&to_coalesce_subling_page, &node, &parent_page, pos, transaction)) {
-    this->buffer_pool_manager_->DeletePage(parent_page_id);
+  if (!fits) {
+    this->Redistribute(sibling_page, node, pos == 0 ? 0 : 1);
+    this->buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+    this->buffer_pool_manager_->UnpinPage(parent_page_id, true);
+    return false;
   }
-  // coalesce happened, unpin used pages
-  if (to_coalesce_subling_page == left_subling_page) {
-    if (left_subling_id != INVALID_PAGE_ID) {
-      this->buffer_pool_manager_->UnpinPage(left_subling_id, true);
-    }
+
+  // always fold the right page into the left one to keep the leaf chain in order
+  bool delete_parent;
+  if (pos == 0) {
+    delete_parent = this->Coalesce(&node, &sibling_page, &parent_page, 1, transaction);
   } else {
-    if (right_subling_id != INVALID_PAGE_ID) {
-      this->buffer_pool_manager_->UnpinPage(right_subling_id, true);
-    }
+    delete_parent = this->Coalesce(&sibling_page, &node, &parent_page, pos, transaction);
+  }
+  this->buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  if (pos == 0) {
+    this->DeleteTreePage(sibling_page_id);
   }
   this->buffer_pool_manager_->UnpinPage(parent_page_id, true);
-  return true;
+  if (delete_parent) {
+    this->DeleteTreePage(parent_page_id);
+  }
+  return pos != 0;
 }
 
 /*
@@ -321,9 +1095,10 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * @param   neighbor_node      sibling page of input "node", left of it
+ * @param   node               page to be emptied, right of neighbor_node
  * @param   parent             parent page of input "node"
+ * @param   index              position of "node" in parent
  * @return  true means parent node should be deleted, false means no deletion
  * happend
  */
@@ -332,15 +1107,22 @@ template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) {
+  if (this->prefix_compression_) {
+    KeyType low_fence = (*neighbor_node)->GetLowFence();
+    KeyType high_fence;
+    bool bounded = (*node)->GetHighFence(&high_fence);
+    (*neighbor_node)->SetFences(&low_fence, bounded ? &high_fence : nullptr);
+  }
   if ((*node)->IsLeafPage()) {
     LeafPage *n = reinterpret_cast<LeafPage *>(*node), *nn = reinterpret_cast<LeafPage *>(*neighbor_node);
     n->MoveAllTo(nn);
+    this->RelinkPrevPage(nn->GetNextPageId(), nn->GetPageId());
   } else {
     InternalPage *n = reinterpret_cast<InternalPage *>(*node), *nn = reinterpret_cast<InternalPage *>(*neighbor_node);
     n->MoveAllTo(nn, (*parent)->KeyAt(index), this->buffer_pool_manager_);
   }
   (*parent)->Remove(index);
-  if ((*parent)->GetSize() < (*parent)->GetMinSize()) {
+  if (this->NeedsRebalance(*parent)) {
     return CoalesceOrRedistribute(*parent, transaction);
   }
   return false;
@@ -358,37 +1140,83 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  InternalPage *parent_page =
+      reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+  int pos = parent_page->ValueIndex(index == 0 ? neighbor_node->GetPageId() : node->GetPageId());
+
+  // with fences, node gets wider at the new separator and may no longer have room for the moved entry, and the
+  // neighbor and the parent may need more room for their longer fence or separator
+  KeyType separator;
+  KeyType node_low_fence;
+  KeyType node_high_fence;
+  KeyType neighbor_low_fence;
+  KeyType neighbor_high_fence;
+  const KeyType *node_high = &node_high_fence;
+  const KeyType *neighbor_high = &neighbor_high_fence;
+  if (this->prefix_compression_) {
+    int last = neighbor_node->GetSize() - 1;
+    if (node->IsLeafPage()) {
+      separator = index == 0 ? this->ShortestSeparator(neighbor_node->KeyAt(0), neighbor_node->KeyAt(1))
+                             : this->ShortestSeparator(neighbor_node->KeyAt(last - 1), neighbor_node->KeyAt(last));
+    } else {
+      separator = neighbor_node->KeyAt(index == 0 ? 1 : last);
+    }
+    if (index == 0) {
+      node_low_fence = node->GetLowFence();
+      node_high_fence = separator;
+      neighbor_low_fence = separator;
+      neighbor_high = neighbor_node->GetHighFence(&neighbor_high_fence) ? &neighbor_high_fence : nullptr;
+    } else {
+      node_low_fence = separator;
+      node_high = node->GetHighFence(&node_high_fence) ? &node_high_fence : nullptr;
+      neighbor_low_fence = neighbor_node->GetLowFence();
+      neighbor_high_fence = separator;
+    }
+    // internal pages also take the old separator from the parent
+    int space = node->GetEntrySpace(neighbor_node->KeyAt(index == 0 ? 0 : last), &node_low_fence, node_high);
+    if (!node->IsLeafPage()) {
+      space += node->GetEntrySpace(parent_page->KeyAt(pos), &node_low_fence, node_high);
+    }
+    KeyType parent_low_fence = parent_page->GetLowFence();
+    KeyType parent_high_fence;
+    const KeyType *parent_high = parent_page->GetHighFence(&parent_high_fence) ? &parent_high_fence : nullptr;
+    if (!node->FitsWithFences(&node_low_fence, node_high, 1, space) ||
+        !neighbor_node->FitsWithFences(&neighbor_low_fence, neighbor_high, 0, 0) ||
+        !parent_page->FitsWithFences(&parent_low_fence, parent_high, 0,
+                                     parent_page->GetEntrySpace(separator, &parent_low_fence, parent_high))) {
+      // leave node under-full, which only costs space
+      this->buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
+      return;
+    }
+    node->SetFences(&node_low_fence, node_high);
+  }
+
   if (index == 0) {
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(
-        this->buffer_pool_manager_->FetchPage(neighbor_node->GetParentPageId())->GetData());
-    int pos = parent_page->ValueIndex(neighbor_node->GetPageId());
     if (node->IsLeafPage()) {
       reinterpret_cast<LeafPage *>(neighbor_node)->MoveFirstToEndOf(reinterpret_cast<LeafPage *>(node));
-      parent_page->SetKeyAt(pos, reinterpret_cast<LeafPage *>(neighbor_node)->KeyAt(0));
     } else {
       reinterpret_cast<InternalPage *>(neighbor_node)
           ->MoveFirstToEndOf(reinterpret_cast<InternalPage *>(node), parent_page->KeyAt(pos),
                              this->buffer_pool_manager_);
-      parent_page->SetKeyAt(pos, reinterpret_cast<InternalPage *>(neighbor_node)->KeyAt(1));
     }
-    this->buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
   } else {
-    InternalPage *parent_page =
-        reinterpret_cast<InternalPage *>(this->buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-    int pos = parent_page->ValueIndex(node->GetPageId());
     if (node->IsLeafPage()) {
       reinterpret_cast<LeafPage *>(neighbor_node)->MoveLastToFrontOf(reinterpret_cast<LeafPage *>(node));
-      parent_page->SetKeyAt(pos, reinterpret_cast<LeafPage *>(node)->KeyAt(0));
     } else {
       reinterpret_cast<InternalPage *>(neighbor_node)
-          ->MoveLastToFrontOf(reinterpret_cast<InternalPage *>(node),
-                              parent_page->KeyAt(parent_page->ValueIndex(node->GetPageId())),
+          ->MoveLastToFrontOf(reinterpret_cast<InternalPage *>(node), parent_page->KeyAt(pos),
                               this->buffer_pool_manager_);
-      parent_page->SetKeyAt(pos, reinterpret_cast<InternalPage *>(node)->KeyAt(1));
     }
-    this->buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
   }
+  if (this->prefix_compression_) {
+    neighbor_node->SetFences(&neighbor_low_fence, neighbor_high);
+  } else {
+    separator = index == 0 ? neighbor_node->KeyAt(0) : node->KeyAt(0);
+  }
+  parent_page->SetKeyAt(pos, separator);
+  this->buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
 }
+
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -404,20 +1232,167 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
   if (old_root_node->IsLeafPage()) {
     if (old_root_node->GetSize() == 0) {
       this->root_page_id_ = INVALID_PAGE_ID;
-      UpdateRootPageId(0);
+      UpdateRootPageId();
       return true;
     }
     return false;
-  } else {
-    if (old_root_node->GetSize() > 1) {
-      return false;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  page_id_t new_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  this->root_page_id_ = new_page_id;
+  reinterpret_cast<BPlusTreePage *>(this->buffer_pool_manager_->FetchPage(new_page_id)->GetData())
+      ->SetParentPageId(INVALID_PAGE_ID);
+  this->buffer_pool_manager_->UnpinPage(new_page_id, true);
+  UpdateRootPageId();
+  return true;
+}
+
+/*
+ * Shortest key k with left < k <= right, for keys compared byte by byte: the
+ * bytes of right up to the first one that differs from left, then zeros
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::ShortestSeparator(const KeyType &left, const KeyType &right) const {
+  const char *left_data = reinterpret_cast<const char *>(&left);
+  const char *right_data = reinterpret_cast<const char *>(&right);
+  size_t size = 0;
+  while (size < sizeof(KeyType) && left_data[size] == right_data[size]) {
+    size++;
+  }
+  KeyType separator;
+  memset(&separator, 0, sizeof(KeyType));
+  memcpy(&separator, right_data, std::min(size + 1, sizeof(KeyType)));
+  return separator;
+}
+
+/*****************************************************************************
+ * STATISTICS
+ *****************************************************************************/
+/*
+ * Collect the size and key distribution of the tree, from every leaf when
+ * sample_leaves is 0, else from sample_leaves descents that pick a child at
+ * random on every level. A descent reaches a leaf with probability one over
+ * the product of the fanouts on its path, so that product times what the leaf
+ * holds is an unbiased estimate of the totals (Knuth's estimator). The
+ * histogram cuts the keys into num_buckets buckets of about as many entries.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetStatistics(size_t sample_leaves, size_t num_buckets, BPlusTreeStatistics<KeyType> *stats) {
+  this->rwlatch_.RLock();
+  *stats = BPlusTreeStatistics<KeyType>();
+  page_id_t page_id = this->root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = this->FetchTreePage(page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    stats->height_++;
+    page_id = node->IsLeafPage() ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+    this->UnpinTreePage(page);
+  }
+  if (stats->height_ == 0) {
+    this->rwlatch_.RUnlock();
+    return;
+  }
+
+  if (sample_leaves == 0) {
+    double fill = 0;
+    KeyType previous;
+    Page *page = this->FindLeafPage(KeyType(), true);
+    while (page != nullptr) {
+      LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+      stats->num_leaves_++;
+      stats->num_entries_ += leaf_page->GetSize();
+      fill += leaf_page->GetFillFactor();
+      for (int i = 0; i < leaf_page->GetSize(); i++) {
+        KeyType key = leaf_page->KeyAt(i);
+        if (stats->distinct_keys_ == 0 || this->comparator_(previous, key) != 0) {
+          stats->distinct_keys_++;
+        }
+        previous = key;
+      }
+      page_id_t next_page_id = leaf_page->GetNextPageId();
+      this->UnpinTreePage(page);
+      page = next_page_id == INVALID_PAGE_ID ? nullptr : this->buffer_pool_manager_->FetchPage(next_page_id);
+    }
+    stats->avg_leaf_fill_ = fill / stats->num_leaves_;
+
+    // a second walk cuts the buckets, now that the number of entries is known
+    auto num_entries = static_cast<size_t>(stats->num_entries_);
+    num_buckets = std::min(num_buckets, num_entries);
+    size_t position = 0;
+    page = num_buckets == 0 ? nullptr : this->FindLeafPage(KeyType(), true);
+    while (page != nullptr) {
+      LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+      for (int i = 0; i < leaf_page->GetSize(); i++) {
+        if (position == 0) {
+          stats->bucket_bounds_.push_back(leaf_page->KeyAt(i));
+        }
+        position++;
+        if (position == (stats->bucket_depths_.size() + 1) * num_entries / num_buckets) {
+          stats->bucket_bounds_.push_back(leaf_page->KeyAt(i));
+          stats->bucket_depths_.push_back(static_cast<double>(position));
+        }
+      }
+      page_id_t next_page_id = leaf_page->GetNextPageId();
+      this->UnpinTreePage(page);
+      page = next_page_id == INVALID_PAGE_ID ? nullptr : this->buffer_pool_manager_->FetchPage(next_page_id);
+    }
+    this->rwlatch_.RUnlock();
+    return;
+  }
+
+  // the entries of the sampled leaves, weighted by the product of the fanouts above them
+  std::vector<std::pair<KeyType, double>> keys;
+  double fill = 0;
+  std::random_device seed;
+  std::mt19937 rng(seed());
+  for (size_t sample = 0; sample < sample_leaves; sample++) {
+    double weight = 1;
+    Page *page = this->FetchTreePage(this->root_page_id_);
+    while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      InternalPage *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+      weight *= internal_page->GetSize();
+      page_id_t child_page_id = internal_page->ValueAt(static_cast<int>(rng() % internal_page->GetSize()));
+      this->UnpinTreePage(page);
+      page = this->FetchTreePage(child_page_id);
+    }
+    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    stats->num_leaves_ += weight;
+    stats->num_entries_ += weight * leaf_page->GetSize();
+    fill += weight * leaf_page->GetFillFactor();
+    for (int i = 0; i < leaf_page->GetSize(); i++) {
+      keys.emplace_back(leaf_page->KeyAt(i), weight);
+      if (i == 0 || this->comparator_(keys[keys.size() - 2].first, keys.back().first) != 0) {
+        stats->distinct_keys_ += weight;
+      }
+    }
+    this->UnpinTreePage(page);
+  }
+  this->rwlatch_.RUnlock();
+  stats->avg_leaf_fill_ = fill / stats->num_leaves_;
+  stats->num_leaves_ /= sample_leaves;
+  stats->num_entries_ /= sample_leaves;
+  stats->distinct_keys_ /= sample_leaves;
+
+  if (num_buckets == 0 || keys.empty()) {
+    return;
+  }
+  std::sort(keys.begin(), keys.end(), [&](const std::pair<KeyType, double> &a, const std::pair<KeyType, double> &b) {
+    return this->comparator_(a.first, b.first) < 0;
+  });
+  double total = 0;
+  for (auto &key : keys) {
+    total += key.second;
+  }
+  stats->bucket_bounds_.push_back(keys[0].first);
+  double depth = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    depth += keys[i].second;
+    if (i + 1 == keys.size() || depth >= (stats->bucket_depths_.size() + 1) * total / num_buckets) {
+      stats->bucket_bounds_.push_back(keys[i].first);
+      stats->bucket_depths_.push_back(depth / sample_leaves);
     }
-    page_id_t new_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
-    this->root_page_id_ = new_page_id;
-    reinterpret_cast<BPlusTreePage *>(this->buffer_pool_manager_->FetchPage(new_page_id))
-        ->SetParentPageId(INVALID_PAGE_ID);
-    UpdateRootPageId(0);
-    return true;
   }
 }
 
@@ -431,7 +1406,8 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
-  return INDEXITERATOR_TYPE(this->FindLeafPage(KeyType(), true), 0, this->buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(this->FindLeafPage(KeyType(), true), 0, this->buffer_pool_manager_, false,
+                            this->prefetch_leaves_);
 }
 
 /*
@@ -441,9 +1417,23 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  Page *page = this->FindLeafPage(key, false);
-  int k = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, this->comparator_);
-  return INDEXITERATOR_TYPE(page, k, this->buffer_pool_manager_);
+  Page *page = this->FindFirstLeafPage(key);
+  if (page == nullptr) {
+    return this->end();
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int k = leaf->KeyIndex(key, this->comparator_);
+  // every key in this leaf is smaller, start from the next one
+  if (k == leaf->GetSize()) {
+    page_id_t next_page_id = leaf->GetNextPageId();
+    this->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      return this->end();
+    }
+    return INDEXITERATOR_TYPE(this->buffer_pool_manager_->FetchPage(next_page_id), 0, this->buffer_pool_manager_,
+                              false, this->prefetch_leaves_);
+  }
+  return INDEXITERATOR_TYPE(page, k, this->buffer_pool_manager_, false, this->prefetch_leaves_);
 }
 
 /*
@@ -454,61 +1444,302 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(nullptr, 0, this->buffer_pool_manager_); }
 
+/*
+ * Input parameter is void, find the rightmost leaf page first, then construct
+ * a reverse index iterator at its last entry
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::rbegin() {
+  Page *page = this->FindLastLeafPage();
+  if (page == nullptr) {
+    return this->end();
+  }
+  int k = reinterpret_cast<LeafPage *>(page->GetData())->GetSize() - 1;
+  return INDEXITERATOR_TYPE(page, k, this->buffer_pool_manager_, true, this->prefetch_leaves_);
+}
+
+/*
+ * Input parameter is high key, find the rightmost leaf page that may contain
+ * the input key first, then construct a reverse index iterator at the last
+ * entry whose key is <= key
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  Page *page = this->FindLeafPage(key, false);
+  if (page == nullptr) {
+    return this->end();
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int k = leaf->KeyIndex(key, this->comparator_);
+  while (k < leaf->GetSize() && this->comparator_(leaf->KeyAt(k), key) == 0) {
+    k++;
+  }
+  // every key in this leaf is larger, start from the previous one
+  if (k == 0) {
+    page_id_t prev_page_id = leaf->GetPrevPageId();
+    this->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (prev_page_id == INVALID_PAGE_ID) {
+      return this->end();
+    }
+    page = this->buffer_pool_manager_->FetchPage(prev_page_id);
+    k = reinterpret_cast<LeafPage *>(page->GetData())->GetSize();
+  }
+  return INDEXITERATOR_TYPE(page, k - 1, this->buffer_pool_manager_, true, this->prefetch_leaves_);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * NOTE: the returned page is pinned, the caller is responsible for unpinning
+ * it. Returns nullptr only when the tree is empty.
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
   page_id_t curr_page_id = this->root_page_id_;
   while (curr_page_id != INVALID_PAGE_ID) {
-    Page *curr_page = this->buffer_pool_manager_->FetchPage(curr_page_id);
+    Page *curr_page = this->FetchTreePage(curr_page_id);
     if (reinterpret_cast<BPlusTreePage *>(curr_page->GetData())->IsLeafPage()) {
-      if (leftMost) {
-        return curr_page;
-      } else {
-        ValueType val;
-        if (reinterpret_cast<LeafPage *>(curr_page->GetData())->Lookup(key, &val, this->comparator_)) {
-          return curr_page;
-        } else {
-          return nullptr;
-        }
-      }
+      return curr_page;
+    }
+    if (leftMost) {
+      curr_page_id = reinterpret_cast<InternalPage *>(curr_page->GetData())->ValueAt(0);
     } else {
-      if (leftMost) {
-        curr_page_id = reinterpret_cast<InternalPage *>(curr_page->GetData())->ValueAt(0);
-      } else {
-        curr_page_id = reinterpret_cast<InternalPage *>(curr_page->GetData())->Lookup(key, this->comparator_);
-      }
-      this->rwlatch_.RUnlock();
-      this->buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+      curr_page_id = reinterpret_cast<InternalPage *>(curr_page->GetData())->Lookup(key, this->comparator_);
     }
+    this->UnpinTreePage(curr_page);
   }
   return nullptr;
 }
 
 /*
- * Update/Insert root page id in header page(where page_id = 0, header_page is
- * defined under include/page/header_page.h)
- * Call this method everytime root page id is changed.
- * @parameter: insert_record      defualt value is false. When set to true,
- * insert a record <index_name, root_page_id> into header page instead of
- * updating it.
+ * Find the leftmost leaf page that may contain particular key: duplicates of
+ * a separator may also end the leaf left of it
+ * NOTE: the returned page is pinned, the caller is responsible for unpinning
+ * it. Returns nullptr only when the tree is empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindFirstLeafPage(const KeyType &key) {
+  page_id_t curr_page_id = this->root_page_id_;
+  while (curr_page_id != INVALID_PAGE_ID) {
+    Page *curr_page = this->FetchTreePage(curr_page_id);
+    if (reinterpret_cast<BPlusTreePage *>(curr_page->GetData())->IsLeafPage()) {
+      return curr_page;
+    }
+    curr_page_id = reinterpret_cast<InternalPage *>(curr_page->GetData())->LookupFirst(key, this->comparator_);
+    this->UnpinTreePage(curr_page);
+  }
+  return nullptr;
+}
+
+/*
+ * Find the rightmost leaf page, the one with the largest keys
+ * NOTE: the returned page is pinned, the caller is responsible for unpinning
+ * it. Returns nullptr only when the tree is empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLastLeafPage() {
+  page_id_t curr_page_id = this->root_page_id_;
+  while (curr_page_id != INVALID_PAGE_ID) {
+    Page *curr_page = this->FetchTreePage(curr_page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+    if (node->IsLeafPage()) {
+      return curr_page;
+    }
+    curr_page_id = reinterpret_cast<InternalPage *>(node)->ValueAt(node->GetSize() - 1);
+    this->UnpinTreePage(curr_page);
+  }
+  return nullptr;
+}
+
+/*
+ * Append the values of the duplicates of key, starting in leaf (the leftmost
+ * leaf that may hold key) and following the leaf chain while the leaves end
+ * with keys <= key
+ * NOTE: leaf stays pinned, the leaves right of it are unpinned here
+ * @return false if a leaf could not be fetched, result then only holds the
+ * values before it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CollectDuplicates(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result) {
+  LeafPage *first_leaf = leaf;
+  int index = leaf->KeyIndex(key, this->comparator_);
+  while (true) {
+    for (; index < leaf->GetSize(); index++) {
+      MappingType item = leaf->GetItem(index);
+      if (this->comparator_(item.first, key) != 0) {
+        break;
+      }
+      result->push_back(item.second);
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    bool done = index < leaf->GetSize() || next_page_id == INVALID_PAGE_ID;
+    if (leaf != first_leaf) {
+      this->buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    }
+    if (done) {
+      return true;
+    }
+    Page *next_page = this->buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      return false;
+    }
+    leaf = reinterpret_cast<LeafPage *>(next_page->GetData());
+    index = 0;
+  }
+}
+
+/*
+ * Point the previous leaf link of leaf page_id at prev_page_id, after a split
+ * or a merge changed the leaf on its left. Does nothing for INVALID_PAGE_ID,
+ * the rightmost leaf has no page on its right to update.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RelinkPrevPage(page_id_t page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *page = this->buffer_pool_manager_->FetchPage(page_id);
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_page_id);
+  this->buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+/*
+ * Call this method everytime root page id is changed. The record of the tree
+ * in the header page (where page_id = 0, header_page is defined under
+ * include/page/header_page.h) is written right away, unless root writes are
+ * deferred to FlushRootPageId().
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UpdateRootPageId() {
+  this->root_page_id_dirty_ = true;
+  if (!this->defer_root_write_) {
+    this->WriteRootPageId();
+  }
+  // the pinned levels hang off the root
+  this->PinTopLevels();
+}
+
+/*
+ * Insert a record <index_name, root_page_id> into the header page the first
+ * time, update it afterwards.
+ * @return false if the header page could not be fetched, the record is then
+ * left as it was and written by the next call
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
+bool BPLUSTREE_TYPE::WriteRootPageId() {
+  auto *header_page = static_cast<HeaderPage *>(this->buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (header_page == nullptr) {
+    return false;
+  }
+  if (!this->root_record_inserted_) {
+    header_page->InsertRecord(this->index_name_, this->root_page_id_);
+    this->root_record_inserted_ = true;
   } else {
-    // update root_page_id in header_page
-    header_page->UpdateRecord(index_name_, root_page_id_);
+    header_page->UpdateRecord(this->index_name_, this->root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  this->buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  this->root_page_id_dirty_ = false;
+  return true;
+}
+
+/*
+ * Write the record of the tree in the header page if the root changed since
+ * it was last written.
+ * @return false if the header page could not be fetched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FlushRootPageId() {
+  this->rwlatch_.WLock();
+  bool flushed = !this->root_page_id_dirty_ || this->WriteRootPageId();
+  this->rwlatch_.WUnlock();
+  return flushed;
+}
+
+/*
+ * Keep the internal pages of the top pinned_levels levels pinned, so that
+ * descents find them in pinned_pages_ instead of going through the buffer
+ * pool. Called whenever the root changes; splits of pinned pages pin the new
+ * page, and pinned pages are released before they are deleted.
+ * Stops early if the buffer pool runs out of frames.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PinTopLevels() {
+  this->ReleasePinnedPages();
+  std::vector<page_id_t> level;
+  if (this->root_page_id_ != INVALID_PAGE_ID) {
+    level.push_back(this->root_page_id_);
+  }
+  for (int depth = 0; depth < this->pinned_levels_ && !level.empty(); depth++) {
+    std::vector<page_id_t> next_level;
+    for (page_id_t page_id : level) {
+      Page *page = this->buffer_pool_manager_->FetchPage(page_id);
+      if (page == nullptr) {
+        return;
+      }
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      // leaves are handed out to iterators, which unpin them, so they are never kept
+      if (node->IsLeafPage()) {
+        this->buffer_pool_manager_->UnpinPage(page_id, false);
+        continue;
+      }
+      this->pinned_pages_[page_id] = page;
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < internal->GetSize(); i++) {
+        next_level.push_back(internal->ValueAt(i));
+      }
+    }
+    level = std::move(next_level);
+  }
+}
+
+/*
+ * Unpin every pinned page of the top levels
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePinnedPages() {
+  for (auto &entry : this->pinned_pages_) {
+    this->buffer_pool_manager_->UnpinPage(entry.first, false);
+  }
+  this->pinned_pages_.clear();
+}
+
+/*
+ * Fetch a page for a descent, pinned pages of the top levels come straight
+ * from pinned_pages_ without touching the buffer pool
+ * NOTE: release the page with UnpinTreePage
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id) {
+  auto pinned = this->pinned_pages_.find(page_id);
+  if (pinned != this->pinned_pages_.end()) {
+    return pinned->second;
+  }
+  return this->buffer_pool_manager_->FetchPage(page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UnpinTreePage(Page *page) {
+  if (this->pinned_pages_.count(page->GetPageId()) == 0) {
+    this->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*
+ * Delete a page of the tree, releasing it first if it is pinned
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeleteTreePage(page_id_t page_id) {
+  auto pinned = this->pinned_pages_.find(page_id);
+  if (pinned != this->pinned_pages_.end()) {
+    this->buffer_pool_manager_->UnpinPage(page_id, false);
+    this->pinned_pages_.erase(pinned);
+  }
+  this->buffer_pool_manager_->DeletePage(page_id);
 }
 
 /*
@@ -675,4 +1906,12 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTree<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+template class BPlusTree<NormalizedKey<256>, RID, NormalizedComparator<256>>;
+
 }  // namespace bustub
@@ -9,7 +9,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 /*
@@ -19,14 +27,45 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      // compressed pages hold variable-length keys, bounded by what fits rather than a number of entries
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                 metadata->GetOptions().prefix_compression_ ? PAGE_SIZE : LEAF_PAGE_SIZE,
+                 metadata->GetOptions().prefix_compression_ ? PAGE_SIZE : INTERNAL_PAGE_SIZE,
+                 metadata->GetOptions().prefix_compression_, metadata->IsUnique(),
+                 metadata->GetOptions().pinned_levels_, metadata->GetOptions().lazy_merge_,
+                 metadata->GetOptions().defer_root_write_),
+      buffer_pool_manager_(buffer_pool_manager) {
+  if (metadata->GetOptions().prefix_compression_ && !IsBytewiseComparator<KeyComparator>::value) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Prefix compression needs normalized keys.");
+  }
+  // generic keys keep the entry tuple as is, the comparator only reads the key columns at its front, so the
+  // INCLUDE columns ride along in the key bytes, normalized keys only hold the encoded key columns
+  Schema *entry_schema = metadata->GetEntrySchema();
+  this->index_only_scan_ = !IsBytewiseComparator<KeyComparator>::value && entry_schema->IsInlined() &&
+                           entry_schema->GetLength() <= sizeof(KeyType);
+  if (!metadata->GetIncludeAttrs().empty() && !this->index_only_scan_) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "INCLUDE columns need a generic key that holds the whole entry.");
+  }
+  if (metadata->GetOptions().background_compaction_) {
+    this->container_.StartBackgroundCompaction();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_INDEX_TYPE::~BPlusTreeIndex() {
+  // a compaction after the flush could still move the root
+  this->container_.StopBackgroundCompaction();
+  // the tree only writes its root page id to the header page when asked to
+  this->container_.FlushRootPageId();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
+  this->AddEntryToBloomFilter(key);
   container_.Insert(index_key, rid, transaction);
 }
 
@@ -34,26 +73,230 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
+  this->NoteBloomFilterDelete();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (!this->MayContainKey(key)) {
+    return;
+  }
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                                    Transaction *transaction) {
+  // construct scan index keys of the keys the Bloom filter may hold, the tree probes them in one pass
+  std::vector<size_t> probed;
+  std::vector<KeyType> index_keys;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (this->MayContainKey(keys[i])) {
+      probed.push_back(i);
+      index_keys.emplace_back();
+      index_keys.back().SetFromKey(keys[i], GetKeySchema());
+    }
+  }
+
+  std::vector<std::vector<RID>> probed_result;
+  container_.GetValues(index_keys, &probed_result, transaction);
+  result->assign(keys.size(), std::vector<RID>());
+  for (size_t i = 0; i < probed.size(); i++) {
+    (*result)[probed[i]] = std::move(probed_result[i]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low_key, const Tuple *high_key, bool low_inclusive,
+                                     bool high_inclusive, bool descending, size_t limit, std::vector<RID> *result,
+                                     Transaction *transaction) {
+  // construct scan index keys
+  KeyType low_index_key;
+  KeyType high_index_key;
+  if (low_key != nullptr) {
+    low_index_key.SetFromKey(*low_key, GetKeySchema());
+  }
+  if (high_key != nullptr) {
+    high_index_key.SetFromKey(*high_key, GetKeySchema());
+  }
+
+  container_.GetRange(low_key == nullptr ? nullptr : &low_index_key, high_key == nullptr ? nullptr : &high_index_key,
+                      low_inclusive, high_inclusive, descending, limit, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRangeEntries(const Tuple *low_key, const Tuple *high_key, bool low_inclusive,
+                                            bool high_inclusive, bool descending, size_t limit,
+                                            std::vector<Tuple> *entries, std::vector<RID> *result,
+                                            Transaction *transaction) {
+  if constexpr (IsBytewiseComparator<KeyComparator>::value) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Normalized keys cannot be decoded into entries.");
+  } else {
+    KeyType low_index_key;
+    KeyType high_index_key;
+    if (low_key != nullptr) {
+      low_index_key.SetFromKey(*low_key, GetKeySchema());
+    }
+    if (high_key != nullptr) {
+      high_index_key.SetFromKey(*high_key, GetKeySchema());
+    }
+    std::vector<KeyType> index_keys;
+    container_.GetRange(low_key == nullptr ? nullptr : &low_index_key,
+                        high_key == nullptr ? nullptr : &high_index_key, low_inclusive, high_inclusive, descending,
+                        limit, result, transaction, &index_keys);
+
+    // the key bytes are the serialized entry tuple
+    Schema *entry_schema = GetEntrySchema();
+    std::vector<Value> values;
+    for (auto &index_key : index_keys) {
+      values.clear();
+      for (uint32_t i = 0; i < entry_schema->GetColumnCount(); i++) {
+        values.push_back(index_key.ToValue(entry_schema, i));
+      }
+      entries->emplace_back(values, entry_schema);
+    }
+  }
+}
+
+/*
+ * The histogram bounds are the first column of the keys, only keys that store
+ * the serialized tuple can be decoded into it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::ComputeStatistics(size_t sample_leaves, size_t num_buckets, IndexStatistics *stats,
+                                             Transaction *transaction) {
+  BPlusTreeStatistics<KeyType> tree_stats;
+  container_.GetStatistics(sample_leaves, IsBytewiseComparator<KeyComparator>::value ? 0 : num_buckets, &tree_stats);
+  *stats = IndexStatistics();
+  stats->num_entries_ = static_cast<size_t>(tree_stats.num_entries_ + 0.5);
+  stats->num_leaves_ = static_cast<size_t>(tree_stats.num_leaves_ + 0.5);
+  stats->height_ = tree_stats.height_;
+  stats->avg_leaf_fill_ = tree_stats.avg_leaf_fill_;
+  stats->distinct_keys_ = static_cast<size_t>(tree_stats.distinct_keys_ + 0.5);
+  if constexpr (!IsBytewiseComparator<KeyComparator>::value) {
+    for (auto &bound : tree_stats.bucket_bounds_) {
+      stats->histogram_bounds_.push_back(bound.ToValue(GetKeySchema(), 0));
+    }
+    stats->histogram_depths_ = tree_stats.bucket_depths_;
+  }
+  return true;
+}
+
+/*
+ * Fill the index with the tuples of a table, e.g. when it is created on a
+ * table that already has data. The threads take the table pages one at a time
+ * and sort the (key, RID) pairs of their pages into runs, the runs are merged
+ * and the tree is built bottom up from the sorted entries.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BuildFromTable(TableHeap *table_heap, const Schema &schema, size_t num_threads,
+                                          Transaction *transaction) {
+  auto less = [&](const MappingType &a, const MappingType &b) {
+    int cmp = comparator_(a.first, b.first);
+    return cmp < 0 || (cmp == 0 && a.second.Get() < b.second.Get());
+  };
+  // the table pages are chained, the next page to scan is handed out under a latch. The first error of a thread,
+  // e.g. no frame for its page, stops the scan on every thread and is thrown once they are joined.
+  std::mutex cursor_latch;
+  page_id_t next_page_id = table_heap->GetFirstPageId();
+  std::exception_ptr error;
+  std::vector<std::vector<MappingType>> runs(std::max<size_t>(num_threads, 1));
+  auto scan = [&](std::vector<MappingType> *run) {
+    while (true) {
+      TablePage *page;
+      {
+        std::lock_guard<std::mutex> guard(cursor_latch);
+        if (next_page_id == INVALID_PAGE_ID || error != nullptr) {
+          break;
+        }
+        page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+        if (page == nullptr) {
+          error = std::make_exception_ptr(Exception(ExceptionType::OUT_OF_MEMORY, "out of memory!"));
+          break;
+        }
+        page->RLatch();
+        next_page_id = page->GetNextPageId();
+      }
+      try {
+        RID rid;
+        bool found = page->GetFirstTupleRid(&rid);
+        while (found) {
+          Tuple tuple;
+          if (page->GetTuple(rid, &tuple, transaction, nullptr)) {
+            KeyType index_key;
+            index_key.SetFromKey(tuple.KeyFromTuple(schema, *GetEntrySchema(), GetEntryAttrs()), GetKeySchema());
+            run->emplace_back(index_key, rid);
+          }
+          RID next_rid;
+          found = page->GetNextTupleRid(rid, &next_rid);
+          rid = next_rid;
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(cursor_latch);
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    }
+    std::sort(run->begin(), run->end(), less);
+  };
+  std::vector<std::thread> threads;
+  for (auto &run : runs) {
+    threads.emplace_back(scan, &run);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+
+  // merge the runs pairwise, each entry is moved once per round, and there are log2(runs) rounds
+  while (runs.size() > 1) {
+    std::vector<std::vector<MappingType>> merged((runs.size() + 1) / 2);
+    for (size_t i = 0; i + 1 < runs.size(); i += 2) {
+      merged[i / 2].reserve(runs[i].size() + runs[i + 1].size());
+      std::merge(runs[i].begin(), runs[i].end(), runs[i + 1].begin(), runs[i + 1].end(),
+                 std::back_inserter(merged[i / 2]), less);
+    }
+    if (runs.size() % 2 == 1) {
+      merged.back() = std::move(runs.back());
+    }
+    runs = std::move(merged);
+  }
+  std::vector<MappingType> entries = std::move(runs[0]);
+  // the tree would keep the first of equal keys only, the table does not fit a unique index
+  if (GetMetadata()->IsUnique()) {
+    for (size_t i = 1; i < entries.size(); i++) {
+      if (comparator_(entries[i - 1].first, entries[i].first) == 0) {
+        throw Exception("Duplicate key in the table of unique index " + GetName() + ".");
+      }
+    }
+  }
+  container_.BulkLoad(entries, transaction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) { return container_.Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() { return container_.rbegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) { return container_.RBegin(key); }
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
@@ -63,4 +306,12 @@ template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTreeIndex<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+template class BPlusTreeIndex<NormalizedKey<256>, RID, NormalizedComparator<256>>;
+
 }  // namespace bustub
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/storage/index/bloom_filter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "storage/index/bloom_filter.h"
+
+namespace bustub {
+
+BloomFilter::BloomFilter(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)),
+      num_blocks_((this->capacity_ * BLOOM_FILTER_BITS_PER_KEY - 1) / BITS_PER_BLOCK + 1),
+      words_(this->num_blocks_ * WORDS_PER_BLOCK) {}
+
+void BloomFilter::Probe(hash_t hash, size_t *words, uint64_t *masks) const {
+  // the block comes from the high half of the hash, the bits within it from the low half, bit i at low + i * step
+  size_t block = static_cast<size_t>((hash >> 32) * this->num_blocks_ >> 32) * WORDS_PER_BLOCK;
+  auto bit = static_cast<uint32_t>(hash);
+  uint32_t step = (bit >> 17 | bit << 15) | 1;
+  for (int i = 0; i < BLOOM_FILTER_NUM_PROBES; i++, bit += step) {
+    words[i] = block + bit % BITS_PER_BLOCK / 64;
+    masks[i] = static_cast<uint64_t>(1) << (bit % 64);
+  }
+}
+
+void BloomFilter::Insert(hash_t hash) {
+  size_t words[BLOOM_FILTER_NUM_PROBES];
+  uint64_t masks[BLOOM_FILTER_NUM_PROBES];
+  this->Probe(hash, words, masks);
+  for (int i = 0; i < BLOOM_FILTER_NUM_PROBES; i++) {
+    this->words_[words[i]].fetch_or(masks[i], std::memory_order_relaxed);
+  }
+  this->num_keys_++;
+}
+
+bool BloomFilter::MayContain(hash_t hash) const {
+  size_t words[BLOOM_FILTER_NUM_PROBES];
+  uint64_t masks[BLOOM_FILTER_NUM_PROBES];
+  this->Probe(hash, words, masks);
+  for (int i = 0; i < BLOOM_FILTER_NUM_PROBES; i++) {
+    if ((this->words_[words[i]].load(std::memory_order_relaxed) & masks[i]) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t BloomFilter::GetSerializedSize() const {
+  return static_cast<uint32_t>(2 * sizeof(uint64_t) + this->words_.size() * sizeof(uint64_t));
+}
+
+void BloomFilter::SerializeTo(char *storage) const {
+  uint64_t header[2] = {this->capacity_, this->num_keys_};
+  memcpy(storage, header, sizeof(header));
+  storage += sizeof(header);
+  for (const auto &word : this->words_) {
+    uint64_t bits = word.load(std::memory_order_relaxed);
+    memcpy(storage, &bits, sizeof(uint64_t));
+    storage += sizeof(uint64_t);
+  }
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::DeserializeFrom(const char *storage) {
+  uint64_t header[2];
+  memcpy(header, storage, sizeof(header));
+  storage += sizeof(header);
+  auto filter = std::make_unique<BloomFilter>(header[0]);
+  filter->num_keys_ = header[1];
+  for (auto &word : filter->words_) {
+    uint64_t bits;
+    memcpy(&bits, storage, sizeof(uint64_t));
+    word.store(bits, std::memory_order_relaxed);
+    storage += sizeof(uint64_t);
+  }
+  return filter;
+}
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_bloom_filter.cpp
+//
+// Identification: src/storage/index/index_bloom_filter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <utility>
+
+#include "storage/index/index_bloom_filter.h"
+
+namespace bustub {
+
+void IndexBloomFilter::BeginBuild(size_t expected_keys) {
+  size_t capacity = std::max<size_t>(2 * expected_keys, BLOOM_FILTER_MIN_KEYS);
+  std::atomic_store(&this->building_, std::make_shared<BloomFilter>(capacity));
+}
+
+void IndexBloomFilter::AddToBuild(const Tuple &key, const Schema *schema) {
+  std::atomic_load(&this->building_)->Insert(this->Hash(key, schema));
+}
+
+void IndexBloomFilter::FinishBuild() {
+  this->Set(std::atomic_load(&this->building_));
+  std::atomic_store(&this->building_, std::shared_ptr<BloomFilter>());
+}
+
+void IndexBloomFilter::Set(std::shared_ptr<BloomFilter> filter) {
+  std::atomic_store(&this->filter_, std::move(filter));
+  this->num_deletes_ = 0;
+}
+
+bool IndexBloomFilter::NeedsRebuild() const {
+  auto filter = std::atomic_load(&this->filter_);
+  return filter != nullptr &&
+         (2 * this->num_deletes_ > filter->GetNumKeys() || filter->GetNumKeys() > filter->GetCapacity());
+}
+
+size_t IndexBloomFilter::GetNumLiveKeys() const {
+  auto filter = std::atomic_load(&this->filter_);
+  size_t num_deletes = this->num_deletes_;
+  return filter == nullptr || filter->GetNumKeys() < num_deletes ? 0 : filter->GetNumKeys() - num_deletes;
+}
+
+bool IndexBloomFilter::MayContain(const Tuple &key, const Schema *schema) const {
+  auto filter = std::atomic_load(&this->filter_);
+  return filter == nullptr || filter->MayContain(this->Hash(key, schema));
+}
+
+void IndexBloomFilter::Add(const Tuple &entry, const Schema *schema) {
+  // the filter being built is loaded first, so a key either reaches it or the filter that replaced it
+  auto building = std::atomic_load(&this->building_);
+  auto filter = std::atomic_load(&this->filter_);
+  if (filter == nullptr && building == nullptr) {
+    return;
+  }
+  hash_t hash = this->Hash(entry, schema);
+  if (filter != nullptr) {
+    filter->Insert(hash);
+  }
+  if (building != nullptr) {
+    building->Insert(hash);
+  }
+}
+
+hash_t IndexBloomFilter::Hash(const Tuple &tuple, const Schema *schema) const {
+  hash_t hash = 0;
+  for (uint32_t i = 0; i < this->num_key_columns_; i++) {
+    Value value = tuple.GetValue(schema, i);
+    hash = HashUtil::CombineHashes(hash, value.IsNull() ? 0 : HashUtil::HashValue(&value));
+  }
+  return hash;
+}
+
+}  // namespace bustub
@@ -15,10 +15,14 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(Page *left_most_page, int k, BufferPoolManager *buffer_pool_manager) {
+INDEXITERATOR_TYPE::IndexIterator(Page *left_most_page, int k, BufferPoolManager *buffer_pool_manager, bool reverse,
+                                  int prefetch_leaves) {
   this->curr_page_ = left_most_page;
   this->k_ = k;
   this->buffer_pool_manager_ = buffer_pool_manager;
+  this->reverse_ = reverse;
+  this->prefetch_leaves_ = prefetch_leaves;
+  this->PrefetchAtMiddle();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -33,29 +37,96 @@ bool INDEXITERATOR_TYPE::isEnd() { return this->curr_page_ == nullptr; }
 
 INDEX_TEMPLATE_ARGUMENTS
 const MappingType &INDEXITERATOR_TYPE::operator*() {
-  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData())->GetItem(this->k_);
+  this->item_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData())->GetItem(this->k_);
+  return this->item_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
-  if (!isEnd()) {
+  if (isEnd()) {
+    return *this;
+  }
+  auto leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData());
+  if (this->reverse_) {
+    this->k_--;
+    if (this->k_ >= 0) {
+      this->PrefetchAtMiddle();
+      return *this;
+    }
+  } else {
     this->k_++;
-    if (this->k_ == reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData())->GetSize()) {
-      page_id_t next_page =
-          reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData())->GetNextPageId();
-      // current page is no more needed in iteration
-      this->buffer_pool_manager_->UnpinPage(this->curr_page_->GetPageId(), true);
-      if (next_page != INVALID_PAGE_ID) {
-        this->curr_page_ = this->buffer_pool_manager_->FetchPage(next_page);
-      } else {
-        this->curr_page_ = nullptr;
-      }
-      this->k_ = 0;
+    if (this->k_ < leaf->GetSize()) {
+      this->PrefetchAtMiddle();
+      return *this;
+    }
+  }
+  page_id_t next_page = this->reverse_ ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+  // current page is no more needed in iteration
+  this->buffer_pool_manager_->UnpinPage(this->curr_page_->GetPageId(), true);
+  this->curr_page_ = nullptr;
+  this->k_ = 0;
+  if (next_page != INVALID_PAGE_ID) {
+    this->curr_page_ = this->buffer_pool_manager_->FetchPage(next_page);
+    if (this->reverse_) {
+      this->k_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData())->GetSize() - 1;
     }
+    this->PrefetchAtMiddle();
   }
   return *this;
 }
 
+/*
+ * Once the iterator is halfway through a leaf, the leaf it reads next is read
+ * into the buffer pool in the background, while it reads the rest of this one.
+ * Done once per leaf. The iterator holds no tree latch, under which a merge
+ * may free the parent of the leaf, so it only follows the leaf link.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrefetchAtMiddle() {
+  if (this->prefetch_leaves_ == 0 || this->curr_page_ == nullptr ||
+      this->prefetched_page_id_ == this->curr_page_->GetPageId()) {
+    return;
+  }
+  auto leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(this->curr_page_->GetData());
+  int middle = leaf->GetSize() / 2;
+  if (this->reverse_ ? this->k_ > middle : this->k_ < middle) {
+    return;
+  }
+  this->prefetched_page_id_ = this->curr_page_->GetPageId();
+  PrefetchLeaves(leaf, this->reverse_, 1, this->buffer_pool_manager_);
+}
+
+/*
+ * The leaf only links to its sibling, the parent lists the leaves after it
+ * NOTE: past the sibling, the caller must hold the tree latch for the parent
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrefetchLeaves(const B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, bool reverse, int count,
+                                        BufferPoolManager *buffer_pool_manager) {
+  page_id_t sibling_page_id = reverse ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+  if (count <= 0 || sibling_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  buffer_pool_manager->PrefetchPage(sibling_page_id);
+  if (count == 1 || leaf->IsRootPage()) {
+    return;
+  }
+  Page *page = buffer_pool_manager->FetchPage(leaf->GetParentPageId());
+  if (page == nullptr) {
+    return;
+  }
+  auto parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  int index = parent->ValueIndex(sibling_page_id);
+  for (int i = 1; i < count && index < parent->GetSize(); i++) {
+    index += reverse ? -1 : 1;
+    if (index < 0 || index >= parent->GetSize()) {
+      break;
+    }
+    buffer_pool_manager->PrefetchPage(parent->ValueAt(index));
+  }
+  buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
@@ -66,4 +137,18 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class IndexIterator<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+
+template class IndexIterator<NormalizedKey<256>, RID, NormalizedComparator<256>>;
+
 }  // namespace bustub
@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "storage/index/index_statistics.h"
+
+namespace bustub {
+
+// the guess for a range when there is no histogram, as for a predicate without statistics
+static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3;
+
+static bool IsNumeric(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+      return !value.IsNull();
+    default:
+      return false;
+  }
+}
+
+double IndexStatistics::EstimateEqualSelectivity() const {
+  if (this->distinct_keys_ == 0) {
+    return 0;
+  }
+  return 1.0 / this->distinct_keys_;
+}
+
+double IndexStatistics::EstimateRangeSelectivity(const Value *low, const Value *high) const {
+  if (this->num_entries_ == 0) {
+    return 0;
+  }
+  if (this->histogram_depths_.empty()) {
+    return low == nullptr && high == nullptr ? 1 : DEFAULT_RANGE_SELECTIVITY;
+  }
+  double total = this->histogram_depths_.back();
+  double below_low = low == nullptr ? 0 : this->EstimateEntriesBelow(*low);
+  double below_high = high == nullptr ? total : this->EstimateEntriesBelow(*high);
+  // an inclusive high bound also takes the entries equal to it
+  if (high != nullptr) {
+    below_high += total * this->EstimateEqualSelectivity();
+  }
+  return std::min(1.0, std::max(0.0, below_high - below_low) / total);
+}
+
+/*
+ * Find the bucket the value falls in and take the buckets before it, and the
+ * part of it below the value: in proportion to the distance between the
+ * bucket bounds for numbers, half of it otherwise
+ */
+double IndexStatistics::EstimateEntriesBelow(const Value &value) const {
+  if (value.CompareLessThanEquals(this->histogram_bounds_[0]) == CmpBool::CmpTrue) {
+    return 0;
+  }
+  for (size_t i = 0; i < this->histogram_depths_.size(); i++) {
+    const Value &lower = this->histogram_bounds_[i];
+    const Value &upper = this->histogram_bounds_[i + 1];
+    if (value.CompareLessThanEquals(upper) != CmpBool::CmpTrue) {
+      continue;
+    }
+    double before = i == 0 ? 0 : this->histogram_depths_[i - 1];
+    double fraction = 0.5;
+    if (IsNumeric(value) && IsNumeric(lower) && IsNumeric(upper) &&
+        upper.CompareGreaterThan(lower) == CmpBool::CmpTrue) {
+      double v = value.CastAs(TypeId::DECIMAL).GetAs<double>();
+      double l = lower.CastAs(TypeId::DECIMAL).GetAs<double>();
+      double u = upper.CastAs(TypeId::DECIMAL).GetAs<double>();
+      fraction = std::min(1.0, std::max(0.0, (v - l) / (u - l)));
+    }
+    return before + fraction * (this->histogram_depths_[i] - before);
+  }
+  return this->histogram_depths_.back();
+}
+
+}  // namespace bustub
@@ -1,6 +1,9 @@
+#include <utility>
 #include <vector>
 
+#include "common/exception.h"
 #include "storage/index/linear_probe_hash_table_index.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 /*
@@ -11,14 +14,21 @@ HASH_TABLE_INDEX_TYPE::LinearProbeHashTableIndex(IndexMetadata *metadata, Buffer
                                                  size_t num_buckets, const HashFunction<KeyType> &hash_fn)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_, num_buckets, hash_fn) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, num_buckets, hash_fn) {
+  // the whole key is hashed, extra columns would change the bucket of a key
+  if (!metadata->GetIncludeAttrs().empty()) {
+    container_.Destroy();
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Hash indexes do not support INCLUDE columns.");
+  }
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
+  this->AddEntryToBloomFilter(key);
   container_.Insert(transaction, index_key, rid);
 }
 
@@ -26,23 +36,63 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
-  container_.Remove(transaction, index_key, rid);
+  if (container_.Remove(transaction, index_key, rid)) {
+    this->NoteBloomFilterDelete();
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (!this->MayContainKey(key)) {
+    return;
+  }
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::ScanRange(const Tuple *low_key, const Tuple *high_key, bool low_inclusive,
+                                      bool high_inclusive, bool descending, size_t limit, std::vector<RID> *result,
+                                      Transaction *transaction) {
+  // hashing does not keep keys in order
+  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Hash table index does not support range scans.");
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::BuildFromTable(TableHeap *table_heap, const Schema &schema, Transaction *transaction) {
+  // one pass over the table, the table is sized for all of its keys and filled a block page at a time
+  // e.g. a key too long for KeyType, or no frame for a page: the pages of the table are freed with it
+  try {
+    std::vector<std::pair<KeyType, ValueType>> pairs;
+    for (auto iter = table_heap->Begin(transaction); iter != table_heap->End(); ++iter) {
+      KeyType index_key;
+      index_key.SetFromKey(iter->KeyFromTuple(schema, *GetEntrySchema(), GetEntryAttrs()), GetKeySchema());
+      pairs.emplace_back(index_key, iter->GetRid());
+    }
+    container_.BulkInsert(transaction, pairs);
+  } catch (...) {
+    container_.Destroy();
+    throw;
+  }
+}
+
 template class LinearProbeHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class LinearProbeHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class LinearProbeHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class LinearProbeHashTableIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class LinearProbeHashTableIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class LinearProbeHashTableIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class LinearProbeHashTableIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class LinearProbeHashTableIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class LinearProbeHashTableIndex<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+template class LinearProbeHashTableIndex<NormalizedKey<256>, RID, NormalizedComparator<256>>;
+
 }  // namespace bustub
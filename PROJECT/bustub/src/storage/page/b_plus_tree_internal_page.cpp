@@ -9,11 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_key_search.h"
 
 namespace bustub {
 /*****************************************************************************
@@ -25,13 +28,17 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size,
+                                          bool variable_length_keys) {
   this->SetPageId(page_id);
   this->SetParentPageId(parent_id);
-  this->SetMaxSize(max_size);
+  int capacity =
+      variable_length_keys ? (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / INTERNAL_SLOT_SIZE : INTERNAL_PAGE_SIZE;
+  this->SetMaxSize(std::min<int>(max_size, capacity));
 
   this->SetPageType(IndexPageType::INTERNAL_PAGE);
   this->SetSize(0);
+  this->ResetKeyLayout(variable_length_keys);
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -39,12 +46,27 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  return this->array[index].first;
+  if (!this->HasVariableLengthKeys()) {
+    return this->array[index].first;
+  }
+  KeyType key;
+  this->ReadSlotKey(this->SlotAt(index), reinterpret_cast<char *>(&key), sizeof(KeyType));
+  return key;
 }
 
+/*
+ * NOTE: with variable-length keys, key must share the page prefix
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { this->array[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (!this->HasVariableLengthKeys()) {
+    this->array[index].first = key;
+    return;
+  }
+  ValueType value = this->ValueAt(index);
+  this->RemoveAt(index);
+  this->InsertAt(index, {key, value});
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
@@ -67,7 +89,164 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return this->array[index].second; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  if (!this->HasVariableLengthKeys()) {
+    return this->array[index].second;
+  }
+  ValueType value;
+  memcpy(&value, this->SlotAt(index) + KEY_SLOT_HEADER_SIZE, sizeof(ValueType));
+  return value;
+}
+
+/*
+ * Helper method to tell whether this page must be split after an insertion:
+ * it holds more than max size entries, or the next key might not fit
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsOverfull() const {
+  if (this->GetSize() > this->GetMaxSize()) {
+    return true;
+  }
+  return this->HasVariableLengthKeys() && this->GetFreeSpace(this->SlotAt(0), INTERNAL_SLOT_SIZE) <
+                                              static_cast<int>(INTERNAL_SLOT_SIZE + sizeof(KeyType));
+}
+
+/*
+ * Helper method to tell whether this page should be merged or refilled after a
+ * deletion: it holds less than min size entries, and with variable-length
+ * keys they take less than half of the page. With a larger fraction, whether
+ * it is filled below 1 / fraction instead of half.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderfull(int fraction) const {
+  if (this->GetSize() >= (this->GetMaxSize() + 1) / fraction) {
+    return false;
+  }
+  return !this->HasVariableLengthKeys() ||
+         fraction * this->GetUsedSpace(INTERNAL_SLOT_SIZE) < PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE;
+}
+
+/*
+ * Helper methods to address slot "index" of a page with variable-length keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotAt(int index) {
+  return reinterpret_cast<char *>(this->array) + index * INTERNAL_SLOT_SIZE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotAt(int index) const {
+  return reinterpret_cast<const char *>(this->array) + index * INTERNAL_SLOT_SIZE;
+}
+
+/*
+ * Helper method to insert item at "index", moving the following items back
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(int index, const MappingType &item) {
+  if (this->HasVariableLengthKeys()) {
+    this->InsertSlot(this->SlotAt(0), INTERNAL_SLOT_SIZE, index, reinterpret_cast<const char *>(&item.first),
+                     sizeof(KeyType));
+    memcpy(this->SlotAt(index) + KEY_SLOT_HEADER_SIZE, &item.second, sizeof(ValueType));
+  } else {
+    memmove(static_cast<void *>(this->array + index + 1), this->array + index,
+            (this->GetSize() - index) * sizeof(MappingType));
+    this->array[index] = item;
+  }
+  this->IncreaseSize(1);
+}
+
+/*
+ * Helper method to remove the item at "index", moving the following items forward
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
+  if (this->HasVariableLengthKeys()) {
+    this->RemoveSlot(this->SlotAt(0), INTERNAL_SLOT_SIZE, index);
+  } else {
+    memmove(static_cast<void *>(this->array + index), this->array + index + 1,
+            (this->GetSize() - index - 1) * sizeof(MappingType));
+  }
+  this->IncreaseSize(-1);
+}
+
+/*
+ * Helper method to keep only the first "size" items
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Truncate(int size) {
+  this->SetSize(size);
+  if (this->HasVariableLengthKeys()) {
+    this->CompactKeyHeap(this->SlotAt(0), INTERNAL_SLOT_SIZE);
+  }
+}
+
+/*****************************************************************************
+ * KEY PREFIX
+ *****************************************************************************/
+/*
+ * Set the fences of this page and strip their common prefix from every key.
+ * Every key in this page must lie between the new fences, and the page must
+ * fit with them (see FitsWithFences).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetFences(const KeyType *low_fence, const KeyType *high_fence) {
+  this->SetFenceData(this->SlotAt(0), INTERNAL_SLOT_SIZE, sizeof(KeyType), reinterpret_cast<const char *>(low_fence),
+                     reinterpret_cast<const char *>(high_fence));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLowFence() const {
+  KeyType low_fence;
+  this->CopyLowFence(reinterpret_cast<char *>(&low_fence), sizeof(KeyType));
+  return low_fence;
+}
+
+/*
+ * @return false if this page is unbounded on the right
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighFence(KeyType *high_fence) const {
+  return this->CopyHighFence(reinterpret_cast<char *>(high_fence), sizeof(KeyType));
+}
+
+/*
+ * Helper method to compute how many bytes an entry with this key would take
+ * in this page if it had these fences
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetEntrySpace(const KeyType &key, const KeyType *low_fence,
+                                                  const KeyType *high_fence) const {
+  return INTERNAL_SLOT_SIZE + this->GetKeySpace(reinterpret_cast<const char *>(&key), sizeof(KeyType),
+                                                reinterpret_cast<const char *>(low_fence),
+                                                reinterpret_cast<const char *>(high_fence));
+}
+
+/*
+ * Helper method to compute how many bytes the entries of this page would take
+ * if it had these fences, e.g. to move them into a sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetSpaceWithFences(const KeyType *low_fence, const KeyType *high_fence) const {
+  return this->GetSlotSpaceWithFences(this->SlotAt(0), INTERNAL_SLOT_SIZE, sizeof(KeyType),
+                                      reinterpret_cast<const char *>(low_fence),
+                                      reinterpret_cast<const char *>(high_fence));
+}
+
+/*
+ * Helper method to check that this page, with these fences, could take "size"
+ * more entries of "space" bytes in total and still not be overfull
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::FitsWithFences(const KeyType *low_fence, const KeyType *high_fence, int size,
+                                                    int space) const {
+  int capacity = this->GetCapacityWithFences(this->SlotAt(0), sizeof(KeyType),
+                                             reinterpret_cast<const char *>(low_fence),
+                                             reinterpret_cast<const char *>(high_fence));
+  int free_space = capacity - this->GetSpaceWithFences(low_fence, high_fence) - space;
+  return this->GetSize() + size <= this->GetMaxSize() &&
+         free_space >= static_cast<int>(INTERNAL_SLOT_SIZE + sizeof(KeyType));
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -79,19 +258,38 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return this
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  if (this->GetSize() == 1) {
-    return this->ValueAt(0);
-  }
-  int ans = this->GetSize() - 1;
-  while (ans > 0) {
-    int cmp_result = comparator(key, this->KeyAt(ans));
-    if (cmp_result < 0) {
-      ans--;
-    } else {
-      break;
-    }
+  return this->ValueAt(this->LookupIndex(key, comparator, false));
+}
+
+/*
+ * Find and return the child pointer(page_id) which points to the leftmost
+ * child page that may contain input "key". With duplicate keys, the entries
+ * equal to a separator may also sit at the end of the child left of it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupFirst(const KeyType &key, const KeyComparator &comparator) const {
+  return this->ValueAt(this->LookupIndex(key, comparator, true));
+}
+
+/*
+ * Find the index of the child pointer Lookup (or LookupFirst if first) would
+ * return, so that the caller can also read the keys bounding that child
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator,
+                                                bool first) const {
+  // the first key is invalid, so the child is the one left of the first key > key (>= key for first)
+  int index;
+  if (!this->HasVariableLengthKeys()) {
+    index = first ? B_PLUS_TREE_KEY_SEARCH_TYPE::LowerBound(this->array, 1, this->GetSize(), key, comparator)
+                  : B_PLUS_TREE_KEY_SEARCH_TYPE::UpperBound(this->array, 1, this->GetSize(), key, comparator);
+  } else {
+    auto search = first ? VariableSlotSearch<false> : VariableSlotSearch<true>;
+    index = search(reinterpret_cast<const char *>(this), this->SlotAt(0), INTERNAL_SLOT_SIZE, 1, this->GetSize(),
+                   this->GetKeyPrefix(), this->GetPrefixSize(), reinterpret_cast<const char *>(&key),
+                   sizeof(KeyType));
   }
-  return this->ValueAt(ans);
+  return index - 1;
 }
 
 /*****************************************************************************
@@ -106,10 +304,9 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
-  this->SetSize(2);
-  this->SetKeyAt(1, new_key);
-  this->array[0].second = old_value;
-  this->array[1].second = new_value;
+  this->Truncate(0);
+  this->InsertAt(0, {new_key, old_value});
+  this->InsertAt(1, {new_key, new_value});
 }
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
@@ -119,27 +316,46 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  int pos = this->ValueIndex(old_value);
-  for (int i = this->GetSize(); i > pos; i--) {
-    this->array[i] = this->array[i - 1];
-  }
-  this->array[pos + 1] = {new_key, new_value};
-  this->IncreaseSize(1);
+  this->InsertAt(this->ValueIndex(old_value) + 1, {new_key, new_value});
   return this->GetSize();
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
+/*
+ * Index of the first entry MoveHalfTo moves: half of the entries, or with
+ * variable-length keys, half of the bytes they take
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetSplitIndex() const {
+  int first = this->GetSize() - (this->GetSize() + 1) / 2;
+  if (this->HasVariableLengthKeys()) {
+    int total = this->GetUsedSpace(INTERNAL_SLOT_SIZE);
+    int space = 0;
+    for (first = 0; first < this->GetSize() && 2 * space < total; first++) {
+      space += this->GetSlotSpace(this->SlotAt(0), INTERNAL_SLOT_SIZE, first);
+    }
+    // both halves must respect max size and keep a child
+    first = std::max({first, this->GetSize() - this->GetMaxSize(), 1});
+    first = std::min({first, this->GetMaxSize(), this->GetSize() - 1});
+  }
+  return first;
+}
+
 /*
  * Remove half of key & value pairs from this page to "recipient" page
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
                                                 BufferPoolManager *buffer_pool_manager) {
-  int k = (this->GetSize() + 1) / 2;
-  recipient->CopyNFrom(this->array + this->GetSize() - k, k, buffer_pool_manager);
-  this->IncreaseSize(-k);
+  int first = this->GetSplitIndex();
+  std::vector<MappingType> items;
+  for (int i = first; i < this->GetSize(); i++) {
+    items.push_back({this->KeyAt(i), this->ValueAt(i)});
+  }
+  recipient->CopyNFrom(items.data(), items.size(), buffer_pool_manager);
+  this->Truncate(first);
 }
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
@@ -162,11 +378,27 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  for (int i = index; i < this->GetSize() - 1; i++) {
-    this->array[i] = this->array[i + 1];
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) { this->RemoveAt(index); }
+
+/*
+ * Remove the key & value pairs at indexes begin to end (exclusive) at once,
+ * the children a range delete drops whole
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveRange(int begin, int end) {
+  if (begin >= end) {
+    return;
   }
-  this->IncreaseSize(-1);
+  if (this->HasVariableLengthKeys()) {
+    char *slots = this->SlotAt(0);
+    memmove(slots + begin * INTERNAL_SLOT_SIZE, slots + end * INTERNAL_SLOT_SIZE,
+            (this->GetSize() - end) * INTERNAL_SLOT_SIZE);
+  } else {
+    memmove(static_cast<void *>(this->array + begin), this->array + end,
+            (this->GetSize() - end) * sizeof(MappingType));
+  }
+  // the keys of the removed slots are dropped from the key heap
+  this->Truncate(this->GetSize() - (end - begin));
 }
 
 /*
@@ -175,8 +407,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
-  ValueType rev = this->array[0].second;
-  this->IncreaseSize(-1);
+  ValueType rev = this->ValueAt(0);
+  this->Truncate(0);
   return rev;
 }
 /*****************************************************************************
@@ -192,11 +424,11 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyLastFrom({middle_key, this->array[0].second}, buffer_pool_manager);
+  recipient->CopyLastFrom({middle_key, this->ValueAt(0)}, buffer_pool_manager);
   for (int i = 1; i < this->GetSize(); i++) {
-    recipient->CopyLastFrom(this->array[i], buffer_pool_manager);
+    recipient->CopyLastFrom({this->KeyAt(i), this->ValueAt(i)}, buffer_pool_manager);
   }
-  this->SetSize(0);
+  this->Truncate(0);
 }
 
 /*****************************************************************************
@@ -213,7 +445,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyLastFrom({middle_key, this->array[0].second}, buffer_pool_manager);
+  recipient->CopyLastFrom({middle_key, this->ValueAt(0)}, buffer_pool_manager);
   this->Remove(0);
 }
 
@@ -223,11 +455,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  this->array[this->GetSize()] = pair;
-  this->IncreaseSize(1);
-  reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(pair.second)->GetData())
+  this->InsertAt(this->GetSize(), pair);
+  reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(pair.second)->GetData())
       ->SetParentPageId(this->GetPageId());
-  buffer_pool_manager->FlushPage(pair.second);
+  buffer_pool_manager->UnpinPage(pair.second, true);
 }
 
 /*
@@ -240,7 +471,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyFirstFrom({middle_key, this->array[this->GetSize() - 1].second}, buffer_pool_manager);
+  // the middle key now separates the old first child of recipient from the moved one
+  recipient->SetKeyAt(0, middle_key);
+  int last = this->GetSize() - 1;
+  recipient->CopyFirstFrom({this->KeyAt(last), this->ValueAt(last)}, buffer_pool_manager);
   this->Remove(this->GetSize() - 1);
 }
 
@@ -250,16 +484,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *re
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  this->array[0].first = pair.first;
-  for (int i = this->GetSize(); i >= 1; i--) {
-    this->array[i] = this->array[i - 1];
-  }
-  this->array[0] = pair;
-  this->IncreaseSize(1);
+  this->InsertAt(0, pair);
 
-  reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager->FetchPage(pair.second)->GetData())
+  reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(pair.second)->GetData())
       ->SetParentPageId(this->GetPageId());
-  buffer_pool_manager->FlushPage(pair.second);
+  buffer_pool_manager->UnpinPage(pair.second, true);
 }
 
 // valuetype for internalNode should be page id_t
@@ -268,4 +497,12 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template class BPlusTreeInternalPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeInternalPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
+template class BPlusTreeInternalPage<NormalizedKey<128>, page_id_t, NormalizedComparator<128>>;
+template class BPlusTreeInternalPage<NormalizedKey<256>, page_id_t, NormalizedComparator<256>>;
 }  // namespace bustub
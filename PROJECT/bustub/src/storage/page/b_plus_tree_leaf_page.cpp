@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/page/b_plus_tree_key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -27,17 +30,21 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size,
+                                      bool variable_length_keys) {
   this->SetPageId(page_id);
   this->SetParentPageId(parent_id);
-  this->SetMaxSize(max_size);
+  int capacity = variable_length_keys ? (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / LEAF_SLOT_SIZE : LEAF_PAGE_SIZE;
+  this->SetMaxSize(std::min<int>(max_size, capacity));
   this->SetNextPageId(INVALID_PAGE_ID);
+  this->SetPrevPageId(INVALID_PAGE_ID);
   this->SetSize(0);
   this->SetPageType(IndexPageType::LEAF_PAGE);
+  this->ResetKeyLayout(variable_length_keys);
 }
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next page id and previous page id
  */
 INDEX_TEMPLATE_ARGUMENTS
 page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return this->next_page_id_; }
@@ -45,22 +52,24 @@ page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return this->next_
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { this->next_page_id_ = next_page_id; }
 
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return this->prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { this->prev_page_id_ = prev_page_id; }
+
 /**
  * Helper method to find the first index i so that array[i].first >= key
- * NOTE: This method is only used when generating index iterator
+ * @return GetSize() if every key in this page is smaller than key
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  int l = 0, r = this->GetSize() - 1;
-  while (l < r) {
-    int mid = (l + r) / 2;
-    if (comparator(key, this->array[mid].first) > 0) {
-      l = mid + 1;
-    } else {
-      r = mid;
-    }
+  if (!this->HasVariableLengthKeys()) {
+    return B_PLUS_TREE_KEY_SEARCH_TYPE::LowerBound(this->array, 0, this->GetSize(), key, comparator);
   }
-  return l;
+  return VariableSlotSearch<false>(reinterpret_cast<const char *>(this), this->SlotAt(0), LEAF_SLOT_SIZE, 0,
+                                   this->GetSize(), this->GetKeyPrefix(), this->GetPrefixSize(),
+                                   reinterpret_cast<const char *>(&key), sizeof(KeyType));
 }
 
 /*
@@ -68,14 +77,191 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return this->array[index].first; }
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
+  if (!this->HasVariableLengthKeys()) {
+    return this->array[index].first;
+  }
+  KeyType key;
+  this->ReadSlotKey(this->SlotAt(index), reinterpret_cast<char *>(&key), sizeof(KeyType));
+  return key;
+}
 
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) { return array[index]; }
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  if (!this->HasVariableLengthKeys()) {
+    return this->array[index];
+  }
+  MappingType item;
+  item.first = this->KeyAt(index);
+  memcpy(&item.second, this->SlotAt(index) + KEY_SLOT_HEADER_SIZE, sizeof(ValueType));
+  return item;
+}
+
+/*
+ * Helper method to tell whether this page must be split after an insertion:
+ * it holds more than max size entries, or the next key might not fit
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsOverfull() const {
+  if (this->GetSize() > this->GetMaxSize()) {
+    return true;
+  }
+  return this->HasVariableLengthKeys() &&
+         this->GetFreeSpace(this->SlotAt(0), LEAF_SLOT_SIZE) < static_cast<int>(LEAF_SLOT_SIZE + sizeof(KeyType));
+}
+
+/*
+ * Helper method to tell whether this page should be merged or refilled after a
+ * deletion: it holds less than min size entries, and with variable-length
+ * keys they take less than half of the page. With a larger fraction, whether
+ * it is filled below 1 / fraction instead of half.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderfull(int fraction) const {
+  if (this->GetSize() >= (this->GetMaxSize() + 1) / fraction) {
+    return false;
+  }
+  return !this->HasVariableLengthKeys() ||
+         fraction * this->GetUsedSpace(LEAF_SLOT_SIZE) < PAGE_SIZE - LEAF_PAGE_HEADER_SIZE;
+}
+
+/*
+ * Helper method to get the fraction of this page in use: of its max size, or
+ * of its bytes with variable-length keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+double B_PLUS_TREE_LEAF_PAGE_TYPE::GetFillFactor() const {
+  if (this->HasVariableLengthKeys()) {
+    return static_cast<double>(this->GetUsedSpace(LEAF_SLOT_SIZE)) / (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE);
+  }
+  return static_cast<double>(this->GetSize()) / this->GetMaxSize();
+}
+
+/*
+ * Helper methods to address slot "index" of a page with variable-length keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_LEAF_PAGE_TYPE::SlotAt(int index) {
+  return reinterpret_cast<char *>(this->array) + index * LEAF_SLOT_SIZE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::SlotAt(int index) const {
+  return reinterpret_cast<const char *>(this->array) + index * LEAF_SLOT_SIZE;
+}
+
+/*
+ * Helper method to insert item at "index", moving the following items back
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const MappingType &item) {
+  if (this->HasVariableLengthKeys()) {
+    this->InsertSlot(this->SlotAt(0), LEAF_SLOT_SIZE, index, reinterpret_cast<const char *>(&item.first),
+                     sizeof(KeyType));
+    memcpy(this->SlotAt(index) + KEY_SLOT_HEADER_SIZE, &item.second, sizeof(ValueType));
+  } else {
+    memmove(static_cast<void *>(this->array + index + 1), this->array + index,
+            (this->GetSize() - index) * sizeof(MappingType));
+    this->array[index] = item;
+  }
+  this->IncreaseSize(1);
+}
+
+/*
+ * Helper method to remove the item at "index", moving the following items forward
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  if (this->HasVariableLengthKeys()) {
+    this->RemoveSlot(this->SlotAt(0), LEAF_SLOT_SIZE, index);
+  } else {
+    memmove(static_cast<void *>(this->array + index), this->array + index + 1,
+            (this->GetSize() - index - 1) * sizeof(MappingType));
+  }
+  this->IncreaseSize(-1);
+}
+
+/*
+ * Helper method to keep only the first "size" items
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Truncate(int size) {
+  this->SetSize(size);
+  if (this->HasVariableLengthKeys()) {
+    this->CompactKeyHeap(this->SlotAt(0), LEAF_SLOT_SIZE);
+  }
+}
+
+/*****************************************************************************
+ * KEY PREFIX
+ *****************************************************************************/
+/*
+ * Set the fences of this page and strip their common prefix from every key.
+ * Every key in this page must lie between the new fences, and the page must
+ * fit with them (see FitsWithFences).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetFences(const KeyType *low_fence, const KeyType *high_fence) {
+  this->SetFenceData(this->SlotAt(0), LEAF_SLOT_SIZE, sizeof(KeyType), reinterpret_cast<const char *>(low_fence),
+                     reinterpret_cast<const char *>(high_fence));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetLowFence() const {
+  KeyType low_fence;
+  this->CopyLowFence(reinterpret_cast<char *>(&low_fence), sizeof(KeyType));
+  return low_fence;
+}
+
+/*
+ * @return false if this page is unbounded on the right
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighFence(KeyType *high_fence) const {
+  return this->CopyHighFence(reinterpret_cast<char *>(high_fence), sizeof(KeyType));
+}
+
+/*
+ * Helper method to compute how many bytes an entry with this key would take
+ * in this page if it had these fences
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetEntrySpace(const KeyType &key, const KeyType *low_fence,
+                                              const KeyType *high_fence) const {
+  return LEAF_SLOT_SIZE + this->GetKeySpace(reinterpret_cast<const char *>(&key), sizeof(KeyType),
+                                            reinterpret_cast<const char *>(low_fence),
+                                            reinterpret_cast<const char *>(high_fence));
+}
+
+/*
+ * Helper method to compute how many bytes the entries of this page would take
+ * if it had these fences, e.g. to move them into a sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetSpaceWithFences(const KeyType *low_fence, const KeyType *high_fence) const {
+  return this->GetSlotSpaceWithFences(this->SlotAt(0), LEAF_SLOT_SIZE, sizeof(KeyType),
+                                      reinterpret_cast<const char *>(low_fence),
+                                      reinterpret_cast<const char *>(high_fence));
+}
+
+/*
+ * Helper method to check that this page, with these fences, could take "size"
+ * more entries of "space" bytes in total and still not be overfull
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::FitsWithFences(const KeyType *low_fence, const KeyType *high_fence, int size,
+                                                int space) const {
+  int capacity = this->GetCapacityWithFences(this->SlotAt(0), sizeof(KeyType),
+                                             reinterpret_cast<const char *>(low_fence),
+                                             reinterpret_cast<const char *>(high_fence));
+  int free_space = capacity - this->GetSpaceWithFences(low_fence, high_fence) - space;
+  return this->GetSize() + size <= this->GetMaxSize() &&
+         free_space >= static_cast<int>(LEAF_SLOT_SIZE + sizeof(KeyType));
+}
 
 /*****************************************************************************
  * INSERTION
@@ -86,27 +272,45 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) { return array
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  int i = this->GetSize();
-  while (i > 0 && comparator(key, this->array[i - 1].first) < 0) {
-    this->array[i] = this->array[i - 1];
-    i--;
-  }
-  this->array[i] = {key, value};
-  this->IncreaseSize(1);
+  this->InsertAt(this->KeyIndex(key, comparator), {key, value});
   return this->GetSize();
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
+/*
+ * Index of the first entry MoveHalfTo moves: half of the entries, or with
+ * variable-length keys, half of the bytes they take
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetSplitIndex() const {
+  int first = this->GetSize() - (this->GetSize() + 1) / 2;
+  if (this->HasVariableLengthKeys()) {
+    int total = this->GetUsedSpace(LEAF_SLOT_SIZE);
+    int space = 0;
+    for (first = 0; first < this->GetSize() && 2 * space < total; first++) {
+      space += this->GetSlotSpace(this->SlotAt(0), LEAF_SLOT_SIZE, first);
+    }
+    // both halves must respect max size and hold an entry
+    first = std::max({first, this->GetSize() - this->GetMaxSize(), 1});
+    first = std::min({first, this->GetMaxSize(), this->GetSize() - 1});
+  }
+  return first;
+}
+
 /*
  * Remove half of key & value pairs from this page to "recipient" page
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
-  int k = (this->GetSize() + 1) / 2;
-  recipient->CopyNFrom(this->array + this->GetSize() - k, k);
-  this->SetSize(this->GetSize() - k);
+  int first = this->GetSplitIndex();
+  std::vector<MappingType> items;
+  for (int i = first; i < this->GetSize(); i++) {
+    items.push_back(this->GetItem(i));
+  }
+  recipient->CopyNFrom(items.data(), items.size());
+  this->Truncate(first);
 }
 
 /*
@@ -129,20 +333,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  int l = 0, r = this->GetSize() - 1;
-  while (l <= r) {
-    int mid = (l + r) / 2;
-    int cmp = comparator(key, this->array[mid].first);
-    if (cmp == 0) {
-      *value = this->array[mid].second;
-      return true;
-    } else if (cmp < 0) {
-      r = mid - 1;
-    } else {
-      l = mid + 1;
-    }
+  int index = this->KeyIndex(key, comparator);
+  if (index == this->GetSize() || comparator(key, this->KeyAt(index)) != 0) {
+    return false;
   }
-  return false;
+  *value = this->GetItem(index).second;
+  return true;
 }
 
 /*****************************************************************************
@@ -156,21 +352,50 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
-  int i = 0;
-  while (i < this->GetSize()) {
-    if (comparator(key, this->array[i].first) == 0) {
+  int i = this->KeyIndex(key, comparator);
+  if (i == this->GetSize() || comparator(key, this->KeyAt(i)) != 0) {
+    return this->GetSize();
+  }
+  this->RemoveAt(i);
+  return this->GetSize();
+}
+
+/*
+ * Remove the entry with both this key and this value, with duplicate keys
+ * the key alone does not tell which entry to delete
+ * @return   page size after deletion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const ValueType &value,
+                                                      const KeyComparator &comparator) {
+  for (int i = this->KeyIndex(key, comparator); i < this->GetSize() && comparator(key, this->KeyAt(i)) == 0; i++) {
+    if (this->GetItem(i).second == value) {
+      this->RemoveAt(i);
       break;
     }
-    i++;
   }
-  if (i == this->GetSize()) {
+  return this->GetSize();
+}
+
+/*
+ * Remove the entries at indexes begin to end (exclusive) at once, the part of
+ * a range delete that falls in this page
+ * @return   page size after deletion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveRange(int begin, int end) {
+  if (begin >= end) {
     return this->GetSize();
   }
-  while (i < this->GetSize() - 1) {
-    this->array[i] = this->array[i + 1];
-    i++;
+  if (this->HasVariableLengthKeys()) {
+    char *slots = this->SlotAt(0);
+    memmove(slots + begin * LEAF_SLOT_SIZE, slots + end * LEAF_SLOT_SIZE, (this->GetSize() - end) * LEAF_SLOT_SIZE);
+  } else {
+    memmove(static_cast<void *>(this->array + begin), this->array + end,
+            (this->GetSize() - end) * sizeof(MappingType));
   }
-  this->IncreaseSize(-1);
+  // the keys of the removed slots are dropped from the key heap
+  this->Truncate(this->GetSize() - (end - begin));
   return this->GetSize();
 }
 
@@ -184,9 +409,10 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
   for (int i = 0; i < this->GetSize(); i++) {
-    recipient->CopyLastFrom(this->array[i]);
+    recipient->CopyLastFrom(this->GetItem(i));
   }
   recipient->SetNextPageId(this->GetNextPageId());
+  this->Truncate(0);
 }
 
 /*****************************************************************************
@@ -197,11 +423,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyLastFrom(this->array[0]);
-  for (int i = 0; i < this->GetSize() - 1; i++) {
-    this->array[i] = this->array[i + 1];
-  }
-  this->IncreaseSize(-1);
+  recipient->CopyLastFrom(this->GetItem(0));
+  this->RemoveAt(0);
 }
 
 /*
@@ -209,8 +432,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  this->array[this->GetSize()] = item;
-  this->IncreaseSize(1);
+  this->InsertAt(this->GetSize(), item);
 }
 
 /*
@@ -218,25 +440,27 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyFirstFrom(this->array[this->GetSize() - 1]);
-  this->IncreaseSize(-1);
+  recipient->CopyFirstFrom(this->GetItem(this->GetSize() - 1));
+  this->RemoveAt(this->GetSize() - 1);
 }
 
 /*
  * Insert item at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-  for (int i = this->GetSize(); i >= 1; i--) {
-    this->array[i] = this->array[i - 1];
-  }
-  this->array[0] = item;
-  this->IncreaseSize(1);
-}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) { this->InsertAt(0, item); }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTreeLeafPage<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+template class BPlusTreeLeafPage<NormalizedKey<256>, RID, NormalizedComparator<256>>;
 }  // namespace bustub
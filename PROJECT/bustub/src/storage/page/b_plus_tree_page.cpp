@@ -9,6 +9,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
@@ -58,4 +63,331 @@ void BPlusTreePage::SetPageId(page_id_t page_id) { this->page_id_ = page_id; }
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { this->lsn_ = lsn; }
 
+/*
+ * Helper method to get the number of key bytes shared by every slot, which are
+ * stored once at the head of the low fence
+ */
+int BPlusTreePage::GetPrefixSize() const { return this->prefix_size_; }
+
+/*
+ * Helper method to tell whether keys are stored in variable-length slots
+ */
+bool BPlusTreePage::HasVariableLengthKeys() const { return this->key_heap_size_ >= 0; }
+
+/*
+ * Helper method to choose the slot layout of an empty page, and unbound it on
+ * both sides so that no prefix is stripped
+ */
+void BPlusTreePage::ResetKeyLayout(bool variable_length_keys) {
+  this->prefix_size_ = 0;
+  this->key_heap_size_ = variable_length_keys ? 0 : -1;
+  this->low_fence_size_ = 0;
+  this->high_fence_size_ = -1;
+}
+
+/*
+ * Helper method to get the key prefix, which is the head of the low fence.
+ * Fences are stored at the end of the page, the high fence last.
+ */
+const char *BPlusTreePage::GetKeyPrefix() const {
+  return reinterpret_cast<const char *>(this) + PAGE_SIZE - std::max<int>(this->high_fence_size_, 0) -
+         this->low_fence_size_;
+}
+
+/*
+ * Helper methods to copy the fences out as keys of key_size bytes
+ * @return false if the page is unbounded on the right
+ */
+void BPlusTreePage::CopyLowFence(char *key, size_t key_size) const {
+  memset(key, 0, key_size);
+  memcpy(key, this->GetKeyPrefix(), this->low_fence_size_);
+}
+
+bool BPlusTreePage::CopyHighFence(char *key, size_t key_size) const {
+  if (this->high_fence_size_ < 0) {
+    return false;
+  }
+  memset(key, 0, key_size);
+  memcpy(key, reinterpret_cast<const char *>(this) + PAGE_SIZE - this->high_fence_size_, this->high_fence_size_);
+  return true;
+}
+
+namespace {
+/*
+ * Keys and fences are stored without trailing zero bytes, which compare like
+ * padding
+ */
+size_t TrimmedSize(const char *key, size_t key_size) {
+  while (key_size > 0 && key[key_size - 1] == 0) {
+    key_size--;
+  }
+  return key_size;
+}
+
+/*
+ * Length of the common prefix of two fences, a nullptr low fence is the
+ * smallest key (all zero bytes) and a nullptr high fence shares nothing
+ */
+size_t FencePrefixSize(const char *low_fence, const char *high_fence, size_t key_size) {
+  if (high_fence == nullptr) {
+    return 0;
+  }
+  size_t i = 0;
+  while (i < key_size && (low_fence == nullptr ? 0 : low_fence[i]) == high_fence[i]) {
+    i++;
+  }
+  return i;
+}
+
+/*
+ * Bytes the fences take at the end of the page, the low fence is at least as
+ * long as the prefix
+ */
+size_t FenceSize(const char *low_fence, const char *high_fence, size_t key_size) {
+  size_t prefix_size = FencePrefixSize(low_fence, high_fence, key_size);
+  size_t fence_size = std::max(low_fence == nullptr ? 0 : TrimmedSize(low_fence, key_size), prefix_size);
+  if (high_fence != nullptr) {
+    fence_size += TrimmedSize(high_fence, key_size);
+  }
+  return fence_size;
+}
+
+uint16_t SlotKeyOffset(const char *slot) {
+  uint16_t offset;
+  memcpy(&offset, slot, sizeof(uint16_t));
+  return offset;
+}
+
+uint16_t SlotKeyLength(const char *slot) {
+  uint16_t length;
+  memcpy(&length, slot + sizeof(uint16_t), sizeof(uint16_t));
+  return length;
+}
+
+void SetSlotKey(char *slot, uint16_t offset, uint16_t length) {
+  memcpy(slot, &offset, sizeof(uint16_t));
+  memcpy(slot + sizeof(uint16_t), &length, sizeof(uint16_t));
+}
+}  // namespace
+
+/*
+ * Helper method to set the fences of this page and lay its keys out again
+ * for the new prefix. The fences may point into this page, and the keys must
+ * share the new prefix and fit (see GetCapacityWithFences).
+ */
+void BPlusTreePage::SetFenceData(char *slots, size_t slot_size, size_t key_size, const char *low_fence,
+                                 const char *high_fence) {
+  assert(this->HasVariableLengthKeys());
+  size_t prefix_size = FencePrefixSize(low_fence, high_fence, key_size);
+  // copy everything out first, keys may be laid out over the old fences
+  std::string low(std::max(low_fence == nullptr ? 0 : TrimmedSize(low_fence, key_size), prefix_size), '\0');
+  if (low_fence != nullptr) {
+    memcpy(low.data(), low_fence, low.size());
+  }
+  std::string high = high_fence == nullptr ? "" : std::string(high_fence, TrimmedSize(high_fence, key_size));
+  int size = this->GetSize();
+  std::string keys(size * key_size, '\0');
+  std::string values(size * (slot_size - KEY_SLOT_HEADER_SIZE), '\0');
+  for (int i = 0; i < size; i++) {
+    this->ReadSlotKey(slots + i * slot_size, keys.data() + i * key_size, key_size);
+    memcpy(values.data() + i * (slot_size - KEY_SLOT_HEADER_SIZE), slots + i * slot_size + KEY_SLOT_HEADER_SIZE,
+           slot_size - KEY_SLOT_HEADER_SIZE);
+  }
+
+  this->prefix_size_ = static_cast<int16_t>(prefix_size);
+  this->low_fence_size_ = static_cast<int16_t>(low.size());
+  this->high_fence_size_ = high_fence == nullptr ? -1 : static_cast<int16_t>(high.size());
+  char *page_end = reinterpret_cast<char *>(this) + PAGE_SIZE;
+  memcpy(page_end - high.size() - low.size(), low.data(), low.size());
+  memcpy(page_end - high.size(), high.data(), high.size());
+
+  this->key_heap_size_ = 0;
+  this->SetSize(0);
+  for (int i = 0; i < size; i++) {
+    this->InsertSlot(slots, slot_size, i, keys.data() + i * key_size, key_size);
+    memcpy(slots + i * slot_size + KEY_SLOT_HEADER_SIZE, values.data() + i * (slot_size - KEY_SLOT_HEADER_SIZE),
+           slot_size - KEY_SLOT_HEADER_SIZE);
+    this->IncreaseSize(1);
+  }
+}
+
+/*
+ * Helper method to read the key of a variable-length slot: the page prefix,
+ * the stored bytes, then zeros up to key_size
+ */
+void BPlusTreePage::ReadSlotKey(const char *slot, char *key, size_t key_size) const {
+  memset(key, 0, key_size);
+  memcpy(key, this->GetKeyPrefix(), this->prefix_size_);
+  memcpy(key + this->prefix_size_, reinterpret_cast<const char *>(this) + SlotKeyOffset(slot), SlotKeyLength(slot));
+}
+
+/*
+ * Helper method to open a variable-length slot at index and store key in the
+ * key heap, the caller fills the value and increases the size. The key must
+ * share the page prefix and fit. Equal keys sit next to each other, so a key
+ * equal to a neighbor points to its bytes instead of storing them again.
+ */
+void BPlusTreePage::InsertSlot(char *slots, size_t slot_size, int index, const char *key, size_t key_size) {
+  assert(memcmp(key, this->GetKeyPrefix(), this->prefix_size_) == 0);
+  size_t length = TrimmedSize(key, key_size);
+  length = length > static_cast<size_t>(this->prefix_size_) ? length - this->prefix_size_ : 0;
+  assert(this->GetFreeSpace(slots, slot_size) >= static_cast<int>(slot_size + length));
+
+  char *slot = slots + index * slot_size;
+  const char *page = reinterpret_cast<const char *>(this);
+  int offset = -1;
+  for (int neighbor = index - 1; neighbor <= index && length > 0; neighbor++) {
+    const char *other = slots + neighbor * slot_size;
+    if (neighbor >= 0 && neighbor < this->GetSize() && SlotKeyLength(other) == length &&
+        memcmp(page + SlotKeyOffset(other), key + this->prefix_size_, length) == 0) {
+      offset = SlotKeyOffset(other);
+    }
+  }
+  memmove(slot + slot_size, slot, (this->GetSize() - index) * slot_size);
+  if (offset < 0) {
+    this->key_heap_size_ += static_cast<int16_t>(length);
+    const char *heap = this->GetKeyPrefix() - this->key_heap_size_;
+    memcpy(const_cast<char *>(heap), key + this->prefix_size_, length);
+    offset = static_cast<int>(heap - page);
+  }
+  SetSlotKey(slot, static_cast<uint16_t>(offset), static_cast<uint16_t>(length));
+}
+
+/*
+ * Helper method to drop the variable-length slot at index and its key bytes,
+ * unless an equal neighbor still points to them, keeping the key heap packed.
+ * The caller decreases the size.
+ */
+void BPlusTreePage::RemoveSlot(char *slots, size_t slot_size, int index) {
+  char *slot = slots + index * slot_size;
+  uint16_t offset = SlotKeyOffset(slot);
+  uint16_t length = SlotKeyLength(slot);
+  bool shared = this->IsSharedSlot(slots, slot_size, index) ||
+                (index + 1 < this->GetSize() && this->IsSharedSlot(slots, slot_size, index + 1));
+  if (length > 0 && !shared) {
+    // the keys stored below the removed one move up
+    char *page = reinterpret_cast<char *>(this);
+    char *heap = const_cast<char *>(this->GetKeyPrefix()) - this->key_heap_size_;
+    memmove(heap + length, heap, page + offset - heap);
+    for (int i = 0; i < this->GetSize(); i++) {
+      char *other = slots + i * slot_size;
+      if (i != index && SlotKeyOffset(other) < offset) {
+        SetSlotKey(other, SlotKeyOffset(other) + length, SlotKeyLength(other));
+      }
+    }
+    this->key_heap_size_ -= length;
+  }
+  memmove(slot, slot + slot_size, (this->GetSize() - index - 1) * slot_size);
+}
+
+/*
+ * Helper method to pack the keys of the first GetSize() slots, e.g. after the
+ * size was cut down
+ */
+void BPlusTreePage::CompactKeyHeap(char *slots, size_t slot_size) {
+  // shared keys are found by their old offsets, so before any is rewritten
+  std::vector<bool> shared(this->GetSize());
+  std::string keys;
+  for (int i = 0; i < this->GetSize(); i++) {
+    shared[i] = this->IsSharedSlot(slots, slot_size, i);
+    if (!shared[i]) {
+      const char *slot = slots + i * slot_size;
+      keys.append(reinterpret_cast<const char *>(this) + SlotKeyOffset(slot), SlotKeyLength(slot));
+    }
+  }
+  this->key_heap_size_ = static_cast<int16_t>(keys.size());
+  char *heap = const_cast<char *>(this->GetKeyPrefix()) - this->key_heap_size_;
+  memcpy(heap, keys.data(), keys.size());
+  uint16_t offset = static_cast<uint16_t>(heap - reinterpret_cast<char *>(this));
+  for (int i = 0; i < this->GetSize(); i++) {
+    char *slot = slots + i * slot_size;
+    if (shared[i]) {
+      SetSlotKey(slot, SlotKeyOffset(slot - slot_size), SlotKeyLength(slot));
+    } else {
+      SetSlotKey(slot, offset, SlotKeyLength(slot));
+      offset += SlotKeyLength(slot);
+    }
+  }
+}
+
+/*
+ * Helper method to tell whether the slot at index points to the key bytes of
+ * the slot before it
+ */
+bool BPlusTreePage::IsSharedSlot(const char *slots, size_t slot_size, int index) const {
+  const char *slot = slots + index * slot_size;
+  return index > 0 && SlotKeyLength(slot) > 0 && SlotKeyOffset(slot - slot_size) == SlotKeyOffset(slot) &&
+         SlotKeyLength(slot - slot_size) == SlotKeyLength(slot);
+}
+
+/*
+ * Helper method to get the number of bytes the slot at index takes, with its
+ * key bytes unless they are shared with the slot before it
+ */
+int BPlusTreePage::GetSlotSpace(const char *slots, size_t slot_size, int index) const {
+  if (this->IsSharedSlot(slots, slot_size, index)) {
+    return static_cast<int>(slot_size);
+  }
+  return static_cast<int>(slot_size) + SlotKeyLength(slots + index * slot_size);
+}
+
+/*
+ * Helper method to get the number of bytes between the last slot and the key
+ * heap
+ */
+int BPlusTreePage::GetFreeSpace(const char *slots, size_t slot_size) const {
+  return static_cast<int>(this->GetKeyPrefix() - this->key_heap_size_ - slots) -
+         this->GetSize() * static_cast<int>(slot_size);
+}
+
+/*
+ * Helper method to get the number of bytes taken by the slots and their keys
+ */
+int BPlusTreePage::GetUsedSpace(size_t slot_size) const {
+  return this->GetSize() * static_cast<int>(slot_size) + this->key_heap_size_;
+}
+
+/*
+ * Helper method to compute how many bytes key would take in the key heap of
+ * this page if it had the given fences. A nullptr fence is unbounded.
+ */
+int BPlusTreePage::GetKeySpace(const char *key, size_t key_size, const char *low_fence,
+                               const char *high_fence) const {
+  size_t prefix_size = FencePrefixSize(low_fence, high_fence, key_size);
+  size_t length = TrimmedSize(key, key_size);
+  return static_cast<int>(length > prefix_size ? length - prefix_size : 0);
+}
+
+/*
+ * Helper method to compute how many bytes the slots and keys of this page
+ * would take if it had the given fences, e.g. to check that two siblings can
+ * be merged
+ */
+int BPlusTreePage::GetSlotSpaceWithFences(const char *slots, size_t slot_size, size_t key_size,
+                                          const char *low_fence, const char *high_fence) const {
+  size_t prefix_size = FencePrefixSize(low_fence, high_fence, key_size);
+  // a key stored without bytes is the current prefix without its trailing zeros
+  size_t empty_key_size = TrimmedSize(this->GetKeyPrefix(), this->prefix_size_);
+  int space = this->GetSize() * static_cast<int>(slot_size);
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (this->IsSharedSlot(slots, slot_size, i)) {
+      continue;
+    }
+    uint16_t length = SlotKeyLength(slots + i * slot_size);
+    size_t key_length = length > 0 ? this->prefix_size_ + length : empty_key_size;
+    space += static_cast<int>(key_length > prefix_size ? key_length - prefix_size : 0);
+  }
+  return space;
+}
+
+/*
+ * Helper method to compute how many bytes are left from slots to the end of
+ * the page besides the given fences. A nullptr fence is unbounded.
+ */
+int BPlusTreePage::GetCapacityWithFences(const char *slots, size_t key_size, const char *low_fence,
+                                         const char *high_fence) const {
+  return static_cast<int>(reinterpret_cast<const char *>(this) + PAGE_SIZE - slots -
+                          FenceSize(low_fence, high_fence, key_size));
+}
+
 }  // namespace bustub
@@ -10,37 +10,110 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "storage/page/hash_table_block_page.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 KeyType HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
-  return {};
+  return this->keys_[bucket_ind];
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
-  return {};
+  return this->values_[bucket_ind];
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                   uint8_t fingerprint) {
+  static_assert(sizeof(HashTableBlockPage) <= PAGE_SIZE, "the block does not fit in a page");
+  char mask = static_cast<char>(1 << (bucket_ind % 8));
+  // whoever sets the occupied bit first owns the slot
+  if ((this->occupied_[bucket_ind / 8].fetch_or(mask) & mask) != 0) {
+    return false;
+  }
+  this->keys_[bucket_ind] = key;
+  this->values_[bucket_ind] = value;
+  this->fingerprints_[bucket_ind] = fingerprint;
+  this->readable_[bucket_ind / 8].fetch_or(mask);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
-  return false;
+void HASH_TABLE_BLOCK_TYPE::Replace(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                    uint8_t fingerprint) {
+  this->keys_[bucket_ind] = key;
+  this->values_[bucket_ind] = value;
+  this->fingerprints_[bucket_ind] = fingerprint;
+  this->readable_[bucket_ind / 8].fetch_or(static_cast<char>(1 << (bucket_ind % 8)));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  // the slot stays occupied as a tombstone, so probes for the keys after it go on past it
+  this->fingerprints_[bucket_ind] = 0;
+  this->readable_[bucket_ind / 8].fetch_and(static_cast<char>(~(1 << (bucket_ind % 8))));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-  return false;
+  return (this->occupied_[bucket_ind / 8].load() & (1 << (bucket_ind % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-  return false;
+  return (this->readable_[bucket_ind / 8].load() & (1 << (bucket_ind % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BLOCK_TYPE::MatchFingerprints(slot_offset_t group, uint8_t fingerprint) const {
+  const uint8_t *fingerprints = this->fingerprints_ + group;
+#if defined(__AVX2__)
+  __m256i group_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints));
+  __m256i match = _mm256_cmpeq_epi8(group_vec, _mm256_set1_epi8(static_cast<char>(fingerprint)));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(match));
+#elif defined(__SSE2__)
+  const __m128i fingerprint_vec = _mm_set1_epi8(static_cast<char>(fingerprint));
+  __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints));
+  __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints + 16));
+  auto low_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, fingerprint_vec)));
+  auto high_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, fingerprint_vec)));
+  return low_mask | high_mask << 16;
+#else
+  uint32_t mask = 0;
+  for (slot_offset_t i = 0; i < FINGERPRINT_GROUP_SIZE; i++) {
+    mask |= static_cast<uint32_t>(fingerprints[i] == fingerprint) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+slot_offset_t HASH_TABLE_BLOCK_TYPE::FindUnoccupied(slot_offset_t begin, slot_offset_t end) const {
+  slot_offset_t i = begin;
+  while (i < end) {
+    if (i % 8 == 0 && i + 8 <= end && this->occupied_[i / 8].load() == static_cast<char>(0xFF)) {
+      i += 8;
+    } else if (!this->IsOccupied(i)) {
+      return i;
+    } else {
+      i++;
+    }
+  }
+  return end;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint8_t HASH_TABLE_BLOCK_TYPE::Fingerprint(uint64_t hash) {
+  // the table picks the bucket from the low bits, so the top ones tell apart the keys of a bucket
+  return static_cast<uint8_t>(0x80 | hash >> 57);
 }
 
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
@@ -51,4 +124,12 @@ template class HashTableBlockPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBlockPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBlockPage<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class HashTableBlockPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class HashTableBlockPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class HashTableBlockPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class HashTableBlockPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class HashTableBlockPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class HashTableBlockPage<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+template class HashTableBlockPage<NormalizedKey<256>, RID, NormalizedComparator<256>>;
+
 }  // namespace bustub
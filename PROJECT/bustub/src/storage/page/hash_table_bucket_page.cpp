@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.cpp
+//
+// Identification: src/storage/page/hash_table_bucket_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_bucket_page.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
+  bool found = false;
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && this->IsOccupied(i); i++) {
+    if (this->IsReadable(i) && cmp(this->array_[i].first, key) == 0) {
+      result->push_back(this->array_[i].second);
+      found = true;
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) {
+  int64_t free_slot = -1;
+  uint32_t i = 0;
+  for (; i < BUCKET_ARRAY_SIZE && this->IsOccupied(i); i++) {
+    if (!this->IsReadable(i)) {
+      free_slot = free_slot == -1 ? i : free_slot;
+    } else if (cmp(this->array_[i].first, key) == 0 && this->array_[i].second == value) {
+      // the same pair twice is not allowed
+      return false;
+    }
+  }
+  if (free_slot == -1) {
+    if (i == BUCKET_ARRAY_SIZE) {
+      return false;
+    }
+    free_slot = i;
+  }
+  this->array_[free_slot] = MappingType(key, value);
+  this->occupied_[free_slot / 8] |= static_cast<char>(1 << (free_slot % 8));
+  this->readable_[free_slot / 8] |= static_cast<char>(1 << (free_slot % 8));
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) {
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && this->IsOccupied(i); i++) {
+    if (this->IsReadable(i) && cmp(this->array_[i].first, key) == 0 && this->array_[i].second == value) {
+      this->RemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const {
+  return this->array_[bucket_idx].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const {
+  return this->array_[bucket_idx].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  this->readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const {
+  return (this->occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const {
+  return (this->readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() const {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && this->IsOccupied(i); i++) {
+    count += static_cast<uint32_t>(this->IsReadable(i));
+  }
+  return count;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsFull() const {
+  return this->NumReadable() == BUCKET_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsEmpty() const {
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && this->IsOccupied(i); i++) {
+    if (this->IsReadable(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Reset() {
+  memset(this->occupied_, 0, sizeof(this->occupied_));
+  memset(this->readable_, 0, sizeof(this->readable_));
+}
+
+template class HashTableBucketPage<int, int, IntComparator>;
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cassert>
+#include <unordered_map>
+
+#include "storage/page/hash_table_directory_page.h"
+
+namespace bustub {
+page_id_t HashTableDirectoryPage::GetPageId() const { return this->page_id_; }
+
+void HashTableDirectoryPage::SetPageId(bustub::page_id_t page_id) { this->page_id_ = page_id; }
+
+lsn_t HashTableDirectoryPage::GetLSN() const { return this->lsn_; }
+
+void HashTableDirectoryPage::SetLSN(lsn_t lsn) { this->lsn_ = lsn; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepth() const { return this->global_depth_; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const { return (1U << this->global_depth_) - 1; }
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(this->Size() * 2 <= DIRECTORY_ARRAY_SIZE);
+  uint32_t size = this->Size();
+  for (uint32_t i = 0; i < size; i++) {
+    this->bucket_page_ids_[size + i] = this->bucket_page_ids_[i];
+    this->local_depths_[size + i] = this->local_depths_[i];
+  }
+  this->global_depth_++;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  assert(this->CanShrink());
+  this->global_depth_--;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (this->global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < this->Size(); i++) {
+    if (this->local_depths_[i] == this->global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t HashTableDirectoryPage::Size() const { return 1U << this->global_depth_; }
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const {
+  return this->bucket_page_ids_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  this->bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const { return this->local_depths_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  assert(local_depth <= this->global_depth_);
+  this->local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  uint32_t local_depth = this->local_depths_[bucket_idx];
+  if (local_depth == 0) {
+    return bucket_idx;
+  }
+  return (bucket_idx & ((1U << local_depth) - 1)) ^ (1U << (local_depth - 1));
+}
+
+void HashTableDirectoryPage::VerifyIntegrity() const {
+  std::unordered_map<page_id_t, uint32_t> references;
+  std::unordered_map<page_id_t, uint32_t> local_depths;
+  for (uint32_t i = 0; i < this->Size(); i++) {
+    page_id_t page_id = this->bucket_page_ids_[i];
+    assert(this->local_depths_[i] <= this->global_depth_);
+    assert(local_depths.count(page_id) == 0 || local_depths[page_id] == this->local_depths_[i]);
+    // the entries of a bucket agree on its lowest local depth bits
+    assert(this->bucket_page_ids_[i & ((1U << this->local_depths_[i]) - 1)] == page_id);
+    local_depths[page_id] = this->local_depths_[i];
+    references[page_id]++;
+  }
+  for (const auto &reference : references) {
+    assert(reference.second == 1U << (this->global_depth_ - local_depths[reference.first]));
+    (void)reference;
+  }
+}
+
+}  // namespace bustub
@@ -10,25 +10,38 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstddef>
+
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
-page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) { return 0; }
+page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) {
+  assert(index < this->next_ind_);
+  return this->block_page_ids_[index];
+}
+
+page_id_t HashTableHeaderPage::GetPageId() const { return this->page_id_; }
 
-page_id_t HashTableHeaderPage::GetPageId() const { return 0; }
+void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) { this->page_id_ = page_id; }
 
-void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) {}
+lsn_t HashTableHeaderPage::GetLSN() const { return this->lsn_; }
 
-lsn_t HashTableHeaderPage::GetLSN() const { return 0; }
+void HashTableHeaderPage::SetLSN(lsn_t lsn) { this->lsn_ = lsn; }
 
-void HashTableHeaderPage::SetLSN(lsn_t lsn) {}
+void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+  assert(this->next_ind_ < MaxBlocks());
+  this->block_page_ids_[this->next_ind_] = page_id;
+  this->next_ind_++;
+}
 
-void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {}
+size_t HashTableHeaderPage::NumBlocks() { return this->next_ind_; }
 
-size_t HashTableHeaderPage::NumBlocks() { return 0; }
+size_t HashTableHeaderPage::MaxBlocks() {
+  return (PAGE_SIZE - offsetof(HashTableHeaderPage, block_page_ids_)) / sizeof(page_id_t);
+}
 
-void HashTableHeaderPage::SetSize(size_t size) {}
+void HashTableHeaderPage::SetSize(size_t size) { this->size_ = size; }
 
-size_t HashTableHeaderPage::GetSize() const { return 0; }
+size_t HashTableHeaderPage::GetSize() const { return this->size_; }
 
 }  // namespace bustub
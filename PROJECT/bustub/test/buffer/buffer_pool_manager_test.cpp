@@ -11,9 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "common/logger.h"
 #include "gtest/gtest.h"
 
@@ -210,4 +214,65 @@ TEST(BufferPoolManagerTest, FlushAllPageTest) {
   delete disk_manager;
 }
 
+TEST(BufferPoolManagerTest, PrefetchPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: 20 pages are written out, the buffer pool then holds the last 10 of them.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 20; i++) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: prefetched pages are read in the background, and fetching them reads nothing more.
+  int reads_before = disk_manager->GetNumReads();
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    bpm->PrefetchPage(page_id);
+  }
+  // pages in the buffer pool are not read again
+  bpm->PrefetchPage(19);
+  for (int wait = 0; wait < 1000 && disk_manager->GetNumReads() < reads_before + 4; wait++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(reads_before + 4, disk_manager->GetNumReads());
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(reads_before + 4, disk_manager->GetNumReads());
+
+  // Scenario: with every frame pinned, prefetching reads nothing and fetching still works once frames are free.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    pinned.push_back(page_id_temp);
+  }
+  reads_before = disk_manager->GetNumReads();
+  bpm->PrefetchPage(5);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(reads_before, disk_manager->GetNumReads());
+  for (auto page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  Page *page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 5"));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
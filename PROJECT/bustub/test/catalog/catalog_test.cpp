@@ -16,6 +16,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
 
@@ -57,4 +58,51 @@ TEST(CatalogTest, CreateTableTest) {
   delete disk_manager;
 }
 
+
+// a hash index reports its type, and one that cannot be built is not added
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateHashIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  // the header page, where the B+ tree index writes its root
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  std::string table_name = "potato";
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, table_name, schema);
+  for (int i = 0; i < 100; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+  }
+
+  auto *tree_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn, "tomato", table_name,
+                                                                                   schema, schema, {0}, 8);
+  EXPECT_NE(tree_info->index_->ToString().find("Type = B+Tree"), std::string::npos);
+  auto *hash_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "tomato_hash", table_name, schema, schema, {0}, 8, true, {}, IndexType::Hash);
+  EXPECT_NE(hash_info->index_->ToString().find("Type = Hash"), std::string::npos);
+  std::vector<RID> rids;
+  Tuple key({ValueFactory::GetIntegerValue(42)}, hash_info->index_->GetKeySchema());
+  hash_info->index_->ScanKey(key, &rids, &txn);
+  EXPECT_EQ(1, rids.size());
+
+  // hash indexes hash the whole key, they have no INCLUDE columns
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                   &txn, "tomato_include", table_name, schema, schema, {0}, 8, true, {1}, IndexType::Hash)),
+               Exception);
+  EXPECT_EQ(2, catalog->GetTableIndexes(table_name).size());
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
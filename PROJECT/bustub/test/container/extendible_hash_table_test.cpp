@@ -0,0 +1,292 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+#include "container/hash/extendible_hash_table.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+  ht.VerifyIntegrity();
+
+  // insert one more value for each key, duplicate pairs are not allowed
+  for (int i = 0; i < 5; i++) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    std::sort(res.begin(), res.end());
+    ASSERT_EQ(2, res.size());
+    EXPECT_EQ(i, res[0]);
+    EXPECT_EQ(2 * i + 1, res[1]);
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete all values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    EXPECT_TRUE(ht.Remove(nullptr, i, 2 * i + 1));
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// buckets split as the table grows, and merge back as it empties
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 5);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    if (i % 1000 == 0) {
+      ht.VerifyIntegrity();
+    }
+  }
+  // the empty buckets merged back into one
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  for (int i = 0; i < num_keys; i += 7) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// a bucket full of one key cannot split, the insert that finds no room fails rather than splitting it in vain
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, FullBucketTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  int num_values = 0;
+  bool full = false;
+  while (!full && num_values < 10000) {
+    try {
+      EXPECT_TRUE(ht.Insert(nullptr, 7, num_values));
+      num_values++;
+    } catch (Exception &e) {
+      full = true;
+    }
+  }
+  EXPECT_TRUE(full);
+  EXPECT_GT(num_values, 0);
+  // failing is not the same as the pair being there already
+  EXPECT_FALSE(ht.Insert(nullptr, 7, 0));
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  ht.VerifyIntegrity();
+
+  // other keys split the bucket away from the full one
+  for (int i = 0; i < 20; i++) {
+    if (i != 7) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    }
+  }
+  ht.VerifyIntegrity();
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 7, &res));
+  EXPECT_EQ(num_values, res.size());
+  EXPECT_THROW(ht.Insert(nullptr, 7, num_values), Exception);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// threads insert, look up and remove their own keys while buckets split under them
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, i, &res);
+        EXPECT_EQ(1, res.size());
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, i, &res), i % 3 != 0);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Inserts keys 0 to num_keys - 1 into ht and looks each of them up.
+ * @return the microseconds the inserts and the lookups took
+ */
+template <typename HashTable>
+std::pair<int64_t, int64_t> InsertAndLookUp(HashTable *ht, int num_keys) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht->Insert(nullptr, i, i));
+  }
+  auto inserted = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht->GetValue(nullptr, i, &res));
+    EXPECT_EQ(res, std::vector<int>{i});
+  }
+  auto looked_up = std::chrono::steady_clock::now();
+  return {std::chrono::duration_cast<std::chrono::microseconds>(inserted - start).count(),
+          std::chrono::duration_cast<std::chrono::microseconds>(looked_up - inserted).count()};
+}
+
+/*
+ * Inserts the same keys into an extendible hash table and into linear probing
+ * hash tables that start at 1000 buckets, and at a few more buckets than keys,
+ * and finds every key in each of them
+ */
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, LargeWorkloadTest) {
+  const int num_keys = 50000;
+  {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+    ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+    InsertAndLookUp(&ht, num_keys);
+    EXPECT_GT(ht.GetGlobalDepth(), 0U);
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+  for (size_t num_buckets : {static_cast<size_t>(1000), static_cast<size_t>(num_keys * 1.1)}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), num_buckets, HashFunction<int>());
+    InsertAndLookUp(&ht, num_keys);
+    EXPECT_GE(ht.GetSize(), static_cast<size_t>(num_keys));
+    EXPECT_GE(ht.GetAverageProbeLength(), 1);
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+}
+
+/*
+ * Prints the insert and lookup throughput of the tables of LargeWorkloadTest,
+ * and the probe length of linear probing, which grows with the load factor
+ */
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, DISABLED_BenchmarkTest) {
+  const int num_keys = 50000;
+  auto print = [](const std::string &name, std::pair<int64_t, int64_t> us) {
+    std::cout << name << ": " << num_keys * 1000 / std::max<int64_t>(us.first, 1) << " inserts/ms, "
+              << num_keys * 1000 / std::max<int64_t>(us.second, 1) << " lookups/ms";
+  };
+
+  {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+    ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+    print("extendible", InsertAndLookUp(&ht, num_keys));
+    std::cout << ", 1 bucket per lookup, global depth " << ht.GetGlobalDepth() << std::endl;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+  for (size_t num_buckets : {static_cast<size_t>(1000), static_cast<size_t>(num_keys * 1.1)}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), num_buckets, HashFunction<int>());
+    print("linear probing from " + std::to_string(num_buckets) + " buckets", InsertAndLookUp(&ht, num_keys));
+    double load_factor = static_cast<double>(num_keys) / ht.GetSize();
+    std::cout << ", " << ht.GetAverageProbeLength() << " buckets per lookup at load factor " << load_factor
+              << std::endl;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+}
+
+}  // namespace bustub
@@ -17,13 +17,14 @@
 #include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/index/generic_key.h"
 #include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -61,7 +62,7 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -71,9 +72,10 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   auto block_page =
       reinterpret_cast<HashTableBlockPage<int, int, IntComparator> *>(bpm->NewPage(&block_page_id, nullptr)->GetData());
 
-  // insert a few (key, value) pairs
+  // insert a few (key, value) pairs, with the fingerprints of hashes whose top bits are i
+  using BlockPage = HashTableBlockPage<int, int, IntComparator>;
   for (unsigned i = 0; i < 10; i++) {
-    block_page->Insert(i, i, i);
+    block_page->Insert(i, i, i, BlockPage::Fingerprint(static_cast<uint64_t>(i) << 57));
   }
 
   // check for the inserted pairs
@@ -103,6 +105,18 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
     }
   }
 
+  // removed pairs lose their fingerprint, and the pairs end at the first slot never occupied
+  EXPECT_EQ(1U << 4, block_page->MatchFingerprints(0, BlockPage::Fingerprint(static_cast<uint64_t>(4) << 57)));
+  EXPECT_EQ(0U, block_page->MatchFingerprints(0, BlockPage::Fingerprint(static_cast<uint64_t>(5) << 57)));
+  EXPECT_EQ(10U, block_page->FindUnoccupied(0, 15));
+  EXPECT_EQ(10U, block_page->FindUnoccupied(3, 10));
+
+  // the last slot is within the page
+  slot_offset_t last = HashTableBlockArraySize<int, int>() - 1;
+  block_page->Insert(last, -1, -2, BlockPage::Fingerprint(0));
+  EXPECT_EQ(-1, block_page->KeyAt(last));
+  EXPECT_EQ(-2, block_page->ValueAt(last));
+
   // unpin the header page now that we are done
   bpm->UnpinPage(block_page_id, true, nullptr);
   disk_manager->ShutDown();
@@ -111,4 +125,32 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   delete bpm;
 }
 
+/*
+ * The keys and the values of a block fill its page, and a pair that std::pair
+ * would pad takes none.
+ */
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BlockLayoutTest) {
+  EXPECT_LE(sizeof(HashTableBlockPage<int, int, IntComparator>), PAGE_SIZE);
+  EXPECT_LE(sizeof(HashTableBlockPage<GenericKey<4>, RID, GenericComparator<4>>), PAGE_SIZE);
+  EXPECT_LE(sizeof(HashTableBlockPage<GenericKey<64>, RID, GenericComparator<64>>), PAGE_SIZE);
+  // the bitmaps, fingerprints and arrays of one more slot would not fit
+  size_t num_slots = HashTableBlockArraySize<int, int>();
+  EXPECT_GT(2 * (num_slots / 8 + 1) + (num_slots / 32 * 32 + 32) + (num_slots + 1) * 2 * sizeof(int), PAGE_SIZE);
+  // a 4 byte key with an 8 byte value is 16 bytes as a std::pair, 12 here
+  EXPECT_GT((HashTableBlockArraySize<GenericKey<4>, int64_t>()), PAGE_SIZE / 16);
+}
+
+/*
+ * Prints the slots per block of the keys of indexes.
+ */
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, DISABLED_BlockSlotsTest) {
+  std::cout << "slots per block: int/int " << HashTableBlockArraySize<int, int>() << ", GenericKey<4>/RID "
+            << HashTableBlockArraySize<GenericKey<4>, RID>() << ", GenericKey<8>/RID "
+            << HashTableBlockArraySize<GenericKey<8>, RID>() << ", GenericKey<16>/RID "
+            << HashTableBlockArraySize<GenericKey<16>, RID>() << ", GenericKey<64>/RID "
+            << HashTableBlockArraySize<GenericKey<64>, RID>() << std::endl;
+}
+
 }  // namespace bustub
@@ -10,18 +10,26 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <random>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "common/logger.h"
 #include "container/hash/linear_probe_hash_table.h"
+#include "container/hash/robin_hood_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/b_plus_tree_test_util.h"  // NOLINT
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
 
@@ -104,4 +112,559 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// a table of 10 buckets grows as the entries come, and keeps them all
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, -i - 1));
+  }
+  EXPECT_GE(ht.GetSize(), 2 * num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    if (i % 2 == 0) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    }
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    std::sort(res.begin(), res.end());
+    if (i % 2 == 0) {
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(-i - 1, res[0]);
+    } else {
+      ASSERT_EQ(2, res.size());
+      EXPECT_EQ(-i - 1, res[0]);
+      EXPECT_EQ(i, res[1]);
+    }
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, num_keys, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// threads insert, look up and remove their own keys while the table grows under them
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+
+  const int num_threads = 4;
+  const int keys_per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, i, &res);
+        EXPECT_EQ(1, res.size());
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, i, &res), i % 3 != 0);
+    EXPECT_EQ(res.size(), i % 3 == 0 ? 0 : 1);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * A reader looks up every key inserted so far while the table grows from 100 to
+ * 51200 buckets, 9 resizes whose entries move while it reads: it finds each of
+ * them exactly once.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, IncrementalResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+
+  const int num_keys = 30000;
+  std::atomic<int> inserted{0};
+  std::thread reader([&]() {
+    int key = 0;
+    while (inserted < num_keys) {
+      if (key >= inserted) {
+        key = 0;
+        continue;
+      }
+      std::vector<int> res;
+      EXPECT_TRUE(ht.GetValue(nullptr, key, &res));
+      ASSERT_EQ(1, res.size()) << "key " << key;
+      EXPECT_EQ(key, res[0]);
+      key++;
+    }
+  });
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    inserted++;
+  }
+  reader.join();
+  EXPECT_GE(ht.GetSize(), num_keys);
+
+  // removes reach the entries wherever they are
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, i, &res), i % 2 == 1);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Prints the slowest insert while the table grows from 100 to 51200 buckets,
+ * which does not rehash the whole table.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_IncrementalResizeCostTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+  const int num_keys = 30000;
+  int64_t slowest_ns = 0;
+  for (int i = 0; i < num_keys; i++) {
+    auto start = std::chrono::steady_clock::now();
+    ht.Insert(nullptr, i, i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    slowest_ns = std::max<int64_t>(slowest_ns, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+  std::cout << "slowest insert: " << slowest_ns / 1000 << " us, table of " << ht.GetSize() << " buckets" << std::endl;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * A table whose probes reach 1 bucket fills long before it is full, often
+ * while the entries of the last resize are still moving. A resize then copies
+ * both tables into one, twice as large again while they do not fit, until the
+ * table cannot grow and inserts fail: every pair inserted before is found.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, FailedResizeTest) {
+  class ShortProbeHashTable : public LinearProbeHashTable<int, int, IntComparator> {
+   public:
+    ShortProbeHashTable(BufferPoolManager *bpm, size_t num_buckets)
+        : LinearProbeHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), num_buckets,
+                                                        HashFunction<int>()) {
+      this->max_probe_length_ = 1;
+    }
+  };
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  ShortProbeHashTable ht(bpm, 64);
+
+  // consecutive keys spread evenly over the buckets, random ones collide
+  std::mt19937 generator(42);
+  std::vector<int> inserted;
+  for (int i = 0; i < 2000; i++) {
+    int key = static_cast<int>(generator());
+    if (ht.Insert(nullptr, key, key)) {
+      inserted.push_back(key);
+    }
+  }
+  EXPECT_LT(inserted.size(), 2000);
+  for (int key : inserted) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, key, &res)) << "key " << key;
+    EXPECT_EQ(1, res.size());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Bulk inserts pairs into a table that is moving its entries after a resize,
+ * some of them there already or repeated, and finds each pair once.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, BulkInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+
+  const int num_keys = 30000;
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < num_keys; i++) {
+    pairs.emplace_back(i, i);
+  }
+  pairs.emplace_back(7, 7);
+  pairs.emplace_back(7, 8);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+  // the table resizes with most of its entries left to move
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_EQ(ht.BulkInsert(nullptr, pairs), num_keys - 100 + 1);
+  EXPECT_GE(ht.GetSize(), 2 * pairs.size());
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    std::sort(res.begin(), res.end());
+    ASSERT_EQ(i == 7 ? 2 : 1, res.size()) << "key " << i;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Prints the time per pair of bulk inserting pairs into a table, against
+ * inserting them one by one.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_BulkInsertCostTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+
+  const int num_keys = 30000;
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < num_keys; i++) {
+    pairs.emplace_back(i, i);
+  }
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+  auto start = std::chrono::steady_clock::now();
+  ht.BulkInsert(nullptr, pairs);
+  auto bulk_elapsed = std::chrono::steady_clock::now() - start;
+  LinearProbeHashTable<int, int, IntComparator> one_by_one("blah", bpm, IntComparator(), 100, HashFunction<int>());
+  start = std::chrono::steady_clock::now();
+  for (auto &pair : pairs) {
+    one_by_one.Insert(nullptr, pair.first, pair.second);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "bulk insert: " << std::chrono::duration_cast<std::chrono::nanoseconds>(bulk_elapsed).count() / num_keys
+            << " ns/pair, one by one: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / num_keys << " ns/pair"
+            << std::endl;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Bulk inserts pairs into a table one block at a time: the probe of a pair
+ * runs past its block only near the end of the block, few pairs are left to be
+ * inserted one by one.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, BulkInsertSpillTest) {
+  class SpillCountingHashTable : public LinearProbeHashTable<int, int, IntComparator> {
+   public:
+    explicit SpillCountingHashTable(BufferPoolManager *bpm)
+        : LinearProbeHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), 100, HashFunction<int>()) {}
+    size_t GetNumBulkSpilled() const { return this->num_bulk_spilled_; }
+  };
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  const int num_keys = 30000;
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < num_keys; i++) {
+    pairs.emplace_back(i, i);
+  }
+  SpillCountingHashTable ht(bpm);
+  EXPECT_EQ(ht.BulkInsert(nullptr, pairs), num_keys);
+  EXPECT_LT(ht.GetNumBulkSpilled(), num_keys / 100);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size()) << "key " << i;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Looks up keys that are in a table at a 0.9 load factor and keys that are
+ * not, which probe up to the next never occupied bucket.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, ProbeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  const int num_keys = 18000;
+  LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("blah", bpm, comparator, num_keys * 10 / 9,
+                                                                    HashFunction<GenericKey<8>>());
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(ht.Insert(nullptr, index_key, RID(0, key)));
+  }
+  EXPECT_EQ(ht.GetSize(), num_keys * 10 / 9);
+
+  for (bool hits : {true, false}) {
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(hits ? key : num_keys + key);
+      std::vector<RID> res;
+      EXPECT_EQ(ht.GetValue(nullptr, index_key, &res), hits);
+      if (hits) {
+        ASSERT_EQ(1, res.size());
+        EXPECT_EQ(key, res[0].GetSlotNum());
+      }
+    }
+  }
+
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Prints the time per lookup of keys that are in a table at a 0.9 load factor
+ * and of keys that are not.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_ProbeCostTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  const int num_keys = 18000;
+  LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("blah", bpm, comparator, num_keys * 10 / 9,
+                                                                    HashFunction<GenericKey<8>>());
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    ht.Insert(nullptr, index_key, RID(0, key));
+  }
+  for (bool hits : {true, false}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(hits ? key : num_keys + key);
+      std::vector<RID> res;
+      ht.GetValue(nullptr, index_key, &res);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (hits ? "hits: " : "misses: ")
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / num_keys << " ns/lookup"
+              << std::endl;
+  }
+
+  delete key_schema;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Threads insert, look up and remove their own keys in a Robin Hood table at a
+ * 0.9 load factor, which moves entries of other threads as they insert. No
+ * entry ends up further than HASH_TABLE_MAX_PROBE_LENGTH buckets from its
+ * hash, and the removed buckets are taken again.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, RobinHoodTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+
+  const int num_threads = 4;
+  const int keys_per_thread = 4500;
+  const int num_keys = num_threads * keys_per_thread;
+  RobinHoodHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), num_keys * 10 / 9,
+                                                 HashFunction<int>());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_keys; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        EXPECT_FALSE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, i, &res);
+        EXPECT_EQ(1, res.size());
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, i, &res), i % 3 != 0);
+    EXPECT_EQ(res.size(), i % 3 == 0 ? 0 : 1);
+  }
+  EXPECT_LE(ht.GetProbeLengthHistogram().size(), HASH_TABLE_MAX_PROBE_LENGTH);
+
+  // the removed pairs go back into the tombstones, without growing the table
+  size_t size = ht.GetSize();
+  for (int i = 0; i < num_keys; i += 3) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_EQ(size, ht.GetSize());
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+  EXPECT_LE(ht.GetProbeLengthHistogram().size(), HASH_TABLE_MAX_PROBE_LENGTH);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Inserts the same keys into linear probing and Robin Hood hash tables that
+ * start at 1000 buckets, and at a few more buckets than keys, and prints the
+ * insert and lookup throughput of each, and the probe lengths, which grow with
+ * the load factor under linear probing, while the longest Robin Hood probe
+ * stays short. Run it with --gtest_also_run_disabled_tests.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_ProbeLengthBenchmarkTest) {
+  const int num_keys = 50000;
+  // the share of the entries found after probing 1, 2, 3-4, 5-8, ... buckets
+  auto print_histogram = [](const std::vector<size_t> &histogram) {
+    size_t entries = 0;
+    for (size_t count : histogram) {
+      entries += count;
+    }
+    std::cout << "  probe lengths:";
+    for (size_t low = 1; low <= histogram.size(); low *= 2) {
+      size_t high = std::min(2 * low - 1, histogram.size());
+      size_t count = 0;
+      for (size_t length = low; length <= high; length++) {
+        count += histogram[length - 1];
+      }
+      std::cout << " " << low;
+      if (high > low) {
+        std::cout << "-" << high;
+      }
+      std::cout << ": " << 100.0 * count / std::max<size_t>(entries, 1) << "%";
+    }
+    std::cout << std::endl;
+  };
+
+  for (bool robin_hood : {false, true}) {
+    for (size_t num_buckets : {static_cast<size_t>(1000), static_cast<size_t>(num_keys * 1.1)}) {
+      auto *disk_manager = new DiskManager("test.db");
+      auto *bpm = new BufferPoolManager(BUFFER_POOL_SIZE * 100, disk_manager);
+      std::unique_ptr<LinearProbeHashTable<int, int, IntComparator>> ht;
+      if (robin_hood) {
+        ht = std::make_unique<RobinHoodHashTable<int, int, IntComparator>>("blah", bpm, IntComparator(), num_buckets,
+                                                                           HashFunction<int>());
+      } else {
+        ht = std::make_unique<LinearProbeHashTable<int, int, IntComparator>>("blah", bpm, IntComparator(),
+                                                                             num_buckets, HashFunction<int>());
+      }
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_keys; i++) {
+        EXPECT_TRUE(ht->Insert(nullptr, i, i));
+      }
+      auto inserted = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_keys; i++) {
+        std::vector<int> res;
+        EXPECT_TRUE(ht->GetValue(nullptr, i, &res));
+      }
+      auto looked_up = std::chrono::steady_clock::now();
+      auto insert_us = std::chrono::duration_cast<std::chrono::microseconds>(inserted - start).count();
+      auto lookup_us = std::chrono::duration_cast<std::chrono::microseconds>(looked_up - inserted).count();
+      double load_factor = static_cast<double>(num_keys) / ht->GetSize();
+      std::vector<size_t> histogram = ht->GetProbeLengthHistogram();
+      std::cout << (robin_hood ? "robin hood" : "linear probing") << " from " << num_buckets << " buckets: "
+                << num_keys * 1000 / std::max<int64_t>(insert_us, 1) << " inserts/ms, "
+                << num_keys * 1000 / std::max<int64_t>(lookup_us, 1) << " lookups/ms, " << ht->GetAverageProbeLength()
+                << " buckets per lookup, " << histogram.size() << " at most, at load factor " << load_factor
+                << std::endl;
+      print_histogram(histogram);
+      ht.reset();
+      disk_manager->ShutDown();
+      remove("test.db");
+      delete disk_manager;
+      delete bpm;
+    }
+  }
+}
+
+/*
+ * Keys equal byte by byte hash the same whatever their size, and consecutive
+ * integers spread evenly over the buckets, and over the fingerprints, which
+ * come from the top bits of the hash.
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, HashFunctionTest) {
+  HashFunction<GenericKey<64>> generic_hash_fn;
+  GenericKey<64> key;
+  GenericKey<64> same_key;
+  key.SetFromInteger(42);
+  same_key.SetFromInteger(42);
+  EXPECT_EQ(generic_hash_fn.GetHash(key), generic_hash_fn.GetHash(same_key));
+  // a difference in the last byte counts too
+  same_key.data_[63] = 1;
+  EXPECT_NE(generic_hash_fn.GetHash(key), generic_hash_fn.GetHash(same_key));
+
+  const int num_keys = 100000;
+  const int num_buckets = 1000;
+  HashFunction<int> int_hash_fn;
+  std::vector<int> buckets(num_buckets);
+  std::vector<int> fingerprints(128);
+  for (int i = 0; i < num_keys; i++) {
+    uint64_t hash = int_hash_fn.GetHash(i);
+    buckets[hash % num_buckets]++;
+    fingerprints[hash >> 57]++;
+  }
+  // 100 keys per bucket on average, and 781 per fingerprint
+  EXPECT_LT(*std::max_element(buckets.begin(), buckets.end()), 150);
+  EXPECT_GT(*std::min_element(buckets.begin(), buckets.end()), 50);
+  EXPECT_LT(*std::max_element(fingerprints.begin(), fingerprints.end()), 1000);
+  EXPECT_GT(*std::min_element(fingerprints.begin(), fingerprints.end()), 600);
+}
+
 }  // namespace bustub
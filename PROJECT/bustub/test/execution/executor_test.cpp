@@ -18,7 +18,9 @@
 #include <vector>
 
 #include "execution/plans/delete_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/table_generator.h"
@@ -81,6 +83,7 @@ class ExecutorTest : public ::testing::Test {
   TransactionManager *GetTxnManager() { return txn_mgr_.get(); }
   Catalog *GetCatalog() { return catalog_.get(); }
   BufferPoolManager *GetBPM() { return bpm_.get(); }
+  DiskManager *GetDiskManager() { return disk_manager_.get(); }
   LockManager *GetLockManager() { return lock_manager_.get(); }
 
   // The below helper functions are useful for testing.
@@ -335,6 +338,394 @@ TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleIndexRangeScanTest) {
+  // INSERT INTO empty_table2 VALUES (0, 0), (1, 1), ..., (99, 9)
+  std::vector<std::vector<Value>> raw_vals;
+  for (int i = 0; i < 100; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  // colB repeats, so the index is not unique
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colB", "empty_table2", table_info->schema_, *key_schema, {1}, 8, false);
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // SELECT colA, colB FROM empty_table2 WHERE colB > 3 AND colB <= 6 AND colA < 50
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto const50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  auto predicate = MakeComparisonExpression(colA, const50, ComparisonType::LessThan);
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  IndexScanPlanNode scan_plan{out_schema,
+                              predicate,
+                              index_info->index_oid_,
+                              {ValueFactory::GetIntegerValue(3)},
+                              {ValueFactory::GetIntegerValue(6)},
+                              false,
+                              true};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 15);
+  int32_t previous_colB = 4;
+  for (auto &tuple : result_set) {
+    auto a = tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+    auto b = tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+    // tuples come in index order
+    ASSERT_LE(previous_colB, b);
+    ASSERT_LE(b, 6);
+    ASSERT_EQ(a % 10, b);
+    ASSERT_LT(a, 50);
+    previous_colB = b;
+  }
+
+  // no bounds scans the whole index
+  IndexScanPlanNode full_scan_plan{out_schema, nullptr, index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleIndexDescendingScanTest) {
+  // INSERT INTO empty_table2 VALUES (0, 0), (1, 1), ..., (999, 9)
+  std::vector<std::vector<Value>> raw_vals;
+  for (int i = 0; i < 1000; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "empty_table2", table_info->schema_, *key_schema, {0}, 8);
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // SELECT colA, colB FROM empty_table2 ORDER BY colA DESC LIMIT 20
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  IndexScanPlanNode scan_plan{out_schema, nullptr, index_info->index_oid_, {}, {}, true, true, true, 20};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 20);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 999 - i);
+  }
+
+  // SELECT colA, colB FROM empty_table2 WHERE colA < 500 AND colB = 3 ORDER BY colA DESC
+  auto const3 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(3));
+  auto predicate = MakeComparisonExpression(colB, const3, ComparisonType::Equal);
+  IndexScanPlanNode bounded_plan{
+      out_schema, predicate, index_info->index_oid_, {}, {ValueFactory::GetIntegerValue(500)}, true, false, true};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&bounded_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 50);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 493 - 10 * i);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexScanBatchTest) {
+  // INSERT INTO empty_table2 VALUES (0, 0), ..., (0, 599), (0, 600), (1, 601), ..., (99, 2599), the duplicates of
+  // each key span the batches of the scan, those of 0 more than a whole batch
+  const int num_rows = 2600;
+  std::vector<std::vector<Value>> raw_vals;
+  for (int i = 0; i < num_rows; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i < 600 ? 0 : i % 100), ValueFactory::GetIntegerValue(i)});
+  }
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "empty_table2", table_info->schema_, *key_schema, {0}, 8, false);
+
+  // SELECT colA, colB FROM empty_table2 ORDER BY colA, every row once
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto check = [&](const std::vector<Tuple> &result_set, bool descending) {
+    std::unordered_set<int32_t> seen;
+    for (size_t i = 0; i < result_set.size(); i++) {
+      auto a = result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+      auto b = result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+      ASSERT_EQ(a, b < 600 ? 0 : b % 100);
+      ASSERT_TRUE(seen.insert(b).second);
+      if (i > 0) {
+        auto prev = result_set[i - 1].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+        ASSERT_TRUE(descending ? prev >= a : prev <= a);
+      }
+    }
+  };
+  IndexScanPlanNode scan_plan{out_schema, nullptr, index_info->index_oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), num_rows);
+  check(result_set, false);
+
+  // SELECT colA, colB FROM empty_table2 WHERE colA <= 50 ORDER BY colA DESC LIMIT 1100
+  IndexScanPlanNode descending_plan{
+      out_schema, nullptr, index_info->index_oid_, {}, {ValueFactory::GetIntegerValue(50)}, true, true, true, 1100};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&descending_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1100);
+  check(result_set, true);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 50);
+  // 20 rows of each key from 50 down to 1, then 100 of 0
+  ASSERT_EQ(result_set[1099].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 0);
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleIndexOnlyScanTest) {
+  // CREATE INDEX index_colA ON test_1 (colA) INCLUDE (colC)
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "test_1", schema, *key_schema, {0}, 8, true, {2});
+  EXPECT_TRUE(index_info->index_->SupportsIndexOnlyScan());
+
+  // SELECT colA, colC FROM test_1 WHERE colA >= 100 AND colA < 200 AND colC < 5000
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto const5000 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5000));
+  auto predicate = MakeComparisonExpression(colC, const5000, ComparisonType::LessThan);
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colC", colC}});
+  std::vector<Value> low_key{ValueFactory::GetIntegerValue(100)};
+  std::vector<Value> high_key{ValueFactory::GetIntegerValue(200)};
+  IndexScanPlanNode table_plan{out_schema, predicate, index_info->index_oid_, low_key, high_key, true, false};
+  IndexScanPlanNode index_only_plan{
+      out_schema, predicate, index_info->index_oid_, low_key, high_key, true, false, false, SIZE_MAX, true};
+
+  std::vector<Tuple> table_result;
+  std::vector<Tuple> index_only_result;
+  GetExecutionEngine()->Execute(&table_plan, &table_result, GetTxn(), GetExecutorContext());
+  GetExecutionEngine()->Execute(&index_only_plan, &index_only_result, GetTxn(), GetExecutorContext());
+  ASSERT_FALSE(table_result.empty());
+  ASSERT_EQ(index_only_result.size(), table_result.size());
+  for (size_t i = 0; i < table_result.size(); i++) {
+    Tuple &tuple = index_only_result[i];
+    ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), table_result[i].GetValue(&schema, 0).GetAs<int32_t>());
+    ASSERT_EQ(tuple.GetValue(&schema, 2).GetAs<int32_t>(), table_result[i].GetValue(&schema, 2).GetAs<int32_t>());
+    ASSERT_LT(tuple.GetValue(&schema, 2).GetAs<int32_t>(), 5000);
+    // the tuples were not read from the table, so the columns the scan does not read are NULL
+    ASSERT_TRUE(tuple.GetValue(&schema, 1).IsNull());
+    ASSERT_FALSE(table_result[i].GetValue(&schema, 1).IsNull());
+  }
+
+  // SELECT colA, colB FROM test_1 WHERE colA >= 100 AND colA < 200 reads colB, which is not in the index
+  auto colB_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  IndexScanPlanNode fetch_plan{
+      colB_schema, nullptr, index_info->index_oid_, low_key, high_key, true, false, false, SIZE_MAX, true};
+  std::vector<Tuple> fetch_result;
+  GetExecutionEngine()->Execute(&fetch_plan, &fetch_result, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(fetch_result.size(), 100);
+  for (auto &tuple : fetch_result) {
+    ASSERT_FALSE(tuple.GetValue(&schema, 1).IsNull());
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleNestedIndexJoinTest) {
+  // INSERT INTO empty_table2 VALUES (0, 0), ..., (199, 9), (0, 0), ..., (199, 9)
+  std::vector<std::vector<Value>> raw_vals;
+  for (int i = 0; i < 400; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i % 200), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  auto inner_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  InsertPlanNode insert_plan{std::move(raw_vals), inner_info->oid_};
+  Schema *key_schema = ParseCreateStatement("a integer");
+  GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "empty_table2", inner_info->schema_, *key_schema, {0}, 8, false);
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // SELECT test_1.colA, empty_table2.colB FROM test_1 JOIN empty_table2 ON test_1.colA = empty_table2.colA
+  // WHERE test_1.colA < 300, more outer tuples than are probed in one batch
+  auto outer_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto outer_colA = MakeColumnValueExpression(outer_info->schema_, 0, "colA");
+  auto const300 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(300));
+  auto outer_schema = MakeOutputSchema({{"colA", outer_colA}});
+  SeqScanPlanNode scan_plan{outer_schema, MakeComparisonExpression(outer_colA, const300, ComparisonType::LessThan),
+                            outer_info->oid_};
+  auto join_outer_colA = MakeColumnValueExpression(*outer_schema, 1, "colA");
+  auto join_inner_colA = MakeColumnValueExpression(inner_info->schema_, 0, "colA");
+  auto join_inner_colB = MakeColumnValueExpression(inner_info->schema_, 0, "colB");
+  auto predicate = MakeComparisonExpression(join_inner_colA, join_outer_colA, ComparisonType::Equal);
+  auto out_schema = MakeOutputSchema({{"colA", join_outer_colA}, {"colB", join_inner_colB}});
+  NestedIndexJoinPlanNode join_plan{
+      out_schema, {&scan_plan}, predicate, inner_info->oid_, "index_colA", outer_schema, &inner_info->schema_};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  // every outer tuple below 200 matches twice, in the order of the outer table
+  ASSERT_EQ(result_set.size(), 400);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    auto a = result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+    auto b = result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>();
+    ASSERT_EQ(a, i / 2);
+    ASSERT_EQ(b, a % 10);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleHashIndexTest) {
+  // INSERT INTO empty_table2 VALUES (0, 0), ..., (199, 9), before and after the index is created
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  auto &schema = table_info->schema_;
+  auto insert = [&](int begin, int end) {
+    std::vector<std::vector<Value>> raw_vals;
+    for (int i = begin; i < end; i++) {
+      raw_vals.push_back({ValueFactory::GetIntegerValue(i % 200), ValueFactory::GetIntegerValue(i % 10)});
+    }
+    InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+    GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  };
+  insert(0, 200);
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "empty_table2", schema, *key_schema, {0}, 8, false, {}, IndexType::Hash);
+  ASSERT_FALSE(index_info->index_->SupportsRangeScan());
+  insert(200, 400);
+
+  // SELECT colA, colB FROM empty_table2 WHERE colA = 42
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  IndexScanPlanNode scan_plan{out_schema,
+                              nullptr,
+                              index_info->index_oid_,
+                              {ValueFactory::GetIntegerValue(42)},
+                              {ValueFactory::GetIntegerValue(42)}};
+  ASSERT_TRUE(scan_plan.IsPointLookup());
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  // one from the table the index was built from, one inserted into the index
+  ASSERT_EQ(result_set.size(), 2);
+  for (auto &tuple : result_set) {
+    ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 42);
+    ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(), 2);
+  }
+  // SELECT colA, colB FROM empty_table2 WHERE colA >= 42 cannot use the index
+  IndexScanPlanNode range_plan{out_schema, nullptr, index_info->index_oid_, {ValueFactory::GetIntegerValue(42)}, {}};
+  EXPECT_THROW(GetExecutionEngine()->Execute(&range_plan, &result_set, GetTxn(), GetExecutorContext()), Exception);
+
+  // SELECT test_1.colA, empty_table2.colB FROM test_1 JOIN empty_table2 ON test_1.colA = empty_table2.colA
+  auto outer_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto outer_colA = MakeColumnValueExpression(outer_info->schema_, 0, "colA");
+  auto outer_schema = MakeOutputSchema({{"colA", outer_colA}});
+  SeqScanPlanNode outer_plan{outer_schema, nullptr, outer_info->oid_};
+  auto join_outer_colA = MakeColumnValueExpression(*outer_schema, 1, "colA");
+  auto predicate = MakeComparisonExpression(colA, join_outer_colA, ComparisonType::Equal);
+  auto join_schema = MakeOutputSchema({{"colA", join_outer_colA}, {"colB", colB}});
+  NestedIndexJoinPlanNode join_plan{join_schema, {&outer_plan}, predicate, table_info->oid_, "index_colA",
+                                    outer_schema, &schema};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  // every outer tuple below 200 matches twice
+  ASSERT_EQ(result_set.size(), 400);
+  for (auto &tuple : result_set) {
+    auto a = tuple.GetValue(join_schema, join_schema->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_EQ(tuple.GetValue(join_schema, join_schema->GetColIdx("colB")).GetAs<int32_t>(), a % 10);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BloomFilterTest) {
+  // INSERT INTO empty_table2 VALUES (0, 0), ..., (399, 9), half before the filter is built
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  auto &schema = table_info->schema_;
+  auto insert = [&](int begin, int end) {
+    std::vector<std::vector<Value>> raw_vals;
+    for (int i = begin; i < end; i++) {
+      raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)});
+    }
+    InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+    GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  };
+  insert(0, 200);
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "empty_table2", schema, *key_schema, {0}, 8);
+  Index *index = index_info->index_.get();
+  GetExecutorContext()->GetCatalog()->BuildBloomFilter(GetTxn(), index_info);
+  ASSERT_NE(index->GetBloomFilter(), nullptr);
+  insert(200, 400);
+
+  // whether looking up a key read a page, with the buffer pool emptied first by taking every frame for new pages
+  auto scan_key_reads = [&](int key, size_t *num_rids) {
+    for (size_t i = 0; i < GetBPM()->GetPoolSize(); i++) {
+      page_id_t page_id;
+      GetBPM()->NewPage(&page_id);
+      GetBPM()->UnpinPage(page_id, false);
+    }
+    int reads = GetDiskManager()->GetNumReads();
+    std::vector<RID> rids;
+    index->ScanKey(Tuple({ValueFactory::GetIntegerValue(key)}, key_schema), &rids, GetTxn());
+    *num_rids = rids.size();
+    return GetDiskManager()->GetNumReads() > reads;
+  };
+
+  // keys from before and after the filter was built are found
+  size_t num_rids;
+  for (int i = 0; i < 400; i++) {
+    ASSERT_TRUE(scan_key_reads(i, &num_rids));
+    ASSERT_EQ(num_rids, 1);
+  }
+  // almost every key that is not in the index is answered without reading a page
+  int false_positives = 0;
+  for (int i = 400; i < 1400; i++) {
+    false_positives += scan_key_reads(i, &num_rids) ? 1 : 0;
+    ASSERT_EQ(num_rids, 0);
+  }
+  ASSERT_LT(false_positives, 20);
+
+  // DELETE FROM empty_table2 WHERE colA < 300, the filter is rebuilt without the deleted keys
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto const300 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(300));
+  auto predicate = MakeComparisonExpression(colA, const300, ComparisonType::LessThan);
+  auto out_schema = MakeOutputSchema({{"colA", colA}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+  auto filter = index->GetBloomFilter();
+  DeletePlanNode delete_plan{&scan_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext());
+  ASSERT_NE(index->GetBloomFilter(), filter);
+  ASSERT_FALSE(index->BloomFilterNeedsRebuild());
+  false_positives = 0;
+  for (int i = 0; i < 300; i++) {
+    false_positives += scan_key_reads(i, &num_rids) ? 1 : 0;
+    ASSERT_EQ(num_rids, 0);
+  }
+  ASSERT_LT(false_positives, 20);
+  for (int i = 300; i < 400; i++) {
+    ASSERT_TRUE(scan_key_reads(i, &num_rids));
+    ASSERT_EQ(num_rids, 1);
+  }
+
+  // INSERT INTO empty_table2 VALUES (400, 0), ..., (1999, 9), more keys than the filter was sized for, rebuilds it
+  filter = index->GetBloomFilter();
+  insert(400, 2000);
+  ASSERT_NE(index->GetBloomFilter(), filter);
+  ASSERT_FALSE(index->BloomFilterNeedsRebuild());
+  ASSERT_TRUE(scan_key_reads(1999, &num_rids));
+  ASSERT_EQ(num_rids, 1);
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
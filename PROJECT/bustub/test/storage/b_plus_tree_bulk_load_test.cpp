@@ -0,0 +1,285 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/*
+ * Bulk loads even keys (each 3 times without unique keys), then checks that
+ * the tree answers lookups and keeps working under inserts and removes
+ */
+template <typename KeyType, typename KeyComparator>
+void RunBulkLoadWorkload(int leaf_max_size, int internal_max_size, bool prefix_compression, bool unique_keys) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<KeyType, RID, KeyComparator> tree("bulk", bpm, comparator, leaf_max_size, internal_max_size,
+                                              prefix_compression, unique_keys);
+  Transaction *transaction = new Transaction(0);
+
+  std::vector<std::pair<KeyType, RID>> entries;
+  std::multimap<int64_t, RID> expected;
+  KeyType index_key;
+  for (int64_t key = 0; key < 10000; key += 2) {
+    index_key.SetFromInteger(key);
+    for (int copy = 0; copy < 3; copy++) {
+      entries.emplace_back(index_key, RID(copy, key));
+      if (!unique_keys || copy == 0) {
+        expected.emplace(key, RID(copy, key));
+      }
+    }
+  }
+  tree.BulkLoad(entries, transaction);
+
+  auto check = [&]() {
+    std::vector<RID> rids;
+    for (int64_t key = -1; key <= 10001; key += 3) {
+      index_key.SetFromInteger(key);
+      rids.clear();
+      EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) > 0);
+      EXPECT_EQ(rids.size(), expected.count(key));
+    }
+    auto expected_iterator = expected.begin();
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      ASSERT_NE(expected_iterator, expected.end());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), expected_iterator->first);
+      ++expected_iterator;
+    }
+    EXPECT_EQ(expected_iterator, expected.end());
+    auto reverse_iterator = expected.rbegin();
+    for (auto iterator = tree.rbegin(); iterator != tree.end(); ++iterator) {
+      ASSERT_NE(reverse_iterator, expected.rend());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), reverse_iterator->first);
+      ++reverse_iterator;
+    }
+    EXPECT_EQ(reverse_iterator, expected.rend());
+  };
+  check();
+
+  // odd keys go in between the bulk loaded ones
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 10000; key++) {
+    keys.push_back(key);
+  }
+  std::mt19937 rng(15445);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    if (key % 2 == 1) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+      expected.emplace(key, RID(0, key));
+    }
+  }
+  check();
+  for (size_t i = 0; i < keys.size() / 2; i++) {
+    index_key.SetFromInteger(keys[i]);
+    auto range = expected.equal_range(keys[i]);
+    for (auto it = range.first; it != range.second; ++it) {
+      tree.Remove(index_key, it->second, transaction);
+    }
+    expected.erase(keys[i]);
+  }
+  check();
+  for (auto &entry : expected) {
+    index_key.SetFromInteger(entry.first);
+    tree.Remove(index_key, entry.second, transaction);
+  }
+  expected.clear();
+  check();
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, GenericKeyTest) {
+  RunBulkLoadWorkload<GenericKey<8>, GenericComparator<8>>(PAGE_SIZE, PAGE_SIZE, false, true);
+  RunBulkLoadWorkload<GenericKey<8>, GenericComparator<8>>(5, 4, false, true);
+  RunBulkLoadWorkload<GenericKey<8>, GenericComparator<8>>(5, 4, false, false);
+}
+
+TEST(BPlusTreeBulkLoadTest, PrefixCompressionTest) {
+  RunBulkLoadWorkload<NormalizedKey<16>, NormalizedComparator<16>>(PAGE_SIZE, PAGE_SIZE, true, true);
+  RunBulkLoadWorkload<NormalizedKey<16>, NormalizedComparator<16>>(PAGE_SIZE, PAGE_SIZE, true, false);
+  RunBulkLoadWorkload<NormalizedKey<16>, NormalizedComparator<16>>(6, 5, true, false);
+}
+
+// creating an index on a table with data indexes every tuple
+TEST(BPlusTreeBulkLoadTest, CreateIndexOnTableTest) {
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  std::vector<Column> columns;
+  columns.emplace_back("order_id", TypeId::INTEGER);
+  columns.emplace_back("customer_id", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_info = catalog->CreateTable(transaction, "orders", schema);
+  const int num_orders = 20000;
+  std::vector<RID> order_rids;
+  for (int order_id = 0; order_id < num_orders; order_id++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(order_id), ValueFactory::GetIntegerValue(order_id % 100)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(tuple, &rid, transaction));
+    order_rids.push_back(rid);
+  }
+
+  auto *primary = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(transaction, "orders_pk", "orders",
+                                                                                 schema, schema, {0}, 8);
+  auto *secondary = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      transaction, "orders_customer", "orders", schema, schema, {1}, 8, false);
+  std::vector<RID> rids;
+  for (int order_id = 0; order_id < num_orders; order_id += 7) {
+    Tuple key({ValueFactory::GetIntegerValue(order_id), ValueFactory::GetIntegerValue(0)}, &schema);
+    rids.clear();
+    primary->index_->ScanKey(key.KeyFromTuple(schema, *primary->index_->GetKeySchema(), {0}), &rids, nullptr);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], order_rids[order_id]);
+  }
+  for (int customer_id = 0; customer_id < 100; customer_id++) {
+    Tuple key({ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(customer_id)}, &schema);
+    rids.clear();
+    secondary->index_->ScanKey(key.KeyFromTuple(schema, *secondary->index_->GetKeySchema(), {1}), &rids, nullptr);
+    EXPECT_EQ(rids.size(), num_orders / 100);
+  }
+  // leaves are left room for inserts
+  EXPECT_LE(primary->stats_->avg_leaf_fill_, 0.9);
+  EXPECT_GT(primary->stats_->avg_leaf_fill_, 0.8);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// the sorted runs of any number of threads merge into every entry, in key order
+TEST(BPlusTreeBulkLoadTest, BuildThreadsTest) {
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  std::vector<Column> columns;
+  columns.emplace_back("order_id", TypeId::INTEGER);
+  columns.emplace_back("customer_id", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_info = catalog->CreateTable(transaction, "orders", schema);
+  const int num_orders = 3000;
+  for (int order_id = 0; order_id < num_orders; order_id++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(order_id), ValueFactory::GetIntegerValue(order_id * 7919 % 50)},
+                &schema);
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(tuple, &rid, transaction));
+  }
+
+  for (size_t num_threads : {1, 2, 3, 5, 8}) {
+    auto *metadata = new IndexMetadata("orders_customer_" + std::to_string(num_threads), "orders", &schema, {1}, false);
+    BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(metadata, bpm);
+    index.BuildFromTable(table_info->table_.get(), schema, num_threads, transaction);
+    GenericComparator<8> comparator(index.GetKeySchema());
+    int num_entries = 0;
+    GenericKey<8> prev_key;
+    std::set<int64_t> rids;
+    for (auto iterator = index.GetBeginIterator(); !iterator.isEnd(); ++iterator) {
+      if (num_entries > 0) {
+        ASSERT_LE(comparator(prev_key, (*iterator).first), 0);
+      }
+      prev_key = (*iterator).first;
+      rids.insert((*iterator).second.Get());
+      num_entries++;
+    }
+    EXPECT_EQ(num_entries, num_orders);
+    EXPECT_EQ(rids.size(), num_orders);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// an index the table does not fit, or that finds no frame for a table page, is not created
+TEST(BPlusTreeBulkLoadTest, CreateIndexErrorTest) {
+  const size_t pool_size = 50;
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  std::vector<Column> columns;
+  columns.emplace_back("order_id", TypeId::INTEGER);
+  columns.emplace_back("customer_id", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_info = catalog->CreateTable(transaction, "orders", schema);
+  for (int order_id = 0; order_id < 20000; order_id++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(order_id), ValueFactory::GetIntegerValue(order_id % 100)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(tuple, &rid, transaction));
+  }
+
+  // customers have many orders
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                   transaction, "orders_customer", "orders", schema, schema, {1}, 8)),
+               Exception);
+  EXPECT_TRUE(catalog->GetTableIndexes("orders").empty());
+
+  // every frame is pinned, by pages other than the table's
+  std::vector<page_id_t> pinned;
+  while (bpm->NewPage(&page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(transaction, "orders_pk", "orders",
+                                                                               schema, schema, {0}, 8)),
+               Exception);
+  EXPECT_TRUE(catalog->GetTableIndexes("orders").empty());
+  for (auto id : pinned) {
+    bpm->UnpinPage(id, false);
+  }
+  auto *primary = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(transaction, "orders_pk", "orders",
+                                                                                 schema, schema, {0}, 8);
+  EXPECT_EQ(primary->stats_->num_entries_, 20000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,252 @@
+/**
+ * b_plus_tree_duplicate_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/*
+ * Inserts 40 keys with 30 values each, removes half of the entries, then all
+ * of them, checking GetValue, GetValues, Begin(key) and the iteration order (both ways) on the way
+ */
+template <typename KeyType, typename KeyComparator>
+void RunDuplicateWorkload(int leaf_max_size, int internal_max_size, bool prefix_compression) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<KeyType, RID, KeyComparator> tree("foreign_keys", bpm, comparator, leaf_max_size, internal_max_size,
+                                              prefix_compression, false);
+  Transaction *transaction = new Transaction(0);
+
+  const int num_keys = 40;
+  const int num_values = 30;
+  std::vector<std::pair<int64_t, RID>> entries;
+  for (int64_t key = 0; key < num_keys; key++) {
+    for (int value = 0; value < num_values; value++) {
+      entries.emplace_back(key * 1000, RID(static_cast<page_id_t>(key), value));
+    }
+  }
+  std::mt19937 rng(15445);
+  std::shuffle(entries.begin(), entries.end(), rng);
+  std::map<int64_t, std::set<int64_t>> expected;
+  KeyType index_key;
+  auto check = [&]() {
+    std::vector<RID> rids;
+    for (int64_t key = -1000; key <= num_keys * 1000; key += 500) {
+      index_key.SetFromInteger(key);
+      rids.clear();
+      EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) == 1);
+      std::set<int64_t> values;
+      for (auto &rid : rids) {
+        values.insert(rid.Get());
+      }
+      EXPECT_EQ(values.size(), rids.size());
+      EXPECT_EQ(values, expected.count(key) == 1 ? expected[key] : std::set<int64_t>());
+    }
+    // a batch of the same keys, shuffled and with repeats, gets the same values
+    std::vector<KeyType> batch;
+    std::vector<int64_t> batch_keys;
+    for (int64_t key = -1000; key <= num_keys * 1000; key += 500) {
+      batch_keys.push_back(key);
+      batch_keys.push_back(key);
+    }
+    std::shuffle(batch_keys.begin(), batch_keys.end(), rng);
+    for (auto key : batch_keys) {
+      index_key.SetFromInteger(key);
+      batch.push_back(index_key);
+    }
+    std::vector<std::vector<RID>> batch_rids;
+    tree.GetValues(batch, &batch_rids);
+    ASSERT_EQ(batch_rids.size(), batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+      std::set<int64_t> values;
+      for (auto &rid : batch_rids[i]) {
+        values.insert(rid.Get());
+      }
+      EXPECT_EQ(values.size(), batch_rids[i].size());
+      EXPECT_EQ(values, expected.count(batch_keys[i]) == 1 ? expected[batch_keys[i]] : std::set<int64_t>());
+    }
+    size_t count = 0;
+    int64_t previous = -1;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_LE(previous, (*iterator).first.ToString());
+      previous = (*iterator).first.ToString();
+      count++;
+    }
+    size_t expected_count = 0;
+    for (auto &entry : expected) {
+      expected_count += entry.second.size();
+    }
+    EXPECT_EQ(count, expected_count);
+    // the previous leaf links survive splits and merges
+    count = 0;
+    previous = num_keys * 1000;
+    for (auto iterator = tree.rbegin(); iterator != tree.end(); ++iterator) {
+      EXPECT_GE(previous, (*iterator).first.ToString());
+      previous = (*iterator).first.ToString();
+      count++;
+    }
+    EXPECT_EQ(count, expected_count);
+    // a range scan starts at the first duplicate
+    for (auto &entry : expected) {
+      index_key.SetFromInteger(entry.first);
+      auto iterator = tree.Begin(index_key);
+      for (size_t i = 0; i < entry.second.size(); i++, ++iterator) {
+        ASSERT_NE(iterator, tree.end());
+        EXPECT_EQ((*iterator).first.ToString(), entry.first);
+      }
+    }
+  };
+
+  for (auto &entry : entries) {
+    index_key.SetFromInteger(entry.first);
+    EXPECT_TRUE(tree.Insert(index_key, entry.second, transaction));
+    expected[entry.first].insert(entry.second.Get());
+  }
+  check();
+
+  std::shuffle(entries.begin(), entries.end(), rng);
+  for (size_t i = 0; i < entries.size() / 2; i++) {
+    index_key.SetFromInteger(entries[i].first);
+    tree.Remove(index_key, entries[i].second, transaction);
+    expected[entries[i].first].erase(entries[i].second.Get());
+    if (expected[entries[i].first].empty()) {
+      expected.erase(entries[i].first);
+    }
+  }
+  check();
+
+  // removing an entry that is not there changes nothing
+  index_key.SetFromInteger(0);
+  tree.Remove(index_key, RID(-1, 0), transaction);
+  check();
+
+  for (auto &entry : entries) {
+    index_key.SetFromInteger(entry.first);
+    tree.Remove(index_key, entry.second, transaction);
+  }
+  expected.clear();
+  check();
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// runs of duplicates longer than a page, so they span several leaves and separators repeat
+TEST(BPlusTreeDuplicateTest, SmallPageTest) { RunDuplicateWorkload<GenericKey<8>, GenericComparator<8>>(5, 4, false); }
+
+TEST(BPlusTreeDuplicateTest, FullPageTest) {
+  RunDuplicateWorkload<GenericKey<8>, GenericComparator<8>>(PAGE_SIZE, PAGE_SIZE, false);
+}
+
+TEST(BPlusTreeDuplicateTest, PrefixCompressionTest) {
+  RunDuplicateWorkload<NormalizedKey<16>, NormalizedComparator<16>>(PAGE_SIZE, PAGE_SIZE, true);
+  RunDuplicateWorkload<NormalizedKey<16>, NormalizedComparator<16>>(5, 4, true);
+}
+
+// duplicates in a slotted page store their key bytes once
+TEST(BPlusTreeDuplicateTest, SharedKeyBytesTest) {
+  NormalizedComparator<64> comparator(nullptr);
+  char data[PAGE_SIZE];
+  auto leaf = reinterpret_cast<BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>> *>(data);
+  leaf->Init(1, INVALID_PAGE_ID, PAGE_SIZE, true);
+  NormalizedKey<64> keys[2];
+  for (int i = 0; i < 2; i++) {
+    memset(keys[i].data_, 'k', sizeof(keys[i].data_));
+    keys[i].data_[sizeof(keys[i].data_) - 1] = static_cast<char>('a' + i);
+  }
+  int count = 0;
+  while (!leaf->IsOverfull()) {
+    leaf->Insert(keys[count % 2], RID(0, count), comparator);
+    count++;
+  }
+  // without sharing, every entry would take its slot and 64 key bytes
+  size_t unshared = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (2 * sizeof(uint16_t) + sizeof(RID) + 64);
+  EXPECT_GT(count, 3 * unshared);
+
+  for (int i = 0; i < count; i += 2) {
+    EXPECT_EQ(leaf->RemoveAndDeleteRecord(keys[0], RID(0, i), comparator), count - i / 2 - 1);
+  }
+  for (int i = 0; i < leaf->GetSize(); i++) {
+    EXPECT_EQ(comparator(leaf->KeyAt(i), keys[1]), 0);
+    EXPECT_EQ(leaf->GetItem(i).second.GetSlotNum() % 2, 1);
+  }
+}
+
+// a non-unique index returns every tuple of a key, and deletes them by RID
+TEST(BPlusTreeDuplicateTest, NonUniqueIndexTest) {
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  std::vector<Column> columns;
+  columns.emplace_back("customer_id", TypeId::INTEGER);
+  columns.emplace_back("order_id", TypeId::INTEGER);
+  Schema schema(columns);
+  catalog->CreateTable(nullptr, "orders", schema);
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      nullptr, "orders_customer", "orders", schema, schema, {0}, 8, false);
+  EXPECT_FALSE(index_info->index_->GetMetadata()->IsUnique());
+
+  for (int order_id = 0; order_id < 500; order_id++) {
+    Tuple key({ValueFactory::GetIntegerValue(order_id % 7), ValueFactory::GetIntegerValue(order_id)}, &schema);
+    index_info->index_->InsertEntry(key.KeyFromTuple(schema, *index_info->index_->GetKeySchema(), {0}),
+                                    RID(0, order_id), nullptr);
+  }
+  for (int order_id = 0; order_id < 500; order_id += 2) {
+    Tuple key({ValueFactory::GetIntegerValue(order_id % 7), ValueFactory::GetIntegerValue(order_id)}, &schema);
+    index_info->index_->DeleteEntry(key.KeyFromTuple(schema, *index_info->index_->GetKeySchema(), {0}),
+                                    RID(0, order_id), nullptr);
+  }
+  for (int customer_id = 0; customer_id < 7; customer_id++) {
+    Tuple key({ValueFactory::GetIntegerValue(customer_id), ValueFactory::GetIntegerValue(0)}, &schema);
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(key.KeyFromTuple(schema, *index_info->index_->GetKeySchema(), {0}), &rids, nullptr);
+    std::set<uint32_t> order_ids;
+    for (auto &rid : rids) {
+      order_ids.insert(rid.GetSlotNum());
+    }
+    std::set<uint32_t> expected;
+    for (int order_id = 1; order_id < 500; order_id += 2) {
+      if (order_id % 7 == customer_id) {
+        expected.insert(order_id);
+      }
+    }
+    EXPECT_EQ(order_ids, expected);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+/**
+ * b_plus_tree_key_search_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// the specialized search must agree with std::lower_bound / std::upper_bound on every window
+TEST(BPlusTreeKeySearchTest, NormalizedIntegerTest) {
+  using Search = BPlusTreeKeySearch<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+  NormalizedComparator<8> comparator(nullptr);
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<int64_t> dist(-100, 100);
+  std::vector<int64_t> keys(200);
+  for (auto &key : keys) {
+    key = dist(rng);
+  }
+  keys.push_back(BUSTUB_INT64_MIN);
+  keys.push_back(BUSTUB_INT64_MAX);
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<std::pair<NormalizedKey<8>, RID>> array(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    array[i].first.SetFromInteger(keys[i]);
+  }
+
+  NormalizedKey<8> probe;
+  for (int64_t key = -102; key <= 102; key++) {
+    probe.SetFromInteger(key);
+    for (int begin = 0; begin < 40; begin += 7) {
+      for (int end = begin; end <= static_cast<int>(keys.size()); end += 13) {
+        int lower = std::lower_bound(keys.begin() + begin, keys.begin() + end, key) - keys.begin();
+        int upper = std::upper_bound(keys.begin() + begin, keys.begin() + end, key) - keys.begin();
+        EXPECT_EQ(Search::LowerBound(array.data(), begin, end, probe, comparator), lower);
+        EXPECT_EQ(Search::UpperBound(array.data(), begin, end, probe, comparator), upper);
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeKeySearchTest, LeafPageLookupTest) {
+  NormalizedComparator<8> comparator(nullptr);
+  char data[PAGE_SIZE];
+  auto leaf = reinterpret_cast<BPlusTreeLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>> *>(data);
+  leaf->Init(1);
+
+  // insert odd keys in random order, lookups of even keys must miss
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key < 2 * leaf->GetMaxSize() - 2; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  NormalizedKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    leaf->Insert(index_key, RID(0, static_cast<uint32_t>(key)), comparator);
+  }
+  for (int i = 0; i < leaf->GetSize(); i++) {
+    EXPECT_EQ(leaf->KeyAt(i).ToString(), 2 * i + 1);
+  }
+
+  RID rid;
+  for (int64_t key = 0; key < 2 * leaf->GetMaxSize(); key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(leaf->Lookup(index_key, &rid, comparator), key % 2 == 1 && key < 2 * leaf->GetMaxSize() - 2);
+    EXPECT_EQ(leaf->KeyIndex(index_key, comparator), std::min<int>(key / 2, leaf->GetSize()));
+  }
+
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    int size = leaf->GetSize();
+    EXPECT_EQ(leaf->RemoveAndDeleteRecord(index_key, comparator), size - 1);
+    EXPECT_FALSE(leaf->Lookup(index_key, &rid, comparator));
+  }
+  EXPECT_EQ(leaf->GetSize(), 0);
+}
+
+/*
+ * Times KeyIndex on a full leaf page, printed for reference only
+ */
+template <typename KeyType, typename KeyComparator>
+int64_t TimeLeafSearch(const KeyComparator &comparator, Schema *key_schema, int64_t *checksum) {
+  char data[PAGE_SIZE];
+  auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(data);
+  leaf->Init(1);
+  KeyType index_key;
+  for (int64_t key = 0; key < leaf->GetMaxSize(); key++) {
+    index_key.SetFromKey(Tuple({ValueFactory::GetBigIntValue(key * 2)}, key_schema), key_schema);
+    leaf->Insert(index_key, RID(), comparator);
+  }
+
+  const int num_probes = 1024;
+  const int rounds = 200;
+  std::vector<KeyType> probes(num_probes);
+  std::mt19937 rng(15445);
+  for (auto &probe : probes) {
+    probe.SetFromKey(Tuple({ValueFactory::GetBigIntValue(rng() % (2 * leaf->GetMaxSize()))}, key_schema),
+                     key_schema);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (auto &probe : probes) {
+      *checksum += leaf->KeyIndex(probe, comparator);
+    }
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  return elapsed.count() / (num_probes * rounds);
+}
+
+TEST(BPlusTreeKeySearchTest, SearchCostTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  int64_t generic_checksum = 0;
+  int64_t normalized_checksum = 0;
+  int64_t wide_checksum = 0;
+  int64_t generic_ns = TimeLeafSearch<GenericKey<8>>(GenericComparator<8>(key_schema), key_schema, &generic_checksum);
+  int64_t normalized_ns =
+      TimeLeafSearch<NormalizedKey<8>>(NormalizedComparator<8>(key_schema), key_schema, &normalized_checksum);
+  int64_t wide_ns = TimeLeafSearch<NormalizedKey<16>>(NormalizedComparator<16>(key_schema), key_schema, &wide_checksum);
+
+  // 8 byte keys share the page layout, so they must find the same slots
+  EXPECT_EQ(generic_checksum, normalized_checksum);
+  std::cout << "GenericKey<8>: " << generic_ns << " ns/search, "
+            << "NormalizedKey<16>: " << wide_ns << " ns/search, "
+            << "NormalizedKey<8>: " << normalized_ns << " ns/search" << std::endl;
+  delete key_schema;
+}
+
+}  // namespace bustub
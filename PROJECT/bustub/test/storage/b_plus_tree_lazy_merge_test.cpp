@@ -0,0 +1,318 @@
+/**
+ * b_plus_tree_lazy_merge_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+void CheckTree(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, const std::set<int64_t> &expected,
+               int64_t num_keys) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key += 7) {
+    index_key.SetFromInteger(key);
+    rids.clear();
+    EXPECT_EQ(tree->GetValue(index_key, &rids), expected.count(key) == 1);
+  }
+  auto expected_iterator = expected.begin();
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    ASSERT_NE(expected_iterator, expected.end());
+    EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_iterator);
+    ++expected_iterator;
+  }
+  EXPECT_EQ(expected_iterator, expected.end());
+  auto reverse_iterator = expected.rbegin();
+  for (auto iterator = tree->rbegin(); iterator != tree->end(); ++iterator) {
+    ASSERT_NE(reverse_iterator, expected.rend());
+    EXPECT_EQ((*iterator).second.GetSlotNum(), *reverse_iterator);
+    ++reverse_iterator;
+  }
+  EXPECT_EQ(reverse_iterator, expected.rend());
+}
+
+/*
+ * Delete-then-insert churn: rounds of removing a random tenth of the keys and
+ * inserting them back, in a tree larger than the buffer pool. Counts the pages
+ * written and allocated per operation.
+ */
+void RunChurn(bool lazy_merge, double *writes_per_op, double *new_pages_per_op) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("churn", bpm, comparator, 16, 16, false, true, 0,
+                                                             lazy_merge);
+    const int64_t num_keys = 20000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; key++) {
+      keys.push_back(key);
+    }
+    std::mt19937 rng(15445);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+
+    int writes_before = disk_manager->GetNumWrites();
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, false);
+    page_id_t pages_before = page_id;
+    int64_t ops = 0;
+    for (int round = 0; round < 20; round++) {
+      std::shuffle(keys.begin(), keys.end(), rng);
+      for (size_t i = 0; i < keys.size() / 10; i++) {
+        index_key.SetFromInteger(keys[i]);
+        tree.Remove(index_key, transaction);
+        ops++;
+      }
+      for (size_t i = 0; i < keys.size() / 10; i++) {
+        index_key.SetFromInteger(keys[i]);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, keys[i]), transaction));
+        ops++;
+      }
+    }
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, false);
+    *writes_per_op = static_cast<double>(disk_manager->GetNumWrites() - writes_before) / ops;
+    *new_pages_per_op = static_cast<double>(page_id - pages_before - 1) / ops;
+
+    std::set<int64_t> expected(keys.begin(), keys.end());
+    CheckTree(&tree, expected, num_keys);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeLazyMergeTest, ChurnTest) {
+  double eager_writes;
+  double eager_new_pages;
+  double lazy_writes;
+  double lazy_new_pages;
+  RunChurn(false, &eager_writes, &eager_new_pages);
+  RunChurn(true, &lazy_writes, &lazy_new_pages);
+  // pages that are not merged need not be split again
+  EXPECT_LT(lazy_new_pages, eager_new_pages);
+}
+
+// prints the page writes and new pages per operation of the churn, with eager and lazy merges
+TEST(BPlusTreeLazyMergeTest, DISABLED_ChurnCostTest) {
+  double eager_writes;
+  double eager_new_pages;
+  double lazy_writes;
+  double lazy_new_pages;
+  RunChurn(false, &eager_writes, &eager_new_pages);
+  RunChurn(true, &lazy_writes, &lazy_new_pages);
+  std::cout << "eager merges: " << eager_writes << " page writes/op, " << eager_new_pages << " new pages/op; "
+            << "lazy merges: " << lazy_writes << " page writes/op, " << lazy_new_pages << " new pages/op" << std::endl;
+}
+
+// deletes leave sparse leaves behind, which compaction merges
+TEST(BPlusTreeLazyMergeTest, CompactTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("compact", bpm, comparator, 16, 8, false, true, 0, true);
+    const int64_t num_keys = 5000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; key++) {
+      keys.push_back(key);
+    }
+    std::mt19937 rng(15445);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::set<int64_t> expected;
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+      expected.insert(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size() * 7 / 10; i++) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Remove(index_key, transaction);
+      expected.erase(keys[i]);
+    }
+    CheckTree(&tree, expected, num_keys);
+
+    int rebalanced = tree.Compact(transaction);
+    EXPECT_GT(rebalanced, 0);
+    CheckTree(&tree, expected, num_keys);
+    // every leaf but the root is at least half full, there is nothing left to compact
+    Page *page = tree.FindLeafPage(index_key, true);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+    while (true) {
+      EXPECT_TRUE(leaf->IsRootPage() || !leaf->IsUnderfull()) << "leaf of " << leaf->GetSize() << " entries";
+      page_id_t next_page_id = leaf->GetNextPageId();
+      bpm->UnpinPage(leaf->GetPageId(), false);
+      if (next_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+          bpm->FetchPage(next_page_id)->GetData());
+    }
+    EXPECT_EQ(tree.Compact(transaction), 0);
+
+    // the compacted tree still takes inserts and removes
+    for (size_t i = 0; i < keys.size(); i++) {
+      index_key.SetFromInteger(keys[i]);
+      if (i % 2 == 0) {
+        tree.Insert(index_key, RID(0, keys[i]), transaction);
+        expected.insert(keys[i]);
+      } else {
+        tree.Remove(index_key, transaction);
+        expected.erase(keys[i]);
+      }
+    }
+    CheckTree(&tree, expected, num_keys);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// compaction runs in the background while the tree is being modified
+TEST(BPlusTreeLazyMergeTest, BackgroundCompactionTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+  auto interval = index_compaction_interval;
+  index_compaction_interval = std::chrono::milliseconds(1);
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("compact", bpm, comparator, 6, 5, false, true, 0, true);
+    tree.StartBackgroundCompaction();
+    const int64_t num_keys = 3000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; key++) {
+      keys.push_back(key);
+    }
+    std::mt19937 rng(15445);
+    std::set<int64_t> expected;
+    GenericKey<8> index_key;
+    for (size_t round = 0; round < 4; round++) {
+      std::shuffle(keys.begin(), keys.end(), rng);
+      for (size_t i = 0; i < keys.size(); i++) {
+        index_key.SetFromInteger(keys[i]);
+        if (i % 3 == round % 3) {
+          tree.Insert(index_key, RID(0, keys[i]), transaction);
+          expected.insert(keys[i]);
+        } else {
+          tree.Remove(index_key, transaction);
+          expected.erase(keys[i]);
+        }
+      }
+    }
+    tree.StopBackgroundCompaction();
+    CheckTree(&tree, expected, num_keys);
+  }
+
+  index_compaction_interval = interval;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a catalog index with lazy merges compacted in the background
+TEST(BPlusTreeLazyMergeTest, IndexOptionsTest) {
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  auto interval = index_compaction_interval;
+  index_compaction_interval = std::chrono::milliseconds(1);
+  std::vector<Column> columns;
+  columns.emplace_back("id", TypeId::BIGINT);
+  Schema schema(columns);
+  catalog->CreateTable(transaction, "sessions", schema);
+  IndexOptions options;
+  options.lazy_merge_ = true;
+  options.background_compaction_ = true;
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      transaction, "sessions_pk", "sessions", schema, schema, {0}, 8, true, {}, IndexType::BPlusTree, options);
+
+  const int64_t num_keys = 3000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::mt19937 rng(15445);
+  std::set<int64_t> expected;
+  for (size_t round = 0; round < 4; round++) {
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size(); i++) {
+      Tuple tuple({ValueFactory::GetBigIntValue(keys[i])}, &schema);
+      if (i % 3 == round % 3) {
+        if (expected.insert(keys[i]).second) {
+          index_info->index_->InsertEntry(tuple, RID(0, keys[i]), transaction);
+        }
+      } else if (expected.erase(keys[i]) == 1) {
+        index_info->index_->DeleteEntry(tuple, RID(0, keys[i]), transaction);
+      }
+    }
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, &schema);
+    rids.clear();
+    index_info->index_->ScanKey(tuple, &rids, transaction);
+    EXPECT_EQ(rids.size(), expected.count(key));
+  }
+
+  delete catalog;
+  index_compaction_interval = interval;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
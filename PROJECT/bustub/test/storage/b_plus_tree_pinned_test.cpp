@@ -0,0 +1,287 @@
+/**
+ * b_plus_tree_pinned_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/*
+ * Inserts and removes keys in random order in a tree with tiny pages, so that
+ * the pinned levels split, merge and change root all the time, then checks
+ * that every frame is unpinned once the tree is gone
+ */
+TEST(BPlusTreePinnedTest, SmallPageWorkloadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const size_t pool_size = 100;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("pinned", bpm, comparator, 5, 4, false, true, 3);
+    std::mt19937 rng(15445);
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 3000; key++) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::set<int64_t> expected;
+    GenericKey<8> index_key;
+    auto check = [&]() {
+      std::vector<RID> rids;
+      for (int64_t key = 0; key < 3000; key += 7) {
+        index_key.SetFromInteger(key);
+        rids.clear();
+        EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) == 1);
+      }
+      auto expected_iterator = expected.begin();
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        ASSERT_NE(expected_iterator, expected.end());
+        EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_iterator);
+        ++expected_iterator;
+      }
+      EXPECT_EQ(expected_iterator, expected.end());
+    };
+
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+      expected.insert(key);
+    }
+    check();
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size() / 2; i++) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Remove(index_key, transaction);
+      expected.erase(keys[i]);
+    }
+    check();
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    expected.clear();
+    check();
+    EXPECT_TRUE(tree.IsEmpty());
+
+    for (size_t i = 0; i < 1000; i++) {
+      index_key.SetFromInteger(keys[i]);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, keys[i]), transaction));
+      expected.insert(keys[i]);
+    }
+    check();
+  }
+
+  // only the header page is still pinned
+  for (size_t i = 1; i < pool_size; i++) {
+    EXPECT_NE(bpm->NewPage(&page_id), nullptr);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// average time of a point lookup, in a tree that fits in the buffer pool
+int64_t TimeLookups(int pinned_levels, int64_t *found) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(2000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  int64_t elapsed_ns;
+  {
+    // small internal pages, so the tree has a few levels above the leaves
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("pinned", bpm, comparator, PAGE_SIZE, 16, false, true,
+                                                             pinned_levels);
+    const int64_t num_keys = 50000;
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+    std::vector<GenericKey<8>> probes(50000);
+    std::mt19937 rng(15445);
+    for (auto &probe : probes) {
+      probe.SetFromInteger(rng() % num_keys);
+    }
+
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (auto &probe : probes) {
+      rids.clear();
+      *found += static_cast<int64_t>(tree.GetValue(probe, &rids));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    elapsed_ns = elapsed.count() / static_cast<int64_t>(probes.size());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+  return elapsed_ns;
+}
+
+// lookups through pinned levels find every key
+TEST(BPlusTreePinnedTest, LookupTest) {
+  int64_t unpinned_found = 0;
+  int64_t pinned_found = 0;
+  TimeLookups(0, &unpinned_found);
+  TimeLookups(3, &pinned_found);
+  EXPECT_EQ(unpinned_found, 50000);
+  EXPECT_EQ(pinned_found, 50000);
+}
+
+// prints the lookup cost with and without pinned levels
+TEST(BPlusTreePinnedTest, DISABLED_LookupCostTest) {
+  int64_t found = 0;
+  int64_t unpinned_ns = TimeLookups(0, &found);
+  int64_t pinned_ns = TimeLookups(3, &found);
+  std::cout << "no pinned levels: " << unpinned_ns << " ns/lookup, "
+            << "3 pinned levels: " << pinned_ns << " ns/lookup" << std::endl;
+}
+
+// number of frames NewPage can still take, they are unpinned again
+size_t FreeFrames(BufferPoolManager *bpm) {
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  while (bpm->NewPage(&page_id) != nullptr) {
+    page_ids.push_back(page_id);
+  }
+  for (auto id : page_ids) {
+    bpm->UnpinPage(id, false);
+  }
+  return page_ids.size();
+}
+
+/*
+ * Without deferred root writes, the header page record follows the root as it
+ * splits and is emptied, with no flush
+ */
+TEST(BPlusTreePinnedTest, RootRecordTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+  auto *header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("raw", bpm, comparator, 5, 4, false, true, 1);
+    GenericKey<8> index_key;
+    page_id_t leaf_root_id;
+    page_id_t root_page_id;
+    index_key.SetFromInteger(0);
+    tree.Insert(index_key, RID(0, 0), transaction);
+    ASSERT_TRUE(header_page->GetRootId("raw", &leaf_root_id));
+    EXPECT_NE(leaf_root_id, INVALID_PAGE_ID);
+    for (int64_t key = 1; key < 100; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+    ASSERT_TRUE(header_page->GetRootId("raw", &root_page_id));
+    EXPECT_NE(root_page_id, leaf_root_id);
+    EXPECT_NE(root_page_id, INVALID_PAGE_ID);
+    for (int64_t key = 0; key < 100; key++) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    ASSERT_TRUE(header_page->GetRootId("raw", &root_page_id));
+    EXPECT_EQ(root_page_id, INVALID_PAGE_ID);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// catalog indexes pin levels through their options, and with deferred root writes write their root to the header
+// page once, when destroyed
+TEST(BPlusTreePinnedTest, IndexOptionsTest) {
+  const size_t pool_size = 100;
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  std::vector<Column> columns;
+  columns.emplace_back("id", TypeId::BIGINT);
+  Schema schema(columns);
+  catalog->CreateTable(transaction, "sessions", schema);
+  IndexOptions options;
+  options.pinned_levels_ = 1;
+  options.defer_root_write_ = true;
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      transaction, "sessions_pk", "sessions", schema, schema, {0}, 8, true, {}, IndexType::BPlusTree, options);
+
+  // enough keys for an internal root, the one page kept pinned
+  const int64_t num_keys = 20000;
+  for (int64_t key = 0; key < num_keys; key++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, &schema);
+    index_info->index_->InsertEntry(tuple, RID(0, key), transaction);
+  }
+  EXPECT_EQ(FreeFrames(bpm), pool_size - 2);
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key += 7) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, &schema);
+    rids.clear();
+    index_info->index_->ScanKey(tuple, &rids, transaction);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], RID(0, key));
+  }
+
+  // the root changed, but the header page was not written
+  auto *header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  page_id_t root_page_id;
+  EXPECT_FALSE(header_page->GetRootId("sessions_pk", &root_page_id));
+  delete catalog;
+  EXPECT_TRUE(header_page->GetRootId("sessions_pk", &root_page_id));
+  EXPECT_NE(root_page_id, INVALID_PAGE_ID);
+  EXPECT_EQ(FreeFrames(bpm), pool_size - 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+/**
+ * b_plus_tree_prefetch_test.cpp
+ */
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+/*
+ * Scans a tree much larger than the buffer pool, after its leaves were evicted,
+ * with iterators both ways and with GetRange. Returns the time of the scans,
+ * and the pages they read.
+ */
+int64_t RunColdScans(int prefetch_leaves, int *reads) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const size_t pool_size = 64;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  int64_t elapsed_ns = 0;
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("prefetch", bpm, comparator, 32, 128);
+    tree.SetPrefetchLeaves(prefetch_leaves);
+    const int64_t num_keys = 30000;
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+    auto evict = [&]() {
+      for (size_t i = 0; i < pool_size; i++) {
+        bpm->NewPage(&page_id);
+        bpm->UnpinPage(page_id, false);
+      }
+    };
+
+    int reads_before = disk_manager->GetNumReads();
+    auto start = std::chrono::steady_clock::now();
+    evict();
+    int64_t expected = 0;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), expected);
+      expected++;
+    }
+    EXPECT_EQ(expected, num_keys);
+    evict();
+    for (auto iterator = tree.rbegin(); iterator != tree.end(); ++iterator) {
+      expected--;
+      EXPECT_EQ((*iterator).second.GetSlotNum(), expected);
+    }
+    EXPECT_EQ(expected, 0);
+    evict();
+    std::vector<RID> rids;
+    GenericKey<8> low_key;
+    low_key.SetFromInteger(num_keys / 3);
+    tree.GetRange(&low_key, nullptr, true, true, false, SIZE_MAX, &rids, transaction);
+    EXPECT_EQ(rids.size(), num_keys - num_keys / 3);
+    for (size_t i = 0; i < rids.size(); i++) {
+      EXPECT_EQ(rids[i].GetSlotNum(), num_keys / 3 + i);
+    }
+    // a scan with a small limit stays in its leaf
+    evict();
+    int limit_reads_before = disk_manager->GetNumReads();
+    rids.clear();
+    tree.GetRange(&low_key, nullptr, true, true, false, 3, &rids, transaction);
+    EXPECT_EQ(rids.size(), 3);
+    EXPECT_LE(disk_manager->GetNumReads() - limit_reads_before, 4);
+    elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    *reads = disk_manager->GetNumReads() - reads_before;
+  }
+
+  // only the header page is still pinned
+  for (size_t i = 1; i < pool_size; i++) {
+    EXPECT_NE(bpm->NewPage(&page_id), nullptr);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+  return elapsed_ns;
+}
+
+TEST(BPlusTreePrefetchTest, ColdScanTest) {
+  int reads;
+  int prefetch_reads;
+  RunColdScans(0, &reads);
+  RunColdScans(INDEX_SCAN_PREFETCH_LEAVES, &prefetch_reads);
+  // the leaves read ahead are used before they are evicted, not read twice
+  EXPECT_LE(prefetch_reads, reads + reads / 10);
+}
+
+// prints the time and page reads of the cold scans, with and without prefetching
+TEST(BPlusTreePrefetchTest, DISABLED_ColdScanCostTest) {
+  int reads;
+  int prefetch_reads;
+  int64_t elapsed_ns = RunColdScans(0, &reads);
+  int64_t prefetch_ns = RunColdScans(INDEX_SCAN_PREFETCH_LEAVES, &prefetch_reads);
+  std::cout << "no prefetch: " << elapsed_ns / 1000 << " us, " << reads << " page reads; "
+            << INDEX_SCAN_PREFETCH_LEAVES << " leaves ahead: " << prefetch_ns / 1000 << " us, " << prefetch_reads
+            << " page reads" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,258 @@
+/**
+ * b_plus_tree_prefix_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// number of pages allocated so far, the next page id
+page_id_t AllocatedPages(BufferPoolManager *bpm) {
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, false);
+  return page_id;
+}
+
+// (tenant_id, order_id) keys, orders of a tenant share their first 5 bytes
+page_id_t BuildOrderIndex(bool prefix_compression, int tenants, int orders) {
+  Schema *key_schema = ParseCreateStatement("a integer,b bigint");
+  NormalizedComparator<16> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>> tree("orders", bpm, comparator, PAGE_SIZE, PAGE_SIZE,
+                                                                   prefix_compression);
+  Transaction *transaction = new Transaction(0);
+
+  // in random order, pages only fill up to what fits when they are bounded on both sides
+  std::vector<int> entries;
+  for (int entry = 0; entry < tenants * orders; entry++) {
+    entries.push_back(entry);
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+  NormalizedKey<16> index_key;
+  for (auto entry : entries) {
+    int tenant = entry / orders;
+    int order = entry % orders;
+    Tuple key({ValueFactory::GetIntegerValue(tenant), ValueFactory::GetBigIntValue(order)}, key_schema);
+    index_key.SetFromKey(key, key_schema);
+    EXPECT_TRUE(tree.Insert(index_key, RID(tenant, order), transaction));
+  }
+
+  std::vector<RID> rids;
+  for (int tenant = 0; tenant < tenants; tenant++) {
+    for (int order = 0; order < orders; order += 7) {
+      Tuple key({ValueFactory::GetIntegerValue(tenant), ValueFactory::GetBigIntValue(order)}, key_schema);
+      index_key.SetFromKey(key, key_schema);
+      rids.clear();
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids[0], RID(tenant, order));
+    }
+  }
+  int count = 0;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second, RID(count / orders, count % orders));
+    count++;
+  }
+  EXPECT_EQ(count, tenants * orders);
+
+  page_id_t pages = AllocatedPages(bpm);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+  return pages;
+}
+
+TEST(BPlusTreePrefixTest, FanoutTest) {
+  page_id_t full_pages = BuildOrderIndex(false, 4, 5000);
+  page_id_t prefix_pages = BuildOrderIndex(true, 4, 5000);
+  std::cout << "pages without prefix compression: " << full_pages << ", with: " << prefix_pages << std::endl;
+  EXPECT_LT(prefix_pages, full_pages);
+}
+
+// long keys (tenant byte, 40 shared bytes, id) mixing pages that share long prefixes and pages that share none
+void SetLongKey(NormalizedKey<64> *key, int64_t id) {
+  memset(key->data_, 0, sizeof(key->data_));
+  key->data_[0] = static_cast<char>(id / 7000 + 1);
+  memset(key->data_ + 1, 'x', 40);
+  for (int i = 0; i < 8; i++) {
+    key->data_[41 + i] = static_cast<char>((id >> (8 * (7 - i))) & 0xFF);
+  }
+}
+
+void RunLongKeyWorkload(int leaf_max_size, int internal_max_size) {
+  NormalizedComparator<64> comparator(nullptr);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>> tree("long_keys", bpm, comparator, leaf_max_size,
+                                                                   internal_max_size, true);
+  Transaction *transaction = new Transaction(0);
+
+  std::mt19937 rng(15445);
+  std::vector<int64_t> ids;
+  for (int64_t id = 0; id < 21000; id++) {
+    ids.push_back(id);
+  }
+  std::shuffle(ids.begin(), ids.end(), rng);
+  std::set<int64_t> expected;
+  NormalizedKey<64> index_key;
+  auto check = [&]() {
+    std::vector<RID> rids;
+    std::vector<NormalizedKey<64>> batch;
+    for (int64_t id = 0; id < 21000; id += 5) {
+      SetLongKey(&index_key, id);
+      rids.clear();
+      EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(id) == 1);
+      batch.push_back(index_key);
+    }
+    // the same keys in one batch, probed in reverse
+    std::reverse(batch.begin(), batch.end());
+    std::vector<std::vector<RID>> batch_rids;
+    tree.GetValues(batch, &batch_rids);
+    for (size_t i = 0; i < batch.size(); i++) {
+      int64_t id = 21000 - 5 * (i + 1);
+      ASSERT_EQ(batch_rids[i].size(), expected.count(id));
+      if (!batch_rids[i].empty()) {
+        EXPECT_EQ(batch_rids[i][0], RID(0, id));
+      }
+    }
+    auto expected_iterator = expected.begin();
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      ASSERT_NE(expected_iterator, expected.end());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_iterator);
+      ++expected_iterator;
+    }
+    EXPECT_EQ(expected_iterator, expected.end());
+  };
+
+  for (auto id : ids) {
+    SetLongKey(&index_key, id);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, id), transaction));
+    expected.insert(id);
+  }
+  check();
+
+  std::shuffle(ids.begin(), ids.end(), rng);
+  for (size_t i = 0; i < 18000; i++) {
+    SetLongKey(&index_key, ids[i]);
+    tree.Remove(index_key, transaction);
+    expected.erase(ids[i]);
+  }
+  check();
+
+  for (size_t i = 0; i < 6000; i++) {
+    SetLongKey(&index_key, ids[i]);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, ids[i]), transaction));
+    expected.insert(ids[i]);
+  }
+  check();
+
+  for (auto id : ids) {
+    SetLongKey(&index_key, id);
+    tree.Remove(index_key, transaction);
+  }
+  expected.clear();
+  check();
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// pages bounded by what fits
+TEST(BPlusTreePrefixTest, RandomWorkloadTest) { RunLongKeyWorkload(PAGE_SIZE, PAGE_SIZE); }
+
+// small pages, so the tree is deep and merges and redistributes a lot
+TEST(BPlusTreePrefixTest, SmallPageWorkloadTest) { RunLongKeyWorkload(8, 6); }
+
+// catalog indexes on normalized keys use fixed-size slots unless their options ask for prefix compression
+TEST(BPlusTreePrefixTest, IndexOptionsTest) {
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  std::vector<Column> columns;
+  columns.emplace_back("tenant_id", TypeId::INTEGER);
+  columns.emplace_back("order_id", TypeId::BIGINT);
+  Schema schema(columns);
+  catalog->CreateTable(transaction, "orders", schema);
+  IndexOptions compressed;
+  compressed.prefix_compression_ = true;
+  auto *fixed_index = catalog->CreateIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>(
+      transaction, "orders_fixed", "orders", schema, schema, {0, 1}, 16);
+  auto *compressed_index = catalog->CreateIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>(
+      transaction, "orders_compressed", "orders", schema, schema, {0, 1}, 16, true, {}, IndexType::BPlusTree,
+      compressed);
+  EXPECT_FALSE(fixed_index->index_->GetMetadata()->GetOptions().prefix_compression_);
+
+  // in random order, like BuildOrderIndex
+  const int tenants = 4;
+  const int orders = 5000;
+  std::vector<int> entries;
+  for (int entry = 0; entry < tenants * orders; entry++) {
+    entries.push_back(entry);
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+  for (auto *index_info : {fixed_index, compressed_index}) {
+    for (auto entry : entries) {
+      Tuple key({ValueFactory::GetIntegerValue(entry / orders), ValueFactory::GetBigIntValue(entry % orders)},
+                &schema);
+      index_info->index_->InsertEntry(key, RID(entry / orders, entry % orders), transaction);
+    }
+    catalog->AnalyzeIndex(transaction, index_info);
+  }
+  EXPECT_LT(compressed_index->stats_->num_leaves_, fixed_index->stats_->num_leaves_);
+
+  std::vector<RID> rids;
+  for (auto *index_info : {fixed_index, compressed_index}) {
+    for (int entry = 0; entry < tenants * orders; entry += 7) {
+      Tuple key({ValueFactory::GetIntegerValue(entry / orders), ValueFactory::GetBigIntValue(entry % orders)},
+                &schema);
+      rids.clear();
+      index_info->index_->ScanKey(key, &rids, transaction);
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0], RID(entry / orders, entry % orders));
+    }
+  }
+
+  // generic keys are not compared byte by byte
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+                   transaction, "orders_generic", "orders", schema, schema, {0, 1}, 16, true, {},
+                   IndexType::BPlusTree, compressed)),
+               Exception);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
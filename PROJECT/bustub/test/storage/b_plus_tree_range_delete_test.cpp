@@ -0,0 +1,290 @@
+/**
+ * b_plus_tree_range_delete_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+/*
+ * Deletes random ranges, with every inclusivity and some open bounds, from a
+ * tree of the even numbers below 4000 (the multiples of 10 3 times without
+ * unique keys), puts the keys back now and then, and checks the tree against
+ * a multiset after every delete. Then empties the tree and checks that every
+ * frame is unpinned once it is gone.
+ */
+template <typename KeyType, typename KeyComparator>
+void RunRangeDeleteWorkload(int leaf_max_size, int internal_max_size, bool prefix_compression, bool unique_keys,
+                            bool lazy_merge) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema);
+  const size_t pool_size = 50;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  {
+    BPlusTree<KeyType, RID, KeyComparator> tree("range_delete", bpm, comparator, leaf_max_size, internal_max_size,
+                                                prefix_compression, unique_keys, 0, lazy_merge);
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 4000; key += 2) {
+      for (int copy = 0; copy < (!unique_keys && key % 10 == 0 ? 3 : 1); copy++) {
+        keys.push_back(key);
+      }
+    }
+    std::mt19937 rng(15445);
+    std::multiset<int64_t> expected;
+    KeyType index_key;
+    auto insert_all = [&]() {
+      std::vector<int64_t> shuffled = keys;
+      std::shuffle(shuffled.begin(), shuffled.end(), rng);
+      for (auto key : shuffled) {
+        if (unique_keys && expected.count(key) > 0) {
+          continue;
+        }
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+        expected.insert(key);
+      }
+    };
+    auto check = [&]() {
+      std::vector<RID> rids;
+      for (int64_t key = -1; key <= 4001; key += 11) {
+        index_key.SetFromInteger(key);
+        rids.clear();
+        EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) > 0);
+        EXPECT_EQ(rids.size(), expected.count(key));
+      }
+      auto expected_iterator = expected.begin();
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        ASSERT_NE(expected_iterator, expected.end());
+        EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_iterator);
+        ++expected_iterator;
+      }
+      EXPECT_EQ(expected_iterator, expected.end());
+      auto reverse_iterator = expected.rbegin();
+      for (auto iterator = tree.rbegin(); iterator != tree.end(); ++iterator) {
+        ASSERT_NE(reverse_iterator, expected.rend());
+        EXPECT_EQ((*iterator).second.GetSlotNum(), *reverse_iterator);
+        ++reverse_iterator;
+      }
+      EXPECT_EQ(reverse_iterator, expected.rend());
+    };
+
+    insert_all();
+    KeyType low_key;
+    KeyType high_key;
+    std::uniform_int_distribution<int64_t> dist(-10, 4010);
+    for (int round = 0; round < 60; round++) {
+      if (round % 10 == 0) {
+        insert_all();
+      }
+      int64_t low = dist(rng);
+      // mostly short ranges, some within a leaf and some across many
+      int64_t high = round % 7 == 0 ? low : low + static_cast<int64_t>(rng() % (round % 3 == 0 ? 2000 : 100));
+      bool low_inclusive = (round & 1) != 0;
+      bool high_inclusive = (round & 2) != 0;
+      low_key.SetFromInteger(low);
+      high_key.SetFromInteger(high);
+      const KeyType *low_bound = round % 11 == 5 ? nullptr : &low_key;
+      const KeyType *high_bound = round % 13 == 6 ? nullptr : &high_key;
+
+      size_t expected_removed = 0;
+      for (auto iterator = expected.begin(); iterator != expected.end();) {
+        int64_t key = *iterator;
+        bool above_low = low_bound == nullptr || key > low || (low_inclusive && key == low);
+        bool below_high = high_bound == nullptr || key < high || (high_inclusive && key == high);
+        if (above_low && below_high) {
+          iterator = expected.erase(iterator);
+          expected_removed++;
+        } else {
+          ++iterator;
+        }
+      }
+      EXPECT_EQ(tree.RemoveRange(low_bound, high_bound, low_inclusive, high_inclusive, transaction),
+                expected_removed);
+      check();
+    }
+
+    // the tree still takes inserts after deletes, and can be emptied at once
+    insert_all();
+    check();
+    EXPECT_EQ(tree.RemoveRange(nullptr, nullptr, true, true, transaction), expected.size());
+    expected.clear();
+    check();
+    EXPECT_TRUE(tree.IsEmpty());
+    EXPECT_EQ(tree.RemoveRange(nullptr, nullptr, true, true, transaction), 0);
+    insert_all();
+    check();
+  }
+
+  // only the header page is still pinned
+  for (size_t i = 1; i < pool_size; i++) {
+    EXPECT_NE(bpm->NewPage(&page_id), nullptr);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeDeleteTest, GenericKeyTest) {
+  RunRangeDeleteWorkload<GenericKey<8>, GenericComparator<8>>(PAGE_SIZE, PAGE_SIZE, false, true, false);
+  RunRangeDeleteWorkload<GenericKey<8>, GenericComparator<8>>(5, 4, false, true, false);
+  RunRangeDeleteWorkload<GenericKey<8>, GenericComparator<8>>(5, 4, false, false, false);
+  RunRangeDeleteWorkload<GenericKey<8>, GenericComparator<8>>(8, 6, false, true, true);
+}
+
+TEST(BPlusTreeRangeDeleteTest, PrefixCompressionTest) {
+  RunRangeDeleteWorkload<NormalizedKey<16>, NormalizedComparator<16>>(PAGE_SIZE, PAGE_SIZE, true, false, false);
+  RunRangeDeleteWorkload<NormalizedKey<16>, NormalizedComparator<16>>(6, 5, true, true, false);
+  RunRangeDeleteWorkload<NormalizedKey<16>, NormalizedComparator<16>>(6, 5, true, false, false);
+}
+
+/*
+ * A range over most of a tree larger than the buffer pool: the subtrees it
+ * covers are dropped without being written back, only the pages on the paths
+ * to its two ends are.
+ */
+TEST(BPlusTreeRangeDeleteTest, DropSubtreesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("drop", bpm, comparator, 64, 16);
+    const int64_t num_keys = 40000;
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+
+    int writes_before = disk_manager->GetNumWrites();
+    GenericKey<8> low_key;
+    GenericKey<8> high_key;
+    low_key.SetFromInteger(1000);
+    high_key.SetFromInteger(num_keys - 1000);
+    EXPECT_EQ(tree.RemoveRange(&low_key, &high_key, true, false, transaction), num_keys - 2000);
+    // the frames dirty before, evicted to read the sizes of the leaves dropped, and the pages on the two paths
+    EXPECT_LT(disk_manager->GetNumWrites() - writes_before, 32);
+
+    int64_t next = 0;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), next);
+      next = next == 999 ? num_keys - 1000 : next + 1;
+    }
+    EXPECT_EQ(next, num_keys);
+    for (int64_t key = 1000; key < num_keys - 1000; key += 3) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+    }
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < num_keys; key += 3) {
+      index_key.SetFromInteger(key);
+      rids.clear();
+      EXPECT_EQ(tree.GetValue(index_key, &rids), key < 1000 || key >= num_keys - 1000 || (key - 1000) % 3 == 0);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * TTL cleanup: keys are timestamps, and every round expires the oldest ones,
+ * either by one RemoveRange or by removing the keys one at a time. Returns the
+ * time spent deleting, and the page writes.
+ */
+int64_t RunExpiry(bool range_delete, int *writes) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  int64_t elapsed_ns = 0;
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("expiry", bpm, comparator, 64, 64);
+    const int64_t num_keys = 40000;
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+
+    int writes_before = disk_manager->GetNumWrites();
+    GenericKey<8> high_key;
+    for (int64_t expired = 0; expired < num_keys / 2; expired += num_keys / 20) {
+      auto start = std::chrono::steady_clock::now();
+      if (range_delete) {
+        high_key.SetFromInteger(expired + num_keys / 20);
+        tree.RemoveRange(nullptr, &high_key, true, false, transaction);
+      } else {
+        for (int64_t key = expired; key < expired + num_keys / 20; key++) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, transaction);
+        }
+      }
+      elapsed_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                        .count();
+    }
+    *writes = disk_manager->GetNumWrites() - writes_before;
+
+    int64_t next = num_keys / 2;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), next);
+      next++;
+    }
+    EXPECT_EQ(next, num_keys);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+  return elapsed_ns;
+}
+
+TEST(BPlusTreeRangeDeleteTest, ExpiryTest) {
+  int per_key_writes;
+  int range_writes;
+  int64_t per_key_ns = RunExpiry(false, &per_key_writes);
+  int64_t range_ns = RunExpiry(true, &range_writes);
+  std::cout << "per-key removes: " << per_key_ns / 1000 << " us, " << per_key_writes << " page writes; "
+            << "range removes: " << range_ns / 1000 << " us, " << range_writes << " page writes" << std::endl;
+  // each leaf is written once either way
+  EXPECT_LE(range_writes, per_key_writes);
+}
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+/**
+ * b_plus_tree_range_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+/*
+ * Checks GetRange against a sorted list of keys, for random bounds with every
+ * inclusivity in both directions, keys are the even numbers below 2000 and the
+ * multiples of 10 appear 3 times
+ */
+template <typename KeyType, typename KeyComparator>
+void RunRangeWorkload(int leaf_max_size, int internal_max_size, bool prefix_compression) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<KeyType, RID, KeyComparator> tree("ranges", bpm, comparator, leaf_max_size, internal_max_size,
+                                              prefix_compression, false);
+  Transaction *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 2000; key += 2) {
+    for (int copy = 0; copy < (key % 10 == 0 ? 3 : 1); copy++) {
+      keys.push_back(key);
+    }
+  }
+  std::vector<int64_t> shuffled = keys;
+  std::mt19937 rng(15445);
+  std::shuffle(shuffled.begin(), shuffled.end(), rng);
+  KeyType index_key;
+  for (size_t i = 0; i < shuffled.size(); i++) {
+    index_key.SetFromInteger(shuffled[i]);
+    tree.Insert(index_key, RID(0, shuffled[i]), transaction);
+  }
+
+  KeyType low_key;
+  KeyType high_key;
+  std::uniform_int_distribution<int64_t> dist(-10, 2010);
+  for (int round = 0; round < 200; round++) {
+    int64_t low = dist(rng);
+    int64_t high = round % 20 == 0 ? low : dist(rng);
+    low_key.SetFromInteger(low);
+    high_key.SetFromInteger(high);
+    for (int bounds = 0; bounds < 4; bounds++) {
+      bool low_inclusive = (bounds & 1) != 0;
+      bool high_inclusive = (bounds & 2) != 0;
+      std::vector<int64_t> expected;
+      for (auto key : keys) {
+        if ((key > low || (low_inclusive && key == low)) && (key < high || (high_inclusive && key == high))) {
+          expected.push_back(key);
+        }
+      }
+      for (bool descending : {false, true}) {
+        if (descending) {
+          std::reverse(expected.begin(), expected.end());
+        }
+        std::vector<RID> rids;
+        tree.GetRange(&low_key, &high_key, low_inclusive, high_inclusive, descending, SIZE_MAX, &rids, transaction);
+        ASSERT_EQ(rids.size(), expected.size());
+        for (size_t i = 0; i < rids.size(); i++) {
+          EXPECT_EQ(rids[i].GetSlotNum(), expected[i]);
+        }
+        // a limit keeps the first values in scan order
+        rids.clear();
+        tree.GetRange(&low_key, &high_key, low_inclusive, high_inclusive, descending, 5, &rids, transaction);
+        ASSERT_EQ(rids.size(), std::min<size_t>(expected.size(), 5));
+        for (size_t i = 0; i < rids.size(); i++) {
+          EXPECT_EQ(rids[i].GetSlotNum(), expected[i]);
+        }
+      }
+    }
+  }
+
+  // open bounds
+  std::vector<RID> rids;
+  low_key.SetFromInteger(1000);
+  tree.GetRange(&low_key, nullptr, true, true, false, SIZE_MAX, &rids, transaction);
+  EXPECT_EQ(rids.size(), keys.end() - std::lower_bound(keys.begin(), keys.end(), 1000));
+  rids.clear();
+  tree.GetRange(nullptr, &low_key, true, false, false, SIZE_MAX, &rids, transaction);
+  EXPECT_EQ(rids.size(), std::lower_bound(keys.begin(), keys.end(), 1000) - keys.begin());
+  rids.clear();
+  tree.GetRange(nullptr, nullptr, true, true, false, SIZE_MAX, &rids, transaction);
+  EXPECT_EQ(rids.size(), keys.size());
+  // the largest keys first
+  rids.clear();
+  tree.GetRange(nullptr, nullptr, true, true, true, 20, &rids, transaction);
+  ASSERT_EQ(rids.size(), 20);
+  for (size_t i = 0; i < rids.size(); i++) {
+    EXPECT_EQ(rids[i].GetSlotNum(), keys[keys.size() - 1 - i]);
+  }
+
+  // reverse iterators walk the previous leaf links down to the smallest key
+  size_t count = 0;
+  for (auto iterator = tree.rbegin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), keys[keys.size() - 1 - count]);
+    count++;
+  }
+  EXPECT_EQ(count, keys.size());
+  for (int64_t key = -1; key <= 2001; key += 37) {
+    low_key.SetFromInteger(key);
+    auto expected = std::upper_bound(keys.begin(), keys.end(), key);
+    auto iterator = tree.RBegin(low_key);
+    for (; expected != keys.begin() && iterator != tree.end(); ++iterator) {
+      --expected;
+      EXPECT_EQ((*iterator).second.GetSlotNum(), *expected);
+    }
+    EXPECT_EQ(expected, keys.begin());
+    EXPECT_EQ(iterator, tree.end());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeTest, GenericKeyTest) {
+  RunRangeWorkload<GenericKey<8>, GenericComparator<8>>(PAGE_SIZE, PAGE_SIZE, false);
+  RunRangeWorkload<GenericKey<8>, GenericComparator<8>>(6, 5, false);
+}
+
+TEST(BPlusTreeRangeTest, PrefixCompressionTest) {
+  RunRangeWorkload<NormalizedKey<16>, NormalizedComparator<16>>(PAGE_SIZE, PAGE_SIZE, true);
+  RunRangeWorkload<NormalizedKey<16>, NormalizedComparator<16>>(6, 5, true);
+}
+
+}  // namespace bustub
@@ -0,0 +1,165 @@
+/**
+ * b_plus_tree_statistics_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/*
+ * 20000 entries on 5000 keys, 4 of each, inserted in random order: the
+ * statistics of every leaf are exact, the sampled ones close to them
+ */
+TEST(BPlusTreeStatisticsTest, TreeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction *transaction = new Transaction(0);
+
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("statistics", bpm, comparator, 16, 8, false, false);
+    BPlusTreeStatistics<GenericKey<8>> stats;
+    tree.GetStatistics(0, 10, &stats);
+    EXPECT_EQ(stats.height_, 0);
+    EXPECT_EQ(stats.num_entries_, 0);
+    EXPECT_TRUE(stats.bucket_bounds_.empty());
+
+    const int64_t num_keys = 5000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys * 4; key++) {
+      keys.push_back(key / 4);
+    }
+    std::mt19937 rng(15445);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    GenericKey<8> index_key;
+    for (size_t i = 0; i < keys.size(); i++) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Insert(index_key, RID(0, i), transaction);
+    }
+
+    tree.GetStatistics(0, 10, &stats);
+    EXPECT_EQ(stats.num_entries_, keys.size());
+    EXPECT_EQ(stats.distinct_keys_, num_keys);
+    EXPECT_GT(stats.height_, 2);
+    EXPECT_GT(stats.avg_leaf_fill_, 0.5);
+    EXPECT_LE(stats.avg_leaf_fill_, 1);
+    EXPECT_GT(stats.num_leaves_, stats.num_entries_ / 16);
+    // 10 buckets of 2000 entries, 500 keys each
+    ASSERT_EQ(stats.bucket_bounds_.size(), 11);
+    ASSERT_EQ(stats.bucket_depths_.size(), 10);
+    EXPECT_EQ(stats.bucket_bounds_[0].ToString(), 0);
+    for (size_t i = 0; i < 10; i++) {
+      EXPECT_EQ(stats.bucket_depths_[i], 2000 * (i + 1));
+      EXPECT_EQ(stats.bucket_bounds_[i + 1].ToString(), 500 * (i + 1) - 1);
+    }
+
+    BPlusTreeStatistics<GenericKey<8>> sampled;
+    tree.GetStatistics(500, 10, &sampled);
+    EXPECT_EQ(sampled.height_, stats.height_);
+    EXPECT_NEAR(sampled.num_entries_, stats.num_entries_, stats.num_entries_ * 0.2);
+    EXPECT_NEAR(sampled.num_leaves_, stats.num_leaves_, stats.num_leaves_ * 0.2);
+    EXPECT_NEAR(sampled.distinct_keys_, stats.distinct_keys_, stats.distinct_keys_ * 0.3);
+    EXPECT_NEAR(sampled.avg_leaf_fill_, stats.avg_leaf_fill_, 0.1);
+    ASSERT_FALSE(sampled.bucket_depths_.empty());
+    EXPECT_NEAR(sampled.bucket_depths_.back(), stats.num_entries_, stats.num_entries_ * 0.2);
+    for (size_t i = 1; i < sampled.bucket_bounds_.size(); i++) {
+      EXPECT_LE(sampled.bucket_bounds_[i - 1].ToString(), sampled.bucket_bounds_[i].ToString());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// the catalog keeps the statistics of an index, which estimate the selectivity of predicates
+TEST(BPlusTreeStatisticsTest, CatalogTest) {
+  auto disk_manager = new DiskManager("test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction *transaction = new Transaction(0);
+  std::vector<Column> columns;
+  columns.emplace_back("order_id", TypeId::INTEGER);
+  columns.emplace_back("amount", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_info = catalog->CreateTable(transaction, "orders", schema);
+  // amounts are skewed: half of the orders have an amount below 100, the others up to 10000
+  const int num_orders = 10000;
+  for (int order_id = 0; order_id < num_orders; order_id++) {
+    int amount = order_id % 2 == 0 ? order_id % 100 : order_id;
+    Tuple tuple({ValueFactory::GetIntegerValue(order_id), ValueFactory::GetIntegerValue(amount)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(tuple, &rid, transaction));
+  }
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      transaction, "orders_amount", "orders", schema, schema, {1}, 8, false);
+  ASSERT_NE(index_info->stats_, nullptr);
+  IndexStatistics *stats = index_info->stats_.get();
+  EXPECT_EQ(stats->num_entries_, num_orders);
+  EXPECT_EQ(stats->distinct_keys_, 50 + num_orders / 2);
+  EXPECT_EQ(stats->histogram_bounds_.size(), INDEX_HISTOGRAM_BUCKETS + 1);
+
+  auto expected_selectivity = [&](int low, int high) {
+    int count = 0;
+    for (int order_id = 0; order_id < num_orders; order_id++) {
+      int amount = order_id % 2 == 0 ? order_id % 100 : order_id;
+      count += static_cast<int>(amount >= low && amount <= high);
+    }
+    return static_cast<double>(count) / num_orders;
+  };
+  for (auto bounds : std::vector<std::pair<int, int>>{{0, 99}, {0, 9}, {100, 10000}, {2000, 2999}, {5000, 5000}}) {
+    Value low = ValueFactory::GetIntegerValue(bounds.first);
+    Value high = ValueFactory::GetIntegerValue(bounds.second);
+    EXPECT_NEAR(stats->EstimateRangeSelectivity(&low, &high), expected_selectivity(bounds.first, bounds.second),
+                0.03);
+  }
+  Value low = ValueFactory::GetIntegerValue(5000);
+  EXPECT_NEAR(stats->EstimateRangeSelectivity(&low, nullptr), expected_selectivity(5000, num_orders), 0.03);
+  EXPECT_NEAR(stats->EstimateRangeSelectivity(nullptr, &low), expected_selectivity(0, 5000), 0.03);
+  EXPECT_DOUBLE_EQ(stats->EstimateRangeSelectivity(nullptr, nullptr), 1);
+  EXPECT_DOUBLE_EQ(stats->EstimateEqualSelectivity(), 1.0 / stats->distinct_keys_);
+
+  // new orders show up once the index is analyzed again, here from a sample of its leaves
+  for (int order_id = num_orders; order_id < 2 * num_orders; order_id++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(order_id), ValueFactory::GetIntegerValue(order_id)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table_info->table_->InsertTuple(tuple, &rid, transaction));
+    index_info->index_->InsertEntry(tuple.KeyFromTuple(schema, *index_info->index_->GetKeySchema(), {1}), rid,
+                                    transaction);
+  }
+  EXPECT_EQ(index_info->stats_->num_entries_, num_orders);
+  EXPECT_TRUE(catalog->AnalyzeIndex(transaction, index_info, 200));
+  EXPECT_NEAR(index_info->stats_->num_entries_, 2 * num_orders, 0.2 * 2 * num_orders);
+  Value high = ValueFactory::GetIntegerValue(2 * num_orders);
+  EXPECT_NEAR(index_info->stats_->EstimateRangeSelectivity(&low, &high), 0.625, 0.1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -66,6 +66,8 @@ Schema *ParseCreateStatement(const std::string &sql_base) {
       type = BIGINT;
     } else if (column_type == "double" || column_type == "float") {
       type = DECIMAL;
+    } else if (column_type == "timestamp") {
+      type = TIMESTAMP;
     } else if (column_type == "varchar" || column_type == "char") {
       type = VARCHAR;
       column_length = (column_length == 0) ? 32 : column_length;
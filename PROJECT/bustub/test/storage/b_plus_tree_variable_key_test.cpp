@@ -0,0 +1,168 @@
+/**
+ * b_plus_tree_variable_key_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+std::string EmailAt(int id) {
+  std::vector<std::string> domains = {"cs.cmu.edu", "gmail.com", "andrew.cmu.edu", "example.org"};
+  return "user" + std::to_string(id * 7919 % 100003) + std::string(id % 11, 'x') + "@" + domains[id % domains.size()];
+}
+
+// number of pages allocated so far, the next page id
+page_id_t PagesInUse(BufferPoolManager *bpm) {
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  bpm->UnpinPage(page_id, false);
+  return page_id;
+}
+
+page_id_t BuildEmailIndex(bool prefix_compression, int num_keys) {
+  Schema *key_schema = ParseCreateStatement("a varchar(200)");
+  NormalizedComparator<256> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<NormalizedKey<256>, RID, NormalizedComparator<256>> tree("emails", bpm, comparator, PAGE_SIZE,
+                                                                     PAGE_SIZE, prefix_compression);
+  Transaction *transaction = new Transaction(0);
+
+  std::vector<int> ids;
+  std::set<std::string> expected;
+  for (int id = 0; id < num_keys; id++) {
+    ids.push_back(id);
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+  NormalizedKey<256> index_key;
+  auto set_key = [&](int id) {
+    Tuple key({ValueFactory::GetVarcharValue(EmailAt(id))}, key_schema);
+    index_key.SetFromKey(key, key_schema);
+  };
+  auto check = [&]() {
+    std::vector<RID> rids;
+    for (int id = 0; id < num_keys; id += 3) {
+      set_key(id);
+      rids.clear();
+      EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(EmailAt(id)) == 1);
+      if (!rids.empty()) {
+        EXPECT_EQ(rids[0], RID(0, id));
+      }
+    }
+    // normalized varchars sort like the strings they were built from
+    auto expected_iterator = expected.begin();
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      ASSERT_NE(expected_iterator, expected.end());
+      EXPECT_EQ(EmailAt((*iterator).second.GetSlotNum()), *expected_iterator);
+      ++expected_iterator;
+    }
+    EXPECT_EQ(expected_iterator, expected.end());
+  };
+
+  for (auto id : ids) {
+    set_key(id);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, id), transaction));
+    expected.insert(EmailAt(id));
+  }
+  check();
+  page_id_t pages = PagesInUse(bpm);
+
+  for (size_t i = 0; i < ids.size(); i += 2) {
+    set_key(ids[i]);
+    tree.Remove(index_key, transaction);
+    expected.erase(EmailAt(ids[i]));
+  }
+  check();
+  for (auto id : ids) {
+    set_key(id);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+  return pages;
+}
+
+// a 256 byte key slot holds ~30 bytes of email, slotted pages only store what is there
+TEST(BPlusTreeVariableKeyTest, EmailIndexTest) {
+  page_id_t fixed_pages = BuildEmailIndex(false, 5000);
+  page_id_t variable_pages = BuildEmailIndex(true, 5000);
+  std::cout << "pages with fixed-size keys: " << fixed_pages << ", with variable-length keys: " << variable_pages
+            << std::endl;
+  EXPECT_LT(4 * variable_pages, fixed_pages);
+}
+
+// fills a slotted leaf with keys of mixed lengths until it is overfull
+int FillLeaf(BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>> *leaf,
+             const NormalizedComparator<64> &comparator, std::vector<NormalizedKey<64>> *keys) {
+  std::mt19937 rng(15445);
+  keys->clear();
+  while (!leaf->IsOverfull()) {
+    NormalizedKey<64> key;
+    memset(key.data_, 0, sizeof(key.data_));
+    size_t length = 1 + rng() % sizeof(key.data_);
+    for (size_t i = 0; i < length; i++) {
+      key.data_[i] = static_cast<char>('a' + rng() % 26);
+    }
+    RID rid;
+    if (leaf->Lookup(key, &rid, comparator)) {
+      continue;
+    }
+    leaf->Insert(key, RID(0, keys->size()), comparator);
+    keys->push_back(key);
+  }
+  return leaf->GetSize();
+}
+
+TEST(BPlusTreeVariableKeyTest, SlottedLeafPageTest) {
+  NormalizedComparator<64> comparator(nullptr);
+  char data[PAGE_SIZE];
+  auto leaf = reinterpret_cast<BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>> *>(data);
+  leaf->Init(1, INVALID_PAGE_ID, PAGE_SIZE, true);
+  EXPECT_TRUE(leaf->HasVariableLengthKeys());
+
+  std::vector<NormalizedKey<64>> keys;
+  int size = FillLeaf(leaf, comparator, &keys);
+  // ~32 bytes per key on average, more than the fixed layout would hold
+  EXPECT_GT(size, static_cast<int>((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<NormalizedKey<64>, RID>)));
+  for (int i = 1; i < leaf->GetSize(); i++) {
+    EXPECT_LT(comparator(leaf->KeyAt(i - 1), leaf->KeyAt(i)), 0);
+  }
+  RID rid;
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_TRUE(leaf->Lookup(keys[i], &rid, comparator));
+    EXPECT_EQ(rid.GetSlotNum(), i);
+  }
+
+  // removing every key gives the whole key heap back
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto &key : keys) {
+    int before = leaf->GetSize();
+    EXPECT_EQ(leaf->RemoveAndDeleteRecord(key, comparator), before - 1);
+    EXPECT_FALSE(leaf->Lookup(key, &rid, comparator));
+  }
+  EXPECT_EQ(leaf->GetSize(), 0);
+  EXPECT_EQ(FillLeaf(leaf, comparator, &keys), size);
+}
+
+}  // namespace bustub
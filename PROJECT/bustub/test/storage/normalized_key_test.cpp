@@ -0,0 +1,234 @@
+/**
+ * normalized_key_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/normalized_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+int Sign(int cmp) { return (cmp > 0) - (cmp < 0); }
+
+// normalized keys must sort exactly like the values they were built from
+TEST(NormalizedKeyTest, OrderTest) {
+  Schema *key_schema = ParseCreateStatement("a integer,b double,c varchar(8)");
+  GenericComparator<32> generic_comparator(key_schema);
+  NormalizedComparator<32> normalized_comparator(key_schema);
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<int32_t> int_dist(-50, 50);
+  std::uniform_real_distribution<double> double_dist(-10.0, 10.0);
+  std::vector<std::string> strings = {"", "a", "ab", "abc", "b", "ba", "zz"};
+
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    std::vector<Value> values;
+    values.push_back(ValueFactory::GetIntegerValue(int_dist(rng) % 3));
+    values.push_back(ValueFactory::GetDecimalValue(i % 5 == 0 ? 0.0 : double_dist(rng)));
+    values.push_back(ValueFactory::GetVarcharValue(strings[rng() % strings.size()]));
+    tuples.emplace_back(values, key_schema);
+  }
+
+  for (auto &lhs : tuples) {
+    GenericKey<32> lhs_generic;
+    NormalizedKey<32> lhs_normalized;
+    lhs_generic.SetFromKey(lhs, key_schema);
+    lhs_normalized.SetFromKey(lhs, key_schema);
+    for (auto &rhs : tuples) {
+      GenericKey<32> rhs_generic;
+      NormalizedKey<32> rhs_normalized;
+      rhs_generic.SetFromKey(rhs, key_schema);
+      rhs_normalized.SetFromKey(rhs, key_schema);
+      EXPECT_EQ(Sign(generic_comparator(lhs_generic, rhs_generic)),
+                Sign(normalized_comparator(lhs_normalized, rhs_normalized)));
+    }
+  }
+
+  delete key_schema;
+}
+
+// NULLs sort as their sentinels: before every other value, except timestamps, whose NULL sorts last
+TEST(NormalizedKeyTest, NullOrderTest) {
+  auto check = [](const std::string &column, const Value &smallest, const Value &largest) {
+    Schema *key_schema = ParseCreateStatement("a " + column);
+    NormalizedComparator<16> comparator(key_schema);
+    auto encode = [&](const Value &value) {
+      NormalizedKey<16> key;
+      key.SetFromKey(Tuple({value}, key_schema), key_schema);
+      return key;
+    };
+    NormalizedKey<16> null_key = encode(ValueFactory::GetNullValueByType(key_schema->GetColumn(0).GetType()));
+    int null_sign = key_schema->GetColumn(0).GetType() == TypeId::TIMESTAMP ? 1 : -1;
+    EXPECT_EQ(Sign(comparator(null_key, encode(smallest))), null_sign) << column;
+    EXPECT_EQ(Sign(comparator(null_key, encode(largest))), null_sign) << column;
+    delete key_schema;
+  };
+  check("tinyint", ValueFactory::GetTinyIntValue(BUSTUB_INT8_MIN), ValueFactory::GetTinyIntValue(BUSTUB_INT8_MAX));
+  check("integer", ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN), ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX));
+  check("bigint", ValueFactory::GetBigIntValue(BUSTUB_INT64_MIN), ValueFactory::GetBigIntValue(BUSTUB_INT64_MAX));
+  check("double", ValueFactory::GetDecimalValue(BUSTUB_DECIMAL_MIN),
+        ValueFactory::GetDecimalValue(BUSTUB_DECIMAL_MAX));
+  check("varchar(8)", ValueFactory::GetVarcharValue(""), ValueFactory::GetVarcharValue("zz"));
+  check("timestamp", ValueFactory::GetTimestampValue(BUSTUB_TIMESTAMP_MIN),
+        ValueFactory::GetTimestampValue(BUSTUB_TIMESTAMP_MAX));
+}
+
+// keys whose encoding does not fit are rejected rather than cut, which would make them equal to other keys
+TEST(NormalizedKeyTest, KeyTooLongTest) {
+  Schema *key_schema = ParseCreateStatement("a integer,b varchar(16)");
+  NormalizedKey<12> lhs;
+  NormalizedKey<12> rhs;
+  NormalizedComparator<12> comparator(key_schema);
+  // 4 bytes of integer, the null marker, 5 bytes and the 2 byte terminator
+  Tuple fits({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("abcde")}, key_schema);
+  Tuple shorter({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("abcd")}, key_schema);
+  lhs.SetFromKey(fits, key_schema);
+  rhs.SetFromKey(shorter, key_schema);
+  EXPECT_GT(comparator(lhs, rhs), 0);
+
+  Tuple too_long({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("abcdef")}, key_schema);
+  EXPECT_THROW(lhs.SetFromKey(too_long, key_schema), Exception);
+  Tuple escaped({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue(std::string("abc\0e", 5))},
+                key_schema);
+  EXPECT_THROW(lhs.SetFromKey(escaped, key_schema), Exception);
+
+  delete key_schema;
+}
+
+TEST(NormalizedKeyTest, IntegerRoundTripTest) {
+  NormalizedKey<8> lhs;
+  NormalizedKey<8> rhs;
+  NormalizedComparator<8> comparator(nullptr);
+  std::vector<int64_t> keys = {BUSTUB_INT64_MIN, -1000, -1, 0, 1, 255, 256, 1000, BUSTUB_INT64_MAX};
+  for (size_t i = 0; i < keys.size(); i++) {
+    lhs.SetFromInteger(keys[i]);
+    EXPECT_EQ(lhs.ToString(), keys[i]);
+    for (size_t j = 0; j < keys.size(); j++) {
+      rhs.SetFromInteger(keys[j]);
+      EXPECT_EQ(Sign(comparator(lhs, rhs)), (i > j) - (i < j));
+    }
+  }
+}
+
+TEST(NormalizedKeyTest, BPlusTreeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  NormalizedComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // small pages, so the tree grows several levels
+  BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>> tree("foo_pk", bpm, comparator, 16, 16);
+  NormalizedKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = -2000; key < 2000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF));
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>(key & 0xFFFFFFFF));
+  }
+
+  // negative keys must come first
+  int64_t current_key = -2000;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 2000);
+
+  for (auto key : keys) {
+    if (key % 3 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 3 == 0);
+  }
+  current_key = -1998;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    current_key += 3;
+  }
+  EXPECT_EQ(current_key, 2001);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// compares the cost of one in-node comparison, printed for reference only
+TEST(NormalizedKeyTest, ComparatorCostTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint,b integer");
+  GenericComparator<16> generic_comparator(key_schema);
+  NormalizedComparator<16> normalized_comparator(key_schema);
+
+  const int num_keys = 1024;
+  std::vector<GenericKey<16>> generic_keys(num_keys);
+  std::vector<NormalizedKey<16>> normalized_keys(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i / 4), ValueFactory::GetIntegerValue(i % 4)}, key_schema);
+    generic_keys[i].SetFromKey(tuple, key_schema);
+    normalized_keys[i].SetFromKey(tuple, key_schema);
+  }
+
+  const int rounds = 200000;
+  int64_t generic_sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    generic_sum += Sign(generic_comparator(generic_keys[i % num_keys], generic_keys[(i * 7) % num_keys]));
+  }
+  auto generic_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  int64_t normalized_sum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    normalized_sum +=
+        Sign(normalized_comparator(normalized_keys[i % num_keys], normalized_keys[(i * 7) % num_keys]));
+  }
+  auto normalized_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  EXPECT_EQ(generic_sum, normalized_sum);
+  std::cout << "GenericComparator: " << generic_ns.count() / rounds << " ns/compare, "
+            << "NormalizedComparator: " << normalized_ns.count() / rounds << " ns/compare" << std::endl;
+  delete key_schema;
+}
+
+}  // namespace bustub
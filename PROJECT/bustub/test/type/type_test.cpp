@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "common/exception.h"
+#include "common/util/hash_util.h"
 #include "gtest/gtest.h"
 #include "type/value.h"
 
@@ -86,6 +87,17 @@ TEST(TypeTests, MinValueTest) {
   EXPECT_EQ(val1.CompareEquals(val2), CmpBool::CmpTrue);
 }
 
+// equal decimals hash alike, -0.0 included
+// NOLINTNEXTLINE
+TEST(TypeTests, HashDecimalTest) {
+  Value zero(TypeId::DECIMAL, 0.0);
+  Value negative_zero(TypeId::DECIMAL, -0.0);
+  EXPECT_EQ(zero.CompareEquals(negative_zero), CmpBool::CmpTrue);
+  EXPECT_EQ(HashUtil::HashValue(&zero), HashUtil::HashValue(&negative_zero));
+  Value one(TypeId::DECIMAL, 1.0);
+  EXPECT_NE(HashUtil::HashValue(&zero), HashUtil::HashValue(&one));
+}
+
 // NOLINTNEXTLINE
 TEST(TypeTests, TemplateTest) {
   std::string temp = "32";